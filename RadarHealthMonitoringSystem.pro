@@ -46,7 +46,8 @@ INCLUDEPATH += \
     $$PWD/src/network \
     $$PWD/src/graph \
     $$PWD/src/ui \
-    $$PWD/src/nodes
+    $$PWD/src/nodes \
+    $$PWD/src/storage
 
 # Main source file
 SOURCES += src/main.cpp
@@ -56,24 +57,52 @@ SOURCES += \
     src/core/SubsystemNode.cpp \
     src/core/HealthStatus.cpp \
     src/core/TelemetryPacket.cpp \
-    src/core/RadarSubsystem.cpp
+    src/core/RadarSubsystem.cpp \
+    src/core/ParameterDictionary.cpp \
+    src/core/IdInterner.cpp \
+    src/core/TelemetrySchema.cpp \
+    src/core/TelemetryHistory.cpp \
+    src/core/HealthRuleEngine.cpp
 
 HEADERS += \
     src/core/SubsystemNode.h \
     src/core/HealthStatus.h \
     src/core/TelemetryPacket.h \
-    src/core/RadarSubsystem.h
+    src/core/RadarSubsystem.h \
+    src/core/ParameterDictionary.h \
+    src/core/IdInterner.h \
+    src/core/TelemetrySchema.h \
+    src/core/TelemetryHistory.h \
+    src/core/HealthRuleEngine.h \
+    src/core/HealthSummary.h
 
 # Network sources
 SOURCES += \
     src/network/UdpTelemetryReceiver.cpp \
     src/network/TelemetryParser.cpp \
-    src/network/HealthStatusDispatcher.cpp
+    src/network/HealthStatusDispatcher.cpp \
+    src/network/DatagramBatchReader.cpp \
+    src/network/TelemetryConflator.cpp \
+    src/network/TelemetryPacketView.cpp \
+    src/network/TelemetryJsonDecoder.cpp \
+    src/network/DatagramBufferPool.cpp \
+    src/network/ClockSkewTracker.cpp \
+    src/network/StalenessMonitor.cpp
 
 HEADERS += \
     src/network/UdpTelemetryReceiver.h \
     src/network/TelemetryParser.h \
-    src/network/HealthStatusDispatcher.h
+    src/network/HealthStatusDispatcher.h \
+    src/network/DatagramBatchReader.h \
+    src/network/TelemetryRingBuffer.h \
+    src/network/TelemetryConflator.h \
+    src/network/TelemetryPacketView.h \
+    src/network/TelemetryJsonDecoder.h \
+    src/network/TelemetryStatistics.h \
+    src/network/EpochSnapshot.h \
+    src/network/DatagramBufferPool.h \
+    src/network/ClockSkewTracker.h \
+    src/network/StalenessMonitor.h
 
 # Graph sources
 SOURCES += \
@@ -81,14 +110,16 @@ SOURCES += \
     src/graph/NodeGraphView.cpp \
     src/graph/ConnectionManager.cpp \
     src/graph/HierarchicalGraphEngine.cpp \
-    src/graph/NodeDataModel.cpp
+    src/graph/NodeDataModel.cpp \
+    src/graph/ImpactEngine.cpp
 
 HEADERS += \
     src/graph/NodeGraphScene.h \
     src/graph/NodeGraphView.h \
     src/graph/ConnectionManager.h \
     src/graph/HierarchicalGraphEngine.h \
-    src/graph/NodeDataModel.h
+    src/graph/NodeDataModel.h \
+    src/graph/ImpactEngine.h
 
 # Node sources
 SOURCES += \
@@ -113,6 +144,21 @@ HEADERS += \
     src/nodes/CoolingSystemNode.h \
     src/nodes/EmbeddedControllerNode.h
 
+# Storage sources
+SOURCES += \
+    src/storage/TelemetrySegment.cpp \
+    src/storage/TelemetryStore.cpp \
+    src/storage/TelemetryStoreReader.cpp \
+    src/storage/TelemetryQueryEngine.cpp \
+    src/storage/TelemetryCompactor.cpp
+
+HEADERS += \
+    src/storage/TelemetrySegment.h \
+    src/storage/TelemetryStore.h \
+    src/storage/TelemetryStoreReader.h \
+    src/storage/TelemetryQueryEngine.h \
+    src/storage/TelemetryCompactor.h
+
 # UI sources
 SOURCES += \
     src/ui/MainWindow.cpp \
@@ -120,7 +166,8 @@ SOURCES += \
     src/ui/PropertiesPanel.cpp \
     src/ui/HealthDashboard.cpp \
     src/ui/TelemetryLogWindow.cpp \
-    src/ui/NodeWidget.cpp
+    src/ui/NodeWidget.cpp \
+    src/ui/TelemetryQueryPanel.cpp
 
 HEADERS += \
     src/ui/MainWindow.h \
@@ -128,7 +175,8 @@ HEADERS += \
     src/ui/PropertiesPanel.h \
     src/ui/HealthDashboard.h \
     src/ui/TelemetryLogWindow.h \
-    src/ui/NodeWidget.h
+    src/ui/NodeWidget.h \
+    src/ui/TelemetryQueryPanel.h
 
 # UI Forms
 FORMS += \
@@ -138,6 +186,27 @@ FORMS += \
 RESOURCES += \
     resources/resources.qrc
 
+# Receive-path micro-benchmarks: qmake CONFIG+=bench builds TelemetryBench
+# (bench/TelemetryBench.cpp) instead of the application
+bench {
+    TARGET = TelemetryBench
+    QT = core gui
+    CONFIG += console
+    FORMS =
+    RESOURCES =
+    HEADERS =
+    SOURCES = \
+        bench/TelemetryBench.cpp \
+        src/core/TelemetryPacket.cpp \
+        src/core/HealthStatus.cpp \
+        src/core/IdInterner.cpp \
+        src/core/TelemetrySchema.cpp \
+        src/core/ParameterDictionary.cpp \
+        src/network/TelemetryParser.cpp \
+        src/network/TelemetryPacketView.cpp \
+        src/network/TelemetryJsonDecoder.cpp
+}
+
 # Build directories
 MOC_DIR = build/moc
 OBJECTS_DIR = build/obj
@@ -0,0 +1,415 @@
+/**
+ * @file TelemetryBench.cpp
+ * @brief Micro-benchmarks for the telemetry receive path
+ * 
+ * Each case times a fast path against the code it replaced and prints the
+ * time per operation and the speedup. The allocation case counts heap
+ * allocations per packet; on glibc malloc itself is counted (so Qt's
+ * container allocations are included), elsewhere only operator new.
+ * Usage: TelemetryBench [iterations]
+ */
+
+#include "../src/core/TelemetryPacket.h"
+#include "../src/network/TelemetryParser.h"
+#include "../src/network/TelemetryPacketView.h"
+#include "../src/network/TelemetryJsonDecoder.h"
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QString>
+#include <QVariant>
+#include <QVector>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <new>
+
+namespace {
+
+std::atomic<bool> g_countAllocations(false);
+std::atomic<quint64> g_allocations(0);
+std::atomic<quint64> g_allocatedBytes(0);
+
+inline void countAllocation(size_t size)
+{
+    if (g_countAllocations.load(std::memory_order_relaxed)) {
+        g_allocations.fetch_add(1, std::memory_order_relaxed);
+        g_allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+    }
+}
+
+} // namespace
+
+#if defined(__GLIBC__)
+// The executable's definitions take precedence over libc's for Qt too
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* pointer, size_t size);
+
+void* malloc(size_t size) noexcept
+{
+    countAllocation(size);
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size) noexcept
+{
+    countAllocation(count * size);
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* pointer, size_t size) noexcept
+{
+    countAllocation(size);
+    return __libc_realloc(pointer, size);
+}
+}
+#else
+void* operator new(std::size_t size)
+{
+    countAllocation(size);
+    if (void* pointer = std::malloc(size ? size : 1)) {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept
+{
+    std::free(pointer);
+}
+#endif
+
+namespace {
+
+constexpr int DefaultIterations = 200000;
+
+// Consumed by every case so the optimizer cannot drop the work
+volatile quint64 g_sink = 0;
+
+template <typename Operation>
+double nanosecondsPerOperation(int iterations, Operation operation)
+{
+    // Warm caches and lazily built tables first
+    for (int i = 0; i < iterations / 10; ++i) {
+        operation();
+    }
+    
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < iterations; ++i) {
+        operation();
+    }
+    return double(timer.nsecsElapsed()) / iterations;
+}
+
+void report(const char* name, double nanoseconds, double baselineNanoseconds)
+{
+    std::printf("  %-44s %9.1f ns/op %8.2fx\n", name, nanoseconds,
+                baselineNanoseconds / nanoseconds);
+}
+
+template <typename Operation>
+void reportAllocations(const char* name, int iterations, Operation operation)
+{
+    for (int i = 0; i < iterations / 10; ++i) {
+        operation();
+    }
+    
+    g_allocations.store(0);
+    g_allocatedBytes.store(0);
+    g_countAllocations.store(true);
+    for (int i = 0; i < iterations; ++i) {
+        operation();
+    }
+    g_countAllocations.store(false);
+    
+    std::printf("  %-44s %7.2f allocs %9.1f bytes\n", name,
+                double(g_allocations.load()) / iterations,
+                double(g_allocatedBytes.load()) / iterations);
+}
+
+void appendBigEndian(QByteArray& frame, quint64 value, int bytes)
+{
+    for (int i = bytes - 1; i >= 0; --i) {
+        frame.append(char((value >> (8 * i)) & 0xFF));
+    }
+}
+
+// DefenseProtocol v1 frame with double, integer and string parameters
+QByteArray makeDefenseProtocolFrame()
+{
+    static const char* const numericKeys[] = {
+        "temperature", "voltage", "current", "power", "frequency",
+        "noise_figure", "gain", "vswr", "cpu_load", "memory_usage"
+    };
+    
+    QByteArray frame("RHMS");
+    frame.append(QByteArray("rf-frontend-0001").leftJustified(16, ' ', true));
+    frame.append(char(HealthCode::OK));
+    appendBigEndian(frame, quint64(1700000000000LL), 8);
+    appendBigEndian(frame, std::size(numericKeys) + 2, 2);
+    
+    double value = 1.5;
+    for (const char* key : numericKeys) {
+        frame.append(char(std::strlen(key)));
+        frame.append(key);
+        frame.append(char(0));
+        frame.append(reinterpret_cast<const char*>(&value), sizeof(value));
+        value *= 1.7;
+    }
+    
+    const qint32 errors = 3;
+    frame.append(char(11));
+    frame.append("error_count");
+    frame.append(char(1));
+    frame.append(reinterpret_cast<const char*>(&errors), sizeof(errors));
+    
+    frame.append(char(11));
+    frame.append("link_status");
+    frame.append(char(2));
+    frame.append(char(2));
+    frame.append("UP");
+    return frame;
+}
+
+// TelemetryParser::parseDefenseProtocol() before TelemetryPacketView:
+// every header field, key and string is copied out with mid() first
+TelemetryPacket parseDefenseProtocolLegacy(const QByteArray& data)
+{
+    if (data.size() < 31 || data.mid(0, 4) != "RHMS") {
+        return TelemetryPacket();
+    }
+    
+    TelemetryPacket packet;
+    packet.setSubsystemId(QString::fromUtf8(data.mid(4, 16)).trimmed());
+    packet.setHealthCode(static_cast<HealthCode>(static_cast<quint8>(data.at(20))));
+    
+    qint64 timestamp = 0;
+    for (int i = 0; i < 8; ++i) {
+        timestamp = (timestamp << 8) | static_cast<quint8>(data.at(21 + i));
+    }
+    packet.setTimestamp(timestamp);
+    
+    const quint16 paramCount = (static_cast<quint8>(data.at(29)) << 8)
+                               | static_cast<quint8>(data.at(30));
+    
+    int offset = 31;
+    for (quint16 i = 0; i < paramCount && offset < data.size(); ++i) {
+        const quint8 keyLen = static_cast<quint8>(data.at(offset++));
+        if (offset + keyLen >= data.size()) break;
+        
+        const QString key = QString::fromUtf8(data.mid(offset, keyLen));
+        offset += keyLen;
+        
+        const quint8 valueType = static_cast<quint8>(data.at(offset++));
+        QVariant value;
+        switch (valueType) {
+            case 0: {
+                if (offset + 8 > data.size()) break;
+                double val = 0;
+                std::memcpy(&val, data.constData() + offset, 8);
+                value = val;
+                offset += 8;
+                break;
+            }
+            case 1: {
+                if (offset + 4 > data.size()) break;
+                qint32 val = 0;
+                std::memcpy(&val, data.constData() + offset, 4);
+                value = val;
+                offset += 4;
+                break;
+            }
+            case 2: {
+                if (offset >= data.size()) break;
+                const quint8 strLen = static_cast<quint8>(data.at(offset++));
+                if (offset + strLen > data.size()) break;
+                value = QString::fromUtf8(data.mid(offset, strLen));
+                offset += strLen;
+                break;
+            }
+        }
+        
+        packet.addParameter(key, value);
+    }
+    
+    return packet;
+}
+
+void benchDefenseProtocol(int iterations)
+{
+    const QByteArray frame = makeDefenseProtocolFrame();
+    std::printf("DefenseProtocol v1, %lld-byte frame, %d parameters\n",
+                static_cast<long long>(frame.size()), TelemetryPacketView(frame).parameterCount());
+    
+    const double legacy = nanosecondsPerOperation(iterations, [&]() {
+        g_sink = g_sink + parseDefenseProtocolLegacy(frame).presentSlots();
+    });
+    const double viewOnly = nanosecondsPerOperation(iterations, [&]() {
+        const TelemetryPacketView view(frame);
+        for (const TelemetryPacketView::Parameter& parameter : view) {
+            g_sink = g_sink + quint64(parameter.toDouble());
+        }
+    });
+    const double viewToPacket = nanosecondsPerOperation(iterations, [&]() {
+        g_sink = g_sink + TelemetryParser::parseDefenseProtocol(frame).presentSlots();
+    });
+    
+    report("legacy mid() parser", legacy, legacy);
+    report("TelemetryPacketView, iterate in place", viewOnly, legacy);
+    report("TelemetryPacketView + toPacket()", viewToPacket, legacy);
+}
+
+// JSON as written by TelemetryPacket::toJson(); messageLength pads the
+// health message to exercise the string scanner
+QByteArray makeJsonPacket(int messageLength)
+{
+    TelemetryPacket packet("5f0c2a7e-3b1d-4e8a-9c6f-2d7b8e1a4c30", HealthCode::WARNING);
+    packet.setTimestamp(1700000000000LL);
+    packet.setHealthMessage(QString("Fan speed below nominal").leftJustified(messageLength, '.'));
+    packet.setTemperature(61.25);
+    packet.setVoltage(27.9);
+    packet.setCurrent(4.75);
+    packet.setPower(132.5);
+    packet.setFrequency(9.41e9);
+    packet.setLatency(12);
+    packet.setErrorCount(3);
+    packet.addParameter("fan_rpm", 2150);
+    packet.addParameter("pump_status", "RUNNING");
+    packet.addParameter("inlet_temp", 18.5);
+    return packet.toJson().toUtf8();
+}
+
+void benchJsonCase(const char* title, const QByteArray& json, int iterations)
+{
+    TelemetryPacket decoded;
+    const bool fastPath = TelemetryJsonDecoder::decode(json, decoded);
+    std::printf("JSON, %s, %lld bytes%s\n", title, static_cast<long long>(json.size()),
+                fastPath ? "" : " (decoder declined: both rows use QJsonDocument)");
+    
+    const double document = nanosecondsPerOperation(iterations, [&]() {
+        g_sink = g_sink + TelemetryPacket::fromJsonUtf8(json).presentSlots();
+    });
+    const double decoder = nanosecondsPerOperation(iterations, [&]() {
+        TelemetryPacket packet;
+        TelemetryJsonDecoder::decode(json, packet);
+        g_sink = g_sink + packet.presentSlots();
+    });
+    
+    report("QJsonDocument (fromJsonUtf8)", document, document);
+    report(TelemetryJsonDecoder::isSimdAccelerated() ? "TelemetryJsonDecoder (SSE2)"
+                                                     : "TelemetryJsonDecoder (scalar)",
+           decoder, document);
+}
+
+void benchJson(int iterations)
+{
+    benchJsonCase("short message", makeJsonPacket(0), iterations);
+    std::printf("\n");
+    benchJsonCase("512-character message", makeJsonPacket(512), iterations);
+}
+
+// TelemetryPacket as it was before it became implicitly shared: every
+// field held by value, so each copy duplicates the slot arrays
+struct LegacyTelemetryPacket {
+    union SlotValue {
+        double real;
+        qint64 integer;
+    };
+    
+    QString subsystemId;
+    quint32 subsystemHandle = 0;
+    HealthCode healthCode = HealthCode::UNKNOWN;
+    QString healthMessage;
+    qint64 timestamp = 0;
+    qint64 receiveTimestampNs = 0;
+    quint64 presentSlots = 0;
+    SlotValue slotValues[TelemetrySchema::MaxSlots] = {};
+    quint8 slotKinds[TelemetrySchema::MaxSlots] = {};
+    QMap<QString, QVariant> parameters;
+    
+    LegacyTelemetryPacket() = default;
+    explicit LegacyTelemetryPacket(const TelemetryPacket& packet)
+        : subsystemId(packet.subsystemId())
+        , subsystemHandle(packet.subsystemHandle())
+        , healthCode(packet.healthCode())
+        , healthMessage(packet.healthMessage())
+        , timestamp(packet.timestamp())
+        , receiveTimestampNs(packet.receiveTimestampNs())
+        , presentSlots(packet.presentSlots())
+        , parameters(packet.allParameters())
+    {
+        for (int slot = 0; slot < TelemetrySchema::MaxSlots; ++slot) {
+            slotValues[slot].real = packet.parameterValue(slot);
+        }
+    }
+};
+
+// Where a received packet is copied on its way to a node: the queued
+// signal argument and the dispatcher's queued call each hold a copy on the
+// heap, the node keeps the latest one and the conflator a pending one
+template <typename Packet>
+struct HandOff {
+    Packet latest;
+    QVector<Packet> pending;
+    
+    void operator()(const Packet& packet)
+    {
+        const std::unique_ptr<Packet> argument(new Packet(packet));
+        const std::unique_ptr<Packet> queuedCall(new Packet(*argument));
+        latest = *queuedCall;
+        pending.append(*argument);
+        if (pending.size() == 64) {
+            pending.clear();
+        }
+    }
+};
+
+void benchAllocations(int iterations)
+{
+    const QByteArray frame = makeDefenseProtocolFrame();
+    const TelemetryPacket packet = TelemetryParser::parseDefenseProtocol(frame);
+    const LegacyTelemetryPacket legacyPacket(packet);
+    std::printf("Heap allocations per packet (sizeof: %d bytes before, %d after)\n",
+                int(sizeof(LegacyTelemetryPacket)), int(sizeof(TelemetryPacket)));
+    
+    HandOff<LegacyTelemetryPacket> legacyHandOff;
+    HandOff<TelemetryPacket> sharedHandOff;
+    reportAllocations("parse v1 frame to TelemetryPacket", iterations, [&]() {
+        g_sink = g_sink + TelemetryParser::parseDefenseProtocol(frame).presentSlots();
+    });
+    reportAllocations("hand-off, before: packet held by value", iterations, [&]() {
+        legacyHandOff(legacyPacket);
+    });
+    reportAllocations("hand-off, after: implicitly shared packet", iterations, [&]() {
+        sharedHandOff(packet);
+    });
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    const int iterations = argc > 1 ? std::atoi(argv[1]) : DefaultIterations;
+    if (iterations <= 0) {
+        std::fprintf(stderr, "usage: %s [iterations]\n", argv[0]);
+        return 1;
+    }
+    
+    std::printf("%d iterations per case\n\n", iterations);
+    benchDefenseProtocol(iterations);
+    std::printf("\n");
+    benchJson(iterations);
+    std::printf("\n");
+    benchAllocations(iterations);
+    return 0;
+}
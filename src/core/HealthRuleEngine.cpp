@@ -0,0 +1,546 @@
+/**
+ * @file HealthRuleEngine.cpp
+ * @brief Implementation of HealthRuleEngine
+ */
+
+#include "HealthRuleEngine.h"
+#include "SubsystemNode.h"
+#include "IdInterner.h"
+#include "TelemetrySchema.h"
+#include <QDir>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QStandardPaths>
+#include <QTimer>
+#include <QtAlgorithms>
+#include <QDebug>
+#include <limits>
+#include <vector>
+
+const QString HealthRuleEngine::BuiltInRulesPath = QStringLiteral(":/config/health_rules.json");
+
+namespace {
+
+constexpr double Missing = std::numeric_limits<double>::quiet_NaN();
+
+bool parseComparator(const QString& op, HealthRule::Comparator* comparator)
+{
+    static const struct {
+        const char* op;
+        HealthRule::Comparator comparator;
+    } comparators[] = {
+        { "<", HealthRule::Less },
+        { "<=", HealthRule::LessEqual },
+        { ">", HealthRule::Greater },
+        { ">=", HealthRule::GreaterEqual },
+        { "==", HealthRule::Equal },
+        { "!=", HealthRule::NotEqual }
+    };
+    
+    for (const auto& entry : comparators) {
+        if (op == QLatin1String(entry.op)) {
+            *comparator = entry.comparator;
+            return true;
+        }
+    }
+    return false;
+}
+
+const char* comparatorText(HealthRule::Comparator comparator)
+{
+    switch (comparator) {
+        case HealthRule::Less: return "<";
+        case HealthRule::LessEqual: return "<=";
+        case HealthRule::Greater: return ">";
+        case HealthRule::GreaterEqual: return ">=";
+        case HealthRule::Equal: return "==";
+        default: return "!=";
+    }
+}
+
+// Sets bit in fired[i] for every i where compare(values[i], threshold) holds.
+// A missing value is NaN, which compares false against anything.
+template <typename Compare>
+void markFired(const double* values, const double* thresholds, double threshold, int count,
+               quint64 bit, quint64* fired, Compare compare)
+{
+    if (thresholds) {
+        for (int i = 0; i < count; ++i) {
+            fired[i] |= compare(values[i], thresholds[i]) ? bit : 0;
+        }
+    } else {
+        for (int i = 0; i < count; ++i) {
+            fired[i] |= compare(values[i], threshold) ? bit : 0;
+        }
+    }
+}
+
+} // namespace
+
+HealthRuleEngine::HealthRuleEngine(QObject* parent)
+    : QObject(parent)
+    , m_evaluations(0)
+    , m_flapsSuppressed(0)
+    , m_evaluateTimer(new QTimer(this))
+    , m_dwellTimer(new QTimer(this))
+{
+    // Zero interval: runs once the current batch of deliveries is done
+    m_evaluateTimer->setSingleShot(true);
+    m_evaluateTimer->setInterval(0);
+    connect(m_evaluateTimer, &QTimer::timeout, this, &HealthRuleEngine::evaluate);
+    
+    m_clock.start();
+    m_dwellTimer->setSingleShot(true);
+    connect(m_dwellTimer, &QTimer::timeout, this, &HealthRuleEngine::evaluateDwelling);
+}
+
+HealthRuleEngine::~HealthRuleEngine()
+{
+}
+
+QString HealthRuleEngine::defaultRulesPath()
+{
+    const QString userPath = QDir(QStandardPaths::writableLocation(QStandardPaths::AppConfigLocation))
+                                 .filePath("health_rules.json");
+    return QFile::exists(userPath) ? userPath : BuiltInRulesPath;
+}
+
+bool HealthRuleEngine::loadRules(const QString& path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        m_errorString = QString("Cannot open %1: %2").arg(path, file.errorString());
+        qWarning() << "Health rules not loaded:" << m_errorString;
+        return false;
+    }
+    
+    if (!loadRulesJson(file.readAll())) {
+        m_errorString = QString("%1: %2").arg(path, m_errorString);
+        return false;
+    }
+    
+    m_rulesPath = path;
+    qInfo() << "Loaded" << ruleCount() << "health rules from" << path;
+    return true;
+}
+
+bool HealthRuleEngine::loadRulesJson(const QByteArray& json)
+{
+    QJsonParseError parseError;
+    const QJsonDocument document = QJsonDocument::fromJson(json, &parseError);
+    if (!document.isObject()) {
+        m_errorString = parseError.error != QJsonParseError::NoError
+                        ? parseError.errorString() : QString("Rules must be a JSON object");
+        qWarning() << "Health rules not loaded:" << m_errorString;
+        return false;
+    }
+    
+    // Compile everything before touching the tables, so a bad file changes nothing
+    QHash<QString, QVector<HealthRule>> compiled;
+    const double defaultDwellMs = document.object().value("defaultDwellMs").toDouble(0.0);
+    const QJsonObject types = document.object().value("rules").toObject();
+    for (auto it = types.begin(); it != types.end(); ++it) {
+        const QString& type = it.key();
+        QVector<HealthRule>& table = compiled[type];
+        
+        for (const QJsonValue& value : it.value().toArray()) {
+            const QJsonObject object = value.toObject();
+            const QString parameter = object.value("parameter").toString();
+            
+            HealthRule rule;
+            rule.slot = TelemetrySchema::slotOf(parameter);
+            if (rule.slot == TelemetrySchema::InvalidSlot) {
+                m_errorString = QString("%1: unknown parameter \"%2\"").arg(type, parameter);
+                qWarning() << "Health rules not loaded:" << m_errorString;
+                return false;
+            }
+            
+            if (!parseComparator(object.value("op").toString(), &rule.comparator)) {
+                m_errorString = QString("%1.%2: unknown comparator \"%3\"")
+                                    .arg(type, parameter, object.value("op").toString());
+                qWarning() << "Health rules not loaded:" << m_errorString;
+                return false;
+            }
+            
+            const QJsonValue threshold = object.value("value");
+            if (threshold.isString()) {
+                if (rule.comparator != HealthRule::Equal && rule.comparator != HealthRule::NotEqual) {
+                    m_errorString = QString("%1.%2: text values only support == and !=").arg(type, parameter);
+                    qWarning() << "Health rules not loaded:" << m_errorString;
+                    return false;
+                }
+                rule.text = threshold.toString();
+            } else if (threshold.isDouble()) {
+                rule.threshold = threshold.toDouble();
+            } else {
+                m_errorString = QString("%1.%2: missing value").arg(type, parameter);
+                qWarning() << "Health rules not loaded:" << m_errorString;
+                return false;
+            }
+            
+            const QString health = object.value("health").toString("WARNING").toUpper();
+            if (health == "ERROR") {
+                rule.code = HealthCode::ERROR;
+            } else if (health == "WARNING") {
+                rule.code = HealthCode::WARNING;
+            } else {
+                m_errorString = QString("%1.%2: health must be WARNING or ERROR").arg(type, parameter);
+                qWarning() << "Health rules not loaded:" << m_errorString;
+                return false;
+            }
+            
+            rule.hysteresis = object.value("hysteresis").toDouble(0.0);
+            if (rule.hysteresis < 0.0 || (rule.hysteresis > 0.0 && (!rule.text.isEmpty()
+                    || rule.comparator == HealthRule::Equal || rule.comparator == HealthRule::NotEqual))) {
+                m_errorString = QString("%1.%2: hysteresis needs a numeric <, <=, > or >= rule")
+                                    .arg(type, parameter);
+                qWarning() << "Health rules not loaded:" << m_errorString;
+                return false;
+            }
+            
+            rule.dwellMs = qint64(object.value("dwellMs").toDouble(defaultDwellMs));
+            if (rule.dwellMs < 0 || rule.dwellMs > MaxDwellMs) {
+                m_errorString = QString("%1.%2: dwellMs out of range").arg(type, parameter);
+                qWarning() << "Health rules not loaded:" << m_errorString;
+                return false;
+            }
+            
+            rule.scaleBy = object.value("scaleBy").toString();
+            rule.message = object.value("message").toString();
+            if (rule.message.isEmpty()) {
+                rule.message = QString("%1 %2 %3").arg(parameter, comparatorText(rule.comparator),
+                    rule.text.isEmpty() ? QString::number(rule.threshold) : rule.text);
+            }
+            
+            if (table.size() == MaxRulesPerType) {
+                qWarning() << "Too many health rules for" << type << "- ignoring" << rule.message;
+                continue;
+            }
+            table.append(rule);
+        }
+    }
+    
+    // Groups are referenced by index from m_entries, so they are kept and only refilled
+    for (TypeGroup& group : m_groups) {
+        group.rules = compiled.take(group.type);
+    }
+    for (auto it = compiled.begin(); it != compiled.end(); ++it) {
+        m_groups[groupFor(it.key())].rules = it.value();
+    }
+    
+    // Rule indices changed, so per-rule state starts over
+    for (Entry& entry : m_entries) {
+        entry.active = 0;
+        entry.changing = 0;
+        entry.changingSince.clear();
+    }
+    m_dwellTimer->stop();
+    
+    m_errorString.clear();
+    evaluateAll();
+    return true;
+}
+
+QVector<HealthRule> HealthRuleEngine::rules(const QString& subsystemType) const
+{
+    const int index = m_groupIndex.value(subsystemType, -1);
+    return index >= 0 ? m_groups[index].rules : QVector<HealthRule>();
+}
+
+int HealthRuleEngine::ruleCount() const
+{
+    int count = 0;
+    for (const TypeGroup& group : m_groups) {
+        count += group.rules.size();
+    }
+    return count;
+}
+
+int HealthRuleEngine::groupFor(const QString& subsystemType)
+{
+    auto it = m_groupIndex.constFind(subsystemType);
+    if (it != m_groupIndex.constEnd()) {
+        return it.value();
+    }
+    
+    TypeGroup group;
+    group.type = subsystemType;
+    m_groups.append(group);
+    m_groupIndex.insert(subsystemType, m_groups.size() - 1);
+    return m_groups.size() - 1;
+}
+
+void HealthRuleEngine::watch(SubsystemNode* node)
+{
+    if (!node) {
+        return;
+    }
+    
+    const quint32 handle = node->handle();
+    if (handle == IdInterner::InvalidHandle) {
+        qWarning() << "Cannot evaluate rules for node without a valid ID:" << node->nodeId();
+        return;
+    }
+    
+    if (handle >= quint32(m_entries.size())) {
+        m_entries.resize(int(handle) + 1);
+    }
+    
+    Entry& entry = m_entries[int(handle)];
+    entry.node = node;
+    entry.group = groupFor(node->subsystemType());
+}
+
+void HealthRuleEngine::unwatch(const QString& nodeId)
+{
+    const quint32 handle = IdInterner::instance().find(nodeId);
+    if (handle < quint32(m_entries.size())) {
+        // A stale handle left in a pending list is skipped by the pass
+        m_entries[int(handle)] = Entry();
+    }
+}
+
+void HealthRuleEngine::clear()
+{
+    m_evaluateTimer->stop();
+    m_dwellTimer->stop();
+    m_entries.clear();
+    for (TypeGroup& group : m_groups) {
+        group.pending.clear();
+    }
+}
+
+void HealthRuleEngine::touch(quint32 handle)
+{
+    if (handle >= quint32(m_entries.size())) {
+        return;
+    }
+    
+    Entry& entry = m_entries[int(handle)];
+    if (entry.group < 0 || entry.pending) {
+        return;
+    }
+    
+    entry.pending = true;
+    m_groups[entry.group].pending.append(int(handle));
+    if (!m_evaluateTimer->isActive()) {
+        m_evaluateTimer->start();
+    }
+}
+
+void HealthRuleEngine::evaluateAll()
+{
+    for (int handle = 0; handle < m_entries.size(); ++handle) {
+        Entry& entry = m_entries[handle];
+        if (entry.node && !entry.pending) {
+            entry.pending = true;
+            m_groups[entry.group].pending.append(handle);
+        }
+    }
+    evaluate();
+}
+
+void HealthRuleEngine::evaluate()
+{
+    m_evaluateTimer->stop();
+    for (int i = 0; i < m_groups.size(); ++i) {
+        if (!m_groups[i].pending.isEmpty()) {
+            evaluateGroup(m_groups[i]);
+        }
+    }
+}
+
+void HealthRuleEngine::evaluateGroup(TypeGroup& group)
+{
+    QVector<int> handles;
+    QVector<SubsystemNode*> nodes;
+    handles.reserve(group.pending.size());
+    nodes.reserve(group.pending.size());
+    for (int handle : group.pending) {
+        if (handle >= m_entries.size()) {
+            continue;
+        }
+        Entry& entry = m_entries[handle];
+        if (entry.pending && entry.node) {
+            handles.append(handle);
+            nodes.append(entry.node);
+        }
+        entry.pending = false;
+    }
+    group.pending.clear();
+    
+    // Listeners of setRuleHealth() may add groups, so nothing below refers to group
+    const QVector<HealthRule> rules = group.rules;
+    const int count = nodes.size();
+    if (count == 0) {
+        return;
+    }
+    m_evaluations += quint64(count);
+    
+    QVector<quint64> active(count);
+    for (int i = 0; i < count; ++i) {
+        active[i] = m_entries[handles[i]].active;
+    }
+    
+    // Latest value of each slot the rules read, one column per slot across all nodes
+    std::vector<QVector<double>> columns(TelemetrySchema::MaxSlots);
+    auto column = [&](int slot) -> const double* {
+        QVector<double>& values = columns[size_t(slot)];
+        if (values.isEmpty()) {
+            values.resize(count);
+            for (int i = 0; i < count; ++i) {
+                const TimeSeriesBuffer* series = nodes[i]->telemetryHistory().series(slot);
+                values[i] = series && !series->isEmpty() ? series->latest().value : Missing;
+            }
+        }
+        return values.constData();
+    };
+    
+    QVector<quint64> fired(count, 0);
+    QVector<double> perNode;
+    for (int r = 0; r < rules.size(); ++r) {
+        const HealthRule& rule = rules[r];
+        const quint64 bit = quint64(1) << r;
+        
+        if (!rule.text.isEmpty()) {
+            const QString name = TelemetrySchema::nameOf(rule.slot);
+            const bool wantEqual = rule.comparator == HealthRule::Equal;
+            for (int i = 0; i < count; ++i) {
+                const QVariant value = nodes[i]->property(name);
+                if (value.isValid() && (value.toString() == rule.text) == wantEqual) {
+                    fired[i] |= bit;
+                }
+            }
+            continue;
+        }
+        
+        // An active rule holds until the value is back past the threshold by the band
+        const double release = rule.comparator == HealthRule::Less || rule.comparator == HealthRule::LessEqual
+                               ? rule.hysteresis : -rule.hysteresis;
+        
+        const double* thresholds = nullptr;
+        if (!rule.scaleBy.isEmpty() || rule.hysteresis > 0.0) {
+            perNode.resize(count);
+            for (int i = 0; i < count; ++i) {
+                double scale = 1.0;
+                if (!rule.scaleBy.isEmpty()) {
+                    const QVariant property = nodes[i]->property(rule.scaleBy);
+                    scale = property.isValid() ? property.toDouble() : Missing;
+                }
+                const double threshold = (active[i] & bit) ? rule.threshold + release : rule.threshold;
+                perNode[i] = threshold * scale;
+            }
+            thresholds = perNode.constData();
+        }
+        
+        const double* values = column(rule.slot);
+        quint64* out = fired.data();
+        switch (rule.comparator) {
+            case HealthRule::Less:
+                markFired(values, thresholds, rule.threshold, count, bit, out,
+                          [](double v, double t) { return v < t; });
+                break;
+            case HealthRule::LessEqual:
+                markFired(values, thresholds, rule.threshold, count, bit, out,
+                          [](double v, double t) { return v <= t; });
+                break;
+            case HealthRule::Greater:
+                markFired(values, thresholds, rule.threshold, count, bit, out,
+                          [](double v, double t) { return v > t; });
+                break;
+            case HealthRule::GreaterEqual:
+                markFired(values, thresholds, rule.threshold, count, bit, out,
+                          [](double v, double t) { return v >= t; });
+                break;
+            case HealthRule::Equal:
+                markFired(values, thresholds, rule.threshold, count, bit, out,
+                          [](double v, double t) { return v == t; });
+                break;
+            case HealthRule::NotEqual:
+                // v == v keeps a missing value from firing
+                markFired(values, thresholds, rule.threshold, count, bit, out,
+                          [](double v, double t) { return v == v && v != t; });
+                break;
+        }
+    }
+    
+    // Commit rule transitions that have outlasted their dwell time. Nothing
+    // here calls out, so the entry references stay valid.
+    const qint64 now = m_clock.elapsed();
+    qint64 nextDeadline = std::numeric_limits<qint64>::max();
+    QVector<quint32> flaps(count, 0);
+    for (int i = 0; i < count; ++i) {
+        Entry& entry = m_entries[handles[i]];
+        const quint64 differs = fired[i] ^ entry.active;
+        
+        // Conditions that went back before their dwell ran out
+        flaps[i] = quint32(qPopulationCount(entry.changing & ~differs));
+        entry.changing &= differs;
+        
+        for (quint64 bits = differs; bits; bits &= bits - 1) {
+            const int r = qCountTrailingZeroBits(bits);
+            const quint64 bit = quint64(1) << r;
+            const qint64 dwellMs = rules[r].dwellMs;
+            
+            if (dwellMs <= 0) {
+                entry.active ^= bit;
+            } else if (!(entry.changing & bit)) {
+                if (entry.changingSince.size() < rules.size()) {
+                    entry.changingSince.resize(rules.size());
+                }
+                entry.changing |= bit;
+                entry.changingSince[r] = now;
+                nextDeadline = qMin(nextDeadline, now + dwellMs);
+            } else if (now - entry.changingSince[r] >= dwellMs) {
+                entry.active ^= bit;
+                entry.changing &= ~bit;
+            } else {
+                nextDeadline = qMin(nextDeadline, entry.changingSince[r] + dwellMs);
+            }
+        }
+        active[i] = entry.active;
+    }
+    
+    // Transitions still dwelling are committed even if no more telemetry comes
+    if (nextDeadline != std::numeric_limits<qint64>::max()) {
+        const int delay = int(qMax<qint64>(0, nextDeadline - now));
+        if (!m_dwellTimer->isActive() || m_dwellTimer->remainingTime() > delay) {
+            m_dwellTimer->start(delay);
+        }
+    }
+    
+    for (int i = 0; i < count; ++i) {
+        HealthCode code = HealthCode::OK;
+        QStringList messages;
+        for (quint64 bits = active[i]; bits; bits &= bits - 1) {
+            const HealthRule& rule = rules[qCountTrailingZeroBits(bits)];
+            if (static_cast<int>(rule.code) > static_cast<int>(code)) {
+                code = rule.code;
+                messages.clear();
+            }
+            if (rule.code == code) {
+                messages.append(rule.message);
+            }
+        }
+        
+        if (flaps[i]) {
+            m_flapsSuppressed += flaps[i];
+            nodes[i]->addSuppressedFlaps(flaps[i]);
+        }
+        nodes[i]->setRuleHealth(code, messages.join("; "));
+    }
+}
+
+void HealthRuleEngine::evaluateDwelling()
+{
+    for (int handle = 0; handle < m_entries.size(); ++handle) {
+        Entry& entry = m_entries[handle];
+        if (entry.changing && entry.node && !entry.pending) {
+            entry.pending = true;
+            m_groups[entry.group].pending.append(handle);
+        }
+    }
+    evaluate();
+}
@@ -0,0 +1,155 @@
+/**
+ * @file HealthRuleEngine.h
+ * @brief Configurable health thresholds evaluated per subsystem type
+ */
+
+#ifndef HEALTHRULEENGINE_H
+#define HEALTHRULEENGINE_H
+
+#include <QObject>
+#include <QHash>
+#include <QPointer>
+#include <QString>
+#include <QVector>
+#include <QElapsedTimer>
+#include "HealthStatus.h"
+
+class QByteArray;
+class QTimer;
+class SubsystemNode;
+
+/**
+ * @struct HealthRule
+ * @brief One compiled row of a type's rule table
+ * 
+ * Fires when the node's latest value of the parameter in slot compares
+ * true against the threshold; the node is then at least code. Numeric
+ * rules read the node's TelemetryHistory. Text rules (only == and !=)
+ * compare the node property named after the parameter. With scaleBy set,
+ * the threshold is multiplied by that numeric node property.
+ * 
+ * A numeric rule with a hysteresis band, once fired, keeps firing until
+ * the value is back past the threshold by the band (scaled like the
+ * threshold). A change of a rule's state only counts once the new state
+ * has held for dwellMs.
+ */
+struct HealthRule {
+    enum Comparator { Less, LessEqual, Greater, GreaterEqual, Equal, NotEqual };
+    
+    int slot = -1;
+    Comparator comparator = Greater;
+    double threshold = 0.0;
+    HealthCode code = HealthCode::WARNING;
+    QString text;                   ///< Comparand of a text rule, empty otherwise
+    double hysteresis = 0.0;
+    qint64 dwellMs = 0;
+    QString scaleBy;
+    QString message;
+};
+
+/**
+ * @class HealthRuleEngine
+ * @brief Sets node health from declarative per-type threshold rules
+ * 
+ * Rules come from a JSON file (see loadRules()) and are compiled into one
+ * flat table per subsystem type, with parameter names resolved to
+ * TelemetrySchema slots. Editing the file and reloading it changes the
+ * thresholds without a rebuild.
+ * 
+ * touch() only marks a node as having new telemetry. Marked nodes are
+ * evaluated together once control returns to the event loop, so a whole
+ * dispatcher drain costs one pass. A pass gathers each slot a type's
+ * rules use into a column over all marked nodes of that type and runs
+ * every rule as a tight loop down its column. The worst firing code of a
+ * node goes to SubsystemNode::setRuleHealth(); a node with no firing
+ * rule has its rule health cleared.
+ * 
+ * Each node keeps which of its rules are active. A rule whose condition
+ * flips starts to dwell and only becomes active (or inactive) if the
+ * condition still holds when dwellMs has passed; a condition that flips
+ * back first is counted as a suppressed flap on the node. A timer
+ * re-evaluates dwelling nodes at their deadline, so a transition is
+ * committed even if the node goes quiet. Health only changes, and
+ * healthStatusChanged() only fires, on committed transitions.
+ * 
+ * Single-threaded: call from the thread the nodes live on.
+ */
+class HealthRuleEngine : public QObject
+{
+    Q_OBJECT
+    
+public:
+    // Rules shipped with the application
+    static const QString BuiltInRulesPath;
+    
+    // Rules per type; more than this are dropped with a warning
+    static constexpr int MaxRulesPerType = 64;
+    static constexpr qint64 MaxDwellMs = qint64(3600) * 1000;
+    
+    explicit HealthRuleEngine(QObject* parent = nullptr);
+    ~HealthRuleEngine();
+    
+    // <AppConfigLocation>/health_rules.json if it exists, else the built-in rules
+    static QString defaultRulesPath();
+    
+    // Replaces all rules; on error the previous rules stay in force
+    bool loadRules(const QString& path);
+    bool loadRulesJson(const QByteArray& json);
+    QString rulesPath() const { return m_rulesPath; }
+    QString errorString() const { return m_errorString; }
+    
+    QVector<HealthRule> rules(const QString& subsystemType) const;
+    int ruleCount() const;
+    
+    void watch(SubsystemNode* node);
+    void unwatch(const QString& nodeId);
+    void clear();
+    
+    // The node with this handle has new telemetry
+    void touch(quint32 handle);
+    
+    quint64 evaluations() const { return m_evaluations; }
+    quint64 flapsSuppressed() const { return m_flapsSuppressed; }
+    
+public slots:
+    // Evaluates every node touched since the last pass
+    void evaluate();
+    
+    // Evaluates every watched node, e.g. after the rules changed
+    void evaluateAll();
+    
+private slots:
+    void evaluateDwelling();
+    
+private:
+    struct TypeGroup {
+        QString type;
+        QVector<HealthRule> rules;
+        QVector<int> pending;       ///< Handles touched since the last pass
+    };
+    
+    struct Entry {
+        QPointer<SubsystemNode> node;
+        int group = -1;
+        bool pending = false;
+        quint64 active = 0;         ///< Bit r set while rule r is in force
+        quint64 changing = 0;       ///< Bit r set while rule r dwells on a change
+        QVector<qint64> changingSince;
+    };
+    
+    int groupFor(const QString& subsystemType);
+    void evaluateGroup(TypeGroup& group);
+    
+    QVector<TypeGroup> m_groups;
+    QHash<QString, int> m_groupIndex;
+    QVector<Entry> m_entries;       ///< Indexed by interned node handle
+    QString m_rulesPath;
+    QString m_errorString;
+    quint64 m_evaluations;
+    quint64 m_flapsSuppressed;
+    QElapsedTimer m_clock;
+    QTimer* m_evaluateTimer;
+    QTimer* m_dwellTimer;
+};
+
+#endif // HEALTHRULEENGINE_H
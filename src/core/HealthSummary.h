@@ -0,0 +1,72 @@
+/**
+ * @file HealthSummary.h
+ * @brief Health counts rolled up over a subtree of the node hierarchy
+ */
+
+#ifndef HEALTHSUMMARY_H
+#define HEALTHSUMMARY_H
+
+#include <QMetaType>
+#include "HealthStatus.h"
+
+/**
+ * @struct HealthSummary
+ * @brief Number of nodes per HealthCode in a node's subtree, itself included
+ * 
+ * Counts only ever change by deltas (see SubsystemNode::healthSummary()),
+ * so keeping a summary current costs the same however large the subtree.
+ * worst() ranks ERROR above OFFLINE above WARNING above UNKNOWN above OK.
+ */
+struct HealthSummary {
+    static constexpr int CodeCount = static_cast<int>(HealthCode::UNKNOWN) + 1;
+    
+    int counts[CodeCount] = {};
+    
+    int count(HealthCode code) const { return counts[static_cast<int>(code)]; }
+    
+    int total() const
+    {
+        int sum = 0;
+        for (int n : counts) {
+            sum += n;
+        }
+        return sum;
+    }
+    
+    HealthCode worst() const
+    {
+        static const HealthCode order[] = {
+            HealthCode::ERROR, HealthCode::OFFLINE, HealthCode::WARNING, HealthCode::UNKNOWN
+        };
+        for (HealthCode code : order) {
+            if (count(code) > 0) {
+                return code;
+            }
+        }
+        return HealthCode::OK;
+    }
+    
+    void add(HealthCode code, int n = 1) { counts[static_cast<int>(code)] += n; }
+    
+    void add(const HealthSummary& other, int sign = 1)
+    {
+        for (int i = 0; i < CodeCount; ++i) {
+            counts[i] += sign * other.counts[i];
+        }
+    }
+    
+    bool operator==(const HealthSummary& other) const
+    {
+        for (int i = 0; i < CodeCount; ++i) {
+            if (counts[i] != other.counts[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+    bool operator!=(const HealthSummary& other) const { return !(*this == other); }
+};
+
+Q_DECLARE_METATYPE(HealthSummary)
+
+#endif // HEALTHSUMMARY_H
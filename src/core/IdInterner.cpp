@@ -0,0 +1,78 @@
+/**
+ * @file IdInterner.cpp
+ * @brief Implementation of the process-wide ID interner
+ */
+
+#include "IdInterner.h"
+#include <QReadLocker>
+#include <QWriteLocker>
+#include <QDebug>
+
+IdInterner& IdInterner::instance()
+{
+    static IdInterner inst;
+    return inst;
+}
+
+IdInterner::IdInterner()
+    : m_capacityWarned(false)
+{
+    m_names.append(QString());
+}
+
+quint32 IdInterner::intern(const QString& id)
+{
+    if (id.isEmpty()) {
+        return InvalidHandle;
+    }
+    
+    {
+        QReadLocker locker(&m_lock);
+        auto it = m_handles.constFind(id);
+        if (it != m_handles.constEnd()) {
+            return it.value();
+        }
+    }
+    
+    QWriteLocker locker(&m_lock);
+    
+    // Another thread may have interned it in between
+    auto it = m_handles.constFind(id);
+    if (it != m_handles.constEnd()) {
+        return it.value();
+    }
+    
+    if (m_names.size() > MaxHandles) {
+        if (!m_capacityWarned) {
+            qWarning() << "ID interner full," << MaxHandles << "IDs; further nodes get no handle";
+            m_capacityWarned = true;
+        }
+        return InvalidHandle;
+    }
+    
+    const quint32 handle = static_cast<quint32>(m_names.size());
+    m_names.append(id);
+    m_handles.insert(id, handle);
+    return handle;
+}
+
+quint32 IdInterner::find(const QString& id) const
+{
+    QReadLocker locker(&m_lock);
+    return m_handles.value(id, InvalidHandle);
+}
+
+QString IdInterner::name(quint32 handle) const
+{
+    QReadLocker locker(&m_lock);
+    if (handle >= static_cast<quint32>(m_names.size())) {
+        return QString();
+    }
+    return m_names.at(handle);
+}
+
+int IdInterner::size() const
+{
+    QReadLocker locker(&m_lock);
+    return m_names.size() - 1;
+}
@@ -0,0 +1,61 @@
+/**
+ * @file IdInterner.h
+ * @brief Process-wide mapping of subsystem and node IDs to dense handles
+ */
+
+#ifndef IDINTERNER_H
+#define IDINTERNER_H
+
+#include <QHash>
+#include <QReadWriteLock>
+#include <QString>
+#include <QVector>
+
+/**
+ * @class IdInterner
+ * @brief Interns ID strings into stable 32-bit handles
+ * 
+ * Node IDs are interned when a node is created or renamed, so every later
+ * stage can key on a small integer instead of hashing or comparing a
+ * 36-character UUID. Handles are dense, start at 1 and are never reused;
+ * 0 means "no ID". The strings themselves are only needed for display
+ * and serialization.
+ * 
+ * Subsystem IDs in received packets are only looked up with find(), never
+ * interned: a packet for an ID no node has maps to InvalidHandle and is
+ * counted as unrouted. Stray or hostile traffic therefore cannot use up
+ * the handle space, which is capped at MaxHandles.
+ * 
+ * Thread-safe. Lookups of known IDs take a shared lock; only the first
+ * sighting of an ID takes the exclusive one.
+ */
+class IdInterner
+{
+public:
+    static constexpr quint32 InvalidHandle = 0;
+    static constexpr int MaxHandles = 1 << 20;
+    
+    static IdInterner& instance();
+    
+    // Handle for id, allocating one on first use; "" maps to InvalidHandle.
+    // For node IDs only; IDs from the network go through find()
+    quint32 intern(const QString& id);
+    
+    // Handle for an already interned id, InvalidHandle otherwise
+    quint32 find(const QString& id) const;
+    
+    // ID string for a handle, "" if unknown
+    QString name(quint32 handle) const;
+    
+    int size() const;
+    
+private:
+    IdInterner();
+    
+    QHash<QString, quint32> m_handles;
+    QVector<QString> m_names;           ///< Indexed by handle; slot 0 unused
+    bool m_capacityWarned;
+    mutable QReadWriteLock m_lock;
+};
+
+#endif // IDINTERNER_H
@@ -0,0 +1,191 @@
+/**
+ * @file ParameterDictionary.cpp
+ * @brief Wire ID tables for DefenseProtocol v2
+ */
+
+#include "ParameterDictionary.h"
+
+namespace {
+
+struct ParameterEntry {
+    quint16 typeId;         ///< Generic for common parameters
+    quint16 id;
+    const char* name;
+    const char* const* enumValues;  ///< Null-terminated, or nullptr for numeric
+};
+
+const char* const PumpStatusValues[] = { "Stopped", "Running", "Fault", nullptr };
+const char* const LinkStatusValues[] = { "Down", "Up", "Degraded", nullptr };
+const char* const WatchdogStatusValues[] = { "OK", "Warning", "Triggered", nullptr };
+
+const char* const SubsystemTypeNames[] = {
+    "",
+    "RFFrontend",
+    "SignalProcessor",
+    "Tracker",
+    "AntennaServo",
+    "DataFusion",
+    "PowerSupply",
+    "NetworkInterface",
+    "CoolingSystem",
+    "EmbeddedController"
+};
+
+const ParameterEntry Parameters[] = {
+    // Common to all subsystem types
+    { ParameterDictionary::Generic, 1, "temperature", nullptr },
+    { ParameterDictionary::Generic, 2, "voltage", nullptr },
+    { ParameterDictionary::Generic, 3, "current", nullptr },
+    { ParameterDictionary::Generic, 4, "power", nullptr },
+    { ParameterDictionary::Generic, 5, "frequency", nullptr },
+    { ParameterDictionary::Generic, 6, "latency", nullptr },
+    { ParameterDictionary::Generic, 7, "error_count", nullptr },
+    { ParameterDictionary::Generic, 8, "cpu_load", nullptr },
+    { ParameterDictionary::Generic, 9, "memory_usage", nullptr },
+    { ParameterDictionary::Generic, 10, "uptime", nullptr },
+    
+    { ParameterDictionary::RFFrontend, 0x100, "tx_power", nullptr },
+    { ParameterDictionary::RFFrontend, 0x101, "vswr", nullptr },
+    { ParameterDictionary::RFFrontend, 0x102, "rx_sensitivity", nullptr },
+    
+    { ParameterDictionary::SignalProcessor, 0x100, "buffer_utilization", nullptr },
+    { ParameterDictionary::SignalProcessor, 0x101, "error_rate", nullptr },
+    { ParameterDictionary::SignalProcessor, 0x102, "throughput", nullptr },
+    
+    { ParameterDictionary::Tracker, 0x100, "track_count", nullptr },
+    { ParameterDictionary::Tracker, 0x101, "update_rate", nullptr },
+    { ParameterDictionary::Tracker, 0x102, "track_quality", nullptr },
+    { ParameterDictionary::Tracker, 0x103, "max_tracks", nullptr },
+    
+    { ParameterDictionary::AntennaServo, 0x100, "azimuth", nullptr },
+    { ParameterDictionary::AntennaServo, 0x101, "elevation", nullptr },
+    { ParameterDictionary::AntennaServo, 0x102, "azimuth_rate", nullptr },
+    { ParameterDictionary::AntennaServo, 0x103, "elevation_rate", nullptr },
+    { ParameterDictionary::AntennaServo, 0x104, "position_error", nullptr },
+    { ParameterDictionary::AntennaServo, 0x105, "motor_current", nullptr },
+    
+    { ParameterDictionary::DataFusion, 0x100, "active_sources", nullptr },
+    { ParameterDictionary::DataFusion, 0x101, "fusion_quality", nullptr },
+    { ParameterDictionary::DataFusion, 0x102, "output_rate", nullptr },
+    
+    { ParameterDictionary::PowerSupply, 0x100, "efficiency", nullptr },
+    { ParameterDictionary::PowerSupply, 0x101, "ac_power", nullptr },
+    
+    { ParameterDictionary::NetworkInterface, 0x100, "bandwidth_utilization", nullptr },
+    { ParameterDictionary::NetworkInterface, 0x101, "packet_loss", nullptr },
+    { ParameterDictionary::NetworkInterface, 0x102, "link_status", LinkStatusValues },
+    { ParameterDictionary::NetworkInterface, 0x103, "rx_rate", nullptr },
+    { ParameterDictionary::NetworkInterface, 0x104, "tx_rate", nullptr },
+    
+    { ParameterDictionary::CoolingSystem, 0x100, "coolant_temp", nullptr },
+    { ParameterDictionary::CoolingSystem, 0x101, "ambient_temp", nullptr },
+    { ParameterDictionary::CoolingSystem, 0x102, "flow_rate", nullptr },
+    { ParameterDictionary::CoolingSystem, 0x103, "fan_speed", nullptr },
+    { ParameterDictionary::CoolingSystem, 0x104, "pump_status", PumpStatusValues },
+    
+    { ParameterDictionary::EmbeddedController, 0x100, "watchdog_status", WatchdogStatusValues }
+};
+
+const ParameterEntry* findById(quint16 typeId, quint16 parameterId)
+{
+    // Common IDs are shared; type-specific IDs only match their own type
+    quint16 owner = parameterId < ParameterDictionary::TypeSpecificBase
+                    ? quint16(ParameterDictionary::Generic) : typeId;
+    
+    for (const ParameterEntry& entry : Parameters) {
+        if (entry.typeId == owner && entry.id == parameterId) {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+const ParameterEntry* findByName(quint16 typeId, const QString& name)
+{
+    for (const ParameterEntry& entry : Parameters) {
+        if ((entry.typeId == ParameterDictionary::Generic || entry.typeId == typeId)
+            && name == QLatin1String(entry.name)) {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+} // namespace
+
+quint16 ParameterDictionary::subsystemTypeId(const QString& subsystemType)
+{
+    constexpr int count = sizeof(SubsystemTypeNames) / sizeof(SubsystemTypeNames[0]);
+    for (int i = 1; i < count; ++i) {
+        if (subsystemType == QLatin1String(SubsystemTypeNames[i])) {
+            return static_cast<quint16>(i);
+        }
+    }
+    return Generic;
+}
+
+QString ParameterDictionary::subsystemTypeName(quint16 typeId)
+{
+    constexpr int count = sizeof(SubsystemTypeNames) / sizeof(SubsystemTypeNames[0]);
+    if (typeId < count) {
+        return QString::fromLatin1(SubsystemTypeNames[typeId]);
+    }
+    return QString();
+}
+
+quint16 ParameterDictionary::parameterId(quint16 typeId, const QString& name)
+{
+    const ParameterEntry* entry = findByName(typeId, name);
+    return entry ? entry->id : InvalidParameterId;
+}
+
+QString ParameterDictionary::parameterName(quint16 typeId, quint16 parameterId)
+{
+    const ParameterEntry* entry = findById(typeId, parameterId);
+    return entry ? QString::fromLatin1(entry->name) : QString();
+}
+
+bool ParameterDictionary::isEnumParameter(quint16 typeId, quint16 parameterId)
+{
+    const ParameterEntry* entry = findById(typeId, parameterId);
+    return entry && entry->enumValues;
+}
+
+int ParameterDictionary::enumValue(quint16 typeId, quint16 parameterId, const QString& text)
+{
+    const ParameterEntry* entry = findById(typeId, parameterId);
+    if (!entry || !entry->enumValues) {
+        return -1;
+    }
+    
+    for (int i = 0; entry->enumValues[i]; ++i) {
+        if (text.compare(QLatin1String(entry->enumValues[i]), Qt::CaseInsensitive) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+QString ParameterDictionary::enumText(quint16 typeId, quint16 parameterId, int value)
+{
+    const ParameterEntry* entry = findById(typeId, parameterId);
+    if (!entry || !entry->enumValues || value < 0) {
+        return QString();
+    }
+    
+    for (int i = 0; entry->enumValues[i]; ++i) {
+        if (i == value) {
+            return QString::fromLatin1(entry->enumValues[i]);
+        }
+    }
+    return QString();
+}
+
+QVector<ParameterDictionary::ParameterInfo> ParameterDictionary::parameters()
+{
+    QVector<ParameterInfo> result;
+    for (const ParameterEntry& entry : Parameters) {
+        result.append(ParameterInfo{entry.typeId, entry.id, QString::fromLatin1(entry.name)});
+    }
+    return result;
+}
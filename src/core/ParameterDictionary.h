@@ -0,0 +1,68 @@
+/**
+ * @file ParameterDictionary.h
+ * @brief Shared numeric IDs for subsystem types and telemetry parameters
+ */
+
+#ifndef PARAMETERDICTIONARY_H
+#define PARAMETERDICTIONARY_H
+
+#include <QString>
+#include <QVector>
+
+/**
+ * @class ParameterDictionary
+ * @brief Maps telemetry parameter names to compact wire IDs per subsystem type
+ * 
+ * Used by DefenseProtocol v2, which carries numeric IDs instead of names.
+ * IDs below TypeSpecificBase are common to every subsystem type; IDs from
+ * TypeSpecificBase upwards are interpreted per subsystem type. Status
+ * strings (pump_status, link_status, ...) are sent as enumerated values.
+ * 
+ * IDs are part of the wire format: never renumber an entry, only append.
+ */
+class ParameterDictionary
+{
+public:
+    enum SubsystemTypeId : quint16 {
+        Generic = 0,
+        RFFrontend = 1,
+        SignalProcessor = 2,
+        Tracker = 3,
+        AntennaServo = 4,
+        DataFusion = 5,
+        PowerSupply = 6,
+        NetworkInterface = 7,
+        CoolingSystem = 8,
+        EmbeddedController = 9
+    };
+    
+    static constexpr quint16 InvalidParameterId = 0;
+    static constexpr quint16 TypeSpecificBase = 0x100;
+    
+    struct ParameterInfo {
+        quint16 typeId;         ///< Generic for common parameters
+        quint16 parameterId;
+        QString name;
+    };
+    
+    // Subsystem types
+    static quint16 subsystemTypeId(const QString& subsystemType);
+    static QString subsystemTypeName(quint16 typeId);
+    
+    // Parameters; unknown names map to InvalidParameterId, unknown IDs to ""
+    static quint16 parameterId(quint16 typeId, const QString& name);
+    static QString parameterName(quint16 typeId, quint16 parameterId);
+    
+    // Enumerated string values; unknown text maps to -1
+    static bool isEnumParameter(quint16 typeId, quint16 parameterId);
+    static int enumValue(quint16 typeId, quint16 parameterId, const QString& text);
+    static QString enumText(quint16 typeId, quint16 parameterId, int value);
+    
+    // Every known parameter, common ones first, in table order
+    static QVector<ParameterInfo> parameters();
+    
+private:
+    ParameterDictionary() = default;
+};
+
+#endif // PARAMETERDICTIONARY_H
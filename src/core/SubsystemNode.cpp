@@ -4,6 +4,7 @@
  */
 
 #include "SubsystemNode.h"
+#include "IdInterner.h"
 #include "../graph/NodeGraphScene.h"
 #include <QJsonDocument>
 #include <QJsonObject>
@@ -13,16 +14,39 @@
 SubsystemNode::SubsystemNode(QObject* parent)
     : QObject(parent)
     , m_nodeId(QUuid::createUuid().toString(QUuid::WithoutBraces))
+    , m_handle(IdInterner::instance().intern(m_nodeId))
     , m_nodeName("Unnamed Subsystem")
+    , m_reportedCode(HealthCode::UNKNOWN)
+    , m_reportedMessage("Node created")
+    , m_ruleCode(HealthCode::OK)
+    , m_suppressedFlaps(0)
+    , m_impactState(ImpactState::None)
     , m_hasChildGraph(false)
     , m_expanded(false)
+    , m_propertyUpdateDepth(0)
 {
     // Initialize with unknown health status
     m_healthStatus = HealthStatus(HealthCode::UNKNOWN, "Node created");
+    m_healthSummary.add(HealthCode::UNKNOWN);
 }
 
 SubsystemNode::~SubsystemNode()
 {
+    // Children outlive their graph only as loose nodes; they have nothing to report to
+    if (m_childGraph) {
+        for (SubsystemNode* child : m_childGraph->allNodes()) {
+            if (child->m_parentNode == this) {
+                child->m_parentNode = nullptr;
+            }
+        }
+    }
+    setParentNode(nullptr);
+}
+
+void SubsystemNode::setNodeId(const QString& id)
+{
+    m_nodeId = id;
+    m_handle = IdInterner::instance().intern(id);
 }
 
 void SubsystemNode::setNodeName(const QString& name)
@@ -35,27 +59,162 @@ void SubsystemNode::setNodeName(const QString& name)
 
 void SubsystemNode::setHealthStatus(const HealthStatus& status)
 {
-    m_healthStatus = status;
-    emit healthStatusChanged(status);
+    // Taken as the reported health, so rule evaluation keeps it
+    m_reportedCode = status.code();
+    m_reportedMessage = status.message();
+    if (applyHealth()) {
+        emit healthStatusChanged(m_healthStatus);
+    }
 }
 
 void SubsystemNode::updateHealth(const TelemetryPacket& packet)
 {
     // Update health status from telemetry packet
-    m_healthStatus.update(packet.healthCode(), packet.healthMessage());
+    m_reportedCode = packet.healthCode();
+    m_reportedMessage = packet.healthMessage();
+    const bool changed = applyHealth();
     m_telemetryData = packet;
+    m_history.record(packet);
     
     // Call virtual method for derived class customization
-    onHealthUpdate(packet);
+    {
+        PropertyUpdateScope scope(this);
+        onHealthUpdate(packet);
+    }
     
-    emit healthStatusChanged(m_healthStatus);
+    // Only a committed transition reaches listeners that repaint
+    if (changed) {
+        emit healthStatusChanged(m_healthStatus);
+    }
     emit telemetryUpdated(packet);
 }
 
+void SubsystemNode::updateHealthBatch(const QVector<TelemetryPacket>& packets)
+{
+    if (packets.isEmpty()) {
+        return;
+    }
+    
+    // Every packet reaches onHealthUpdate(). Listeners see each change of
+    // the committed code as it happens, so a fault that clears within the
+    // batch is not lost; message-only changes are reported once at the end.
+    HealthCode notifiedCode = m_healthStatus.code();
+    QString notifiedMessage = m_healthStatus.message();
+    {
+        PropertyUpdateScope scope(this);
+        for (const TelemetryPacket& packet : packets) {
+            m_reportedCode = packet.healthCode();
+            m_reportedMessage = packet.healthMessage();
+            applyHealth();
+            m_telemetryData = packet;
+            m_history.record(packet);
+            onHealthUpdate(packet);
+            
+            if (m_healthStatus.code() != notifiedCode) {
+                notifiedCode = m_healthStatus.code();
+                notifiedMessage = m_healthStatus.message();
+                emit healthStatusChanged(m_healthStatus);
+            }
+        }
+    }
+    
+    if (m_healthStatus.message() != notifiedMessage) {
+        emit healthStatusChanged(m_healthStatus);
+    }
+    emit telemetryUpdated(m_telemetryData);
+}
+
 void SubsystemNode::updateHealth(HealthCode code, const QString& message)
 {
-    m_healthStatus.update(code, message);
-    emit healthStatusChanged(m_healthStatus);
+    m_reportedCode = code;
+    m_reportedMessage = message;
+    if (applyHealth()) {
+        emit healthStatusChanged(m_healthStatus);
+    }
+}
+
+void SubsystemNode::setRuleHealth(HealthCode code, const QString& message)
+{
+    if (code == m_ruleCode && message == m_ruleMessage) {
+        return;
+    }
+    
+    m_ruleCode = code;
+    m_ruleMessage = message;
+    
+    if (applyHealth()) {
+        emit healthStatusChanged(m_healthStatus);
+    }
+}
+
+bool SubsystemNode::applyHealth()
+{
+    const HealthCode previousCode = m_healthStatus.code();
+    const QString previousMessage = m_healthStatus.message();
+    const bool reporting = m_reportedCode == HealthCode::OK || m_reportedCode == HealthCode::WARNING;
+    if (reporting && static_cast<int>(m_ruleCode) > static_cast<int>(m_reportedCode)) {
+        m_healthStatus.update(m_ruleCode, m_ruleMessage);
+    } else {
+        m_healthStatus.update(m_reportedCode, m_reportedMessage);
+    }
+    propagateCodeChange(previousCode, m_healthStatus.code());
+    return m_healthStatus.code() != previousCode || m_healthStatus.message() != previousMessage;
+}
+
+void SubsystemNode::propagateCodeChange(HealthCode from, HealthCode to)
+{
+    if (from == to) {
+        return;
+    }
+    
+    HealthSummary delta;
+    delta.add(from, -1);
+    delta.add(to);
+    propagateSummary(delta);
+}
+
+void SubsystemNode::propagateSummary(const HealthSummary& delta, int sign)
+{
+    for (SubsystemNode* node = this; node; node = node->m_parentNode) {
+        node->m_healthSummary.add(delta, sign);
+        emit node->healthSummaryChanged(node->m_healthSummary);
+    }
+}
+
+void SubsystemNode::setImpact(ImpactState state, const QString& rootCauseName)
+{
+    const QString rootCause = state == ImpactState::None ? QString() : rootCauseName;
+    if (state == m_impactState && rootCause == m_impactRootCause) {
+        return;
+    }
+    
+    m_impactState = state;
+    m_impactRootCause = rootCause;
+    emit impactChanged(state);
+}
+
+bool SubsystemNode::setParentNode(SubsystemNode* parent)
+{
+    if (parent == m_parentNode) {
+        return true;
+    }
+    
+    for (SubsystemNode* ancestor = parent; ancestor; ancestor = ancestor->m_parentNode) {
+        if (ancestor == this) {
+            qWarning() << "Cannot place" << m_nodeName << "inside its own subtree";
+            return false;
+        }
+    }
+    
+    if (m_parentNode) {
+        m_parentNode->propagateSummary(m_healthSummary, -1);
+    }
+    
+    m_parentNode = parent;
+    if (parent) {
+        parent->propagateSummary(m_healthSummary);
+    }
+    return true;
 }
 
 void SubsystemNode::addInputPort(const QString& name, PortType type, const QString& dataType)
@@ -139,9 +298,52 @@ void SubsystemNode::setExpanded(bool expanded)
 
 void SubsystemNode::setProperty(const QString& key, const QVariant& value)
 {
-    m_properties[key] = value;
+    auto it = m_properties.find(key);
+    if (it != m_properties.end() && it.value() == value) {
+        return;
+    }
+    
+    if (it != m_properties.end()) {
+        it.value() = value;
+    } else {
+        m_properties.insert(key, value);
+    }
     onPropertyChanged(key, value);
+    
+    if (m_propertyUpdateDepth > 0) {
+        if (!m_changedProperties.contains(key)) {
+            m_changedProperties.append(key);
+        }
+        return;
+    }
+    
     emit propertyChanged(key, value);
+    emit propertiesChanged(QStringList{key});
+}
+
+void SubsystemNode::beginPropertyUpdate()
+{
+    m_propertyUpdateDepth++;
+}
+
+void SubsystemNode::commitPropertyUpdate()
+{
+    if (m_propertyUpdateDepth == 0) {
+        qWarning() << "commitPropertyUpdate() without beginPropertyUpdate() on" << m_nodeId;
+        return;
+    }
+    
+    if (--m_propertyUpdateDepth > 0 || m_changedProperties.isEmpty()) {
+        return;
+    }
+    
+    // Per-key signals still fire for existing listeners, then the summary
+    const QStringList changed = std::move(m_changedProperties);
+    m_changedProperties.clear();
+    for (const QString& key : changed) {
+        emit propertyChanged(key, m_properties.value(key));
+    }
+    emit propertiesChanged(changed);
 }
 
 QVariant SubsystemNode::property(const QString& key) const
@@ -211,14 +413,20 @@ bool SubsystemNode::deserialize(const QString& data)
     }
     
     QJsonObject json = doc.object();
-    m_nodeId = json["nodeId"].toString();
+    setNodeId(json["nodeId"].toString());
     m_nodeName = json["nodeName"].toString();
     m_hasChildGraph = json["hasChildGraph"].toBool();
     m_expanded = json["expanded"].toBool();
     
-    // Deserialize health status
-    QString healthData = json["healthStatus"].toString();
-    m_healthStatus = HealthStatus::deserialize(healthData);
+    // Deserialize health status as the reported health, so later rule
+    // evaluation keeps it, and commit it through applyHealth() so the
+    // summaries of this node and its ancestors follow the restored code
+    const HealthStatus restored = HealthStatus::deserialize(json["healthStatus"].toString());
+    m_reportedCode = restored.code();
+    m_reportedMessage = restored.message();
+    if (applyHealth()) {
+        emit healthStatusChanged(m_healthStatus);
+    }
     
     // Deserialize properties
     QJsonObject props = json["properties"].toObject();
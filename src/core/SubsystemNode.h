@@ -7,13 +7,18 @@
 #define SUBSYSTEMNODE_H
 
 #include <QObject>
+#include <QPointer>
 #include <QString>
 #include <QUuid>
 #include <QMap>
+#include <QStringList>
 #include <QVariant>
+#include <QVector>
 #include <memory>
 #include "HealthStatus.h"
+#include "HealthSummary.h"
 #include "TelemetryPacket.h"
+#include "TelemetryHistory.h"
 
 class NodeGraphScene;
 
@@ -32,6 +37,16 @@ enum class PortType {
     ControlOutput    ///< Sends control commands
 };
 
+/**
+ * @enum ImpactState
+ * @brief Whether a failure upstream in the graph affects a node
+ */
+enum class ImpactState {
+    None,            ///< No failed node feeds this one
+    Impacted,        ///< Fed by a failed node; own health is not alarming
+    Suppressed       ///< Fed by a failed node; own alarm is a symptom of it
+};
+
 /**
  * @struct NodePort
  * @brief Represents an input/output port on a subsystem node
@@ -59,6 +74,27 @@ struct NodePort {
  * - Telemetry data binding
  * - Serialization/deserialization
  * - Real-time visual updates
+ * 
+ * Property changes made between beginPropertyUpdate() and
+ * commitPropertyUpdate() (or inside a PropertyUpdateScope) are announced
+ * together at commit, so a telemetry packet that touches ten properties
+ * produces one propertiesChanged() instead of ten. Health updates always
+ * run onHealthUpdate() inside such a scope. Setting a property to the
+ * value it already has does nothing.
+ * 
+ * Every numeric schema parameter a node receives is also appended to its
+ * TelemetryHistory, which is bounded by the configured depth.
+ * 
+ * The health a node shows is the one its subsystem reports, unless a
+ * threshold rule set through setRuleHealth() is worse. Rules only raise
+ * OK or WARNING; a reported OFFLINE or UNKNOWN always stands.
+ * 
+ * A node placed in another node's child graph has that node as its
+ * parentNode(). healthSummary() counts the health codes of the node and
+ * everything below it. When a node's code changes, or a subtree is
+ * attached or detached, the difference is applied to each ancestor in
+ * turn, so an update costs O(depth) regardless of how many nodes the
+ * hierarchy holds.
  */
 class SubsystemNode : public QObject
 {
@@ -68,9 +104,10 @@ public:
     explicit SubsystemNode(QObject* parent = nullptr);
     virtual ~SubsystemNode();
     
-    // Core identification
+    // Core identification; handle() is the interned nodeId (see IdInterner)
     QString nodeId() const { return m_nodeId; }
-    void setNodeId(const QString& id) { m_nodeId = id; }
+    void setNodeId(const QString& id);
+    quint32 handle() const { return m_handle; }
     
     QString nodeName() const { return m_nodeName; }
     void setNodeName(const QString& name);
@@ -80,11 +117,25 @@ public:
     
     // Health monitoring
     HealthStatus healthStatus() const { return m_healthStatus; }
+    
+    // Sets the reported health; rule health still applies on top of it
     void setHealthStatus(const HealthStatus& status);
     
     virtual void updateHealth(const TelemetryPacket& packet);
     virtual void updateHealth(HealthCode code, const QString& message = "");
     
+    // Applies packets in order; healthStatusChanged fires at each change of
+    // health code, telemetryUpdated once with the last packet
+    virtual void updateHealthBatch(const QVector<TelemetryPacket>& packets);
+    
+    // Health derived from threshold rules (see HealthRuleEngine); OK clears it
+    void setRuleHealth(HealthCode code, const QString& message = "");
+    HealthCode ruleHealthCode() const { return m_ruleCode; }
+    
+    // Rule transitions that reverted within their dwell time
+    quint32 suppressedFlaps() const { return m_suppressedFlaps; }
+    void addSuppressedFlaps(quint32 count) { m_suppressedFlaps += count; }
+    
     // Port management
     void addInputPort(const QString& name, PortType type, const QString& dataType = "any");
     void addOutputPort(const QString& name, PortType type, const QString& dataType = "any");
@@ -104,6 +155,18 @@ public:
     NodeGraphScene* childGraph() const { return m_childGraph.get(); }
     void createChildGraph();
     
+    // Owner of the child graph this node sits in; set by NodeGraphScene
+    SubsystemNode* parentNode() const { return m_parentNode; }
+    bool setParentNode(SubsystemNode* parent);
+    
+    // Health codes of this node and all nodes below it
+    const HealthSummary& healthSummary() const { return m_healthSummary; }
+    
+    // Upstream failure affecting this node (see ImpactEngine)
+    void setImpact(ImpactState state, const QString& rootCauseName = QString());
+    ImpactState impactState() const { return m_impactState; }
+    QString impactRootCause() const { return m_impactRootCause; }
+    
     bool isExpanded() const { return m_expanded; }
     void setExpanded(bool expanded);
     
@@ -112,10 +175,19 @@ public:
     QVariant property(const QString& key) const;
     QMap<QString, QVariant> allProperties() const { return m_properties; }
     
+    // Batched property changes; calls nest, notification happens at the outermost commit
+    void beginPropertyUpdate();
+    void commitPropertyUpdate();
+    bool isUpdatingProperties() const { return m_propertyUpdateDepth > 0; }
+    
     // Telemetry data binding
     void bindTelemetryPacket(const TelemetryPacket& packet);
     TelemetryPacket telemetryData() const { return m_telemetryData; }
     
+    // Parameter history (see TelemetryHistory); setting the depth clears it
+    const TelemetryHistory& telemetryHistory() const { return m_history; }
+    void setHistoryDepth(int samples) { m_history.setDepth(samples); }
+    
     // Visual rendering (implemented by derived classes)
     virtual QColor nodeColor() const;
     virtual QString nodeIcon() const { return ""; }
@@ -129,8 +201,11 @@ public:
     
 signals:
     void healthStatusChanged(const HealthStatus& status);
+    void healthSummaryChanged(const HealthSummary& summary);
+    void impactChanged(ImpactState state);
     void nodeNameChanged(const QString& name);
     void propertyChanged(const QString& key, const QVariant& value);
+    void propertiesChanged(const QStringList& keys);
     void telemetryUpdated(const TelemetryPacket& packet);
     void expandedStateChanged(bool expanded);
     
@@ -143,15 +218,33 @@ protected:
     QString generatePortId(const QString& portName) const;
     
 private:
+    // Combines reported and rule health into m_healthStatus; true if its
+    // code or message changed
+    bool applyHealth();
+    
+    // Applies a summary difference to this node and every ancestor
+    void propagateSummary(const HealthSummary& delta, int sign = 1);
+    void propagateCodeChange(HealthCode from, HealthCode to);
+    
     QString m_nodeId;
+    quint32 m_handle;
     QString m_nodeName;
     HealthStatus m_healthStatus;
+    HealthCode m_reportedCode;
+    QString m_reportedMessage;
+    HealthCode m_ruleCode;
+    QString m_ruleMessage;
+    quint32 m_suppressedFlaps;
     
     // Port management
     QMap<QString, NodePort> m_inputPorts;
     QMap<QString, NodePort> m_outputPorts;
     
     // Hierarchical support
+    QPointer<SubsystemNode> m_parentNode;
+    HealthSummary m_healthSummary;
+    ImpactState m_impactState;
+    QString m_impactRootCause;
     bool m_hasChildGraph;
     bool m_expanded;
     std::unique_ptr<NodeGraphScene> m_childGraph;
@@ -159,6 +252,36 @@ private:
     // Properties and telemetry
     QMap<QString, QVariant> m_properties;
     TelemetryPacket m_telemetryData;
+    TelemetryHistory m_history;
+    
+    // Open property update (see beginPropertyUpdate)
+    int m_propertyUpdateDepth;
+    QStringList m_changedProperties;
+};
+
+/**
+ * @class PropertyUpdateScope
+ * @brief RAII helper around SubsystemNode::begin/commitPropertyUpdate
+ */
+class PropertyUpdateScope
+{
+public:
+    explicit PropertyUpdateScope(SubsystemNode* node)
+        : m_node(node)
+    {
+        m_node->beginPropertyUpdate();
+    }
+    
+    ~PropertyUpdateScope()
+    {
+        m_node->commitPropertyUpdate();
+    }
+    
+    PropertyUpdateScope(const PropertyUpdateScope&) = delete;
+    PropertyUpdateScope& operator=(const PropertyUpdateScope&) = delete;
+    
+private:
+    SubsystemNode* m_node;
 };
 
 #endif // SUBSYSTEMNODE_H
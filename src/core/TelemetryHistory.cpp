@@ -0,0 +1,288 @@
+/**
+ * @file TelemetryHistory.cpp
+ * @brief Implementation of per-node telemetry history
+ */
+
+#include "TelemetryHistory.h"
+#include "TelemetryPacket.h"
+#include <QDateTime>
+#include <QtAlgorithms>
+
+namespace {
+
+qint64 bucketStart(qint64 timestamp, qint64 width)
+{
+    qint64 offset = timestamp % width;
+    if (offset < 0) {
+        offset += width;
+    }
+    return timestamp - offset;
+}
+
+} // namespace
+
+TimeSeriesBuffer::TimeSeriesBuffer(int depth, int bucketCount)
+    : m_timestamps(depth)
+    , m_values(depth)
+    , m_head(depth - 1)
+    , m_size(0)
+{
+    for (int i = 0; i < LevelCount; ++i) {
+        m_levels[i].width = LevelWidthsMs[i];
+        m_levels[i].buckets.resize(bucketCount);
+        m_levels[i].head = bucketCount - 1;
+        m_levels[i].size = 0;
+    }
+}
+
+void TimeSeriesBuffer::append(qint64 timestamp, double value)
+{
+    const int depth = m_timestamps.size();
+    m_head = (m_head + 1) % depth;
+    m_timestamps[m_head] = timestamp;
+    m_values[m_head] = value;
+    m_size = qMin(m_size + 1, depth);
+    
+    for (Level& level : m_levels) {
+        addToLevel(level, timestamp, value);
+    }
+}
+
+void TimeSeriesBuffer::addToLevel(Level& level, qint64 timestamp, double value)
+{
+    const int capacity = level.buckets.size();
+    const qint64 start = bucketStart(timestamp, level.width);
+    
+    if (level.size == 0 || start > level.buckets[level.head].start) {
+        level.head = (level.head + 1) % capacity;
+        level.size = qMin(level.size + 1, capacity);
+        
+        HistoryBucket& bucket = level.buckets[level.head];
+        bucket.start = start;
+        bucket.width = level.width;
+        bucket.minimum = value;
+        bucket.maximum = value;
+        bucket.sum = value;
+        bucket.count = 1;
+        return;
+    }
+    
+    // Late sample: walk back to its bucket, usually the newest one
+    for (int i = 0; i < level.size; ++i) {
+        HistoryBucket& bucket = level.buckets[(level.head - i + capacity) % capacity];
+        if (bucket.start == start) {
+            bucket.minimum = qMin(bucket.minimum, value);
+            bucket.maximum = qMax(bucket.maximum, value);
+            bucket.sum += value;
+            bucket.count++;
+            return;
+        }
+        if (bucket.start < start) {
+            return;     // Interval had no samples and has no bucket
+        }
+    }
+}
+
+void TimeSeriesBuffer::clear()
+{
+    m_head = m_timestamps.size() - 1;
+    m_size = 0;
+    for (Level& level : m_levels) {
+        level.head = level.buckets.size() - 1;
+        level.size = 0;
+    }
+}
+
+HistorySample TimeSeriesBuffer::latest() const
+{
+    HistorySample sample;
+    if (m_size > 0) {
+        sample.timestamp = m_timestamps[m_head];
+        sample.value = m_values[m_head];
+    }
+    return sample;
+}
+
+QVector<HistorySample> TimeSeriesBuffer::samples(qint64 from, qint64 to) const
+{
+    QVector<HistorySample> result;
+    const int depth = m_timestamps.size();
+    const int oldest = (m_head - m_size + 1 + depth) % depth;
+    
+    for (int i = 0; i < m_size; ++i) {
+        const int index = (oldest + i) % depth;
+        const qint64 timestamp = m_timestamps[index];
+        if (timestamp >= from && timestamp <= to) {
+            HistorySample sample;
+            sample.timestamp = timestamp;
+            sample.value = m_values[index];
+            result.append(sample);
+        }
+    }
+    return result;
+}
+
+QVector<HistoryBucket> TimeSeriesBuffer::buckets(int level, qint64 from, qint64 to) const
+{
+    QVector<HistoryBucket> result;
+    if (level < 0 || level >= LevelCount) {
+        return result;
+    }
+    
+    const Level& source = m_levels[level];
+    const int capacity = source.buckets.size();
+    const int oldest = (source.head - source.size + 1 + capacity) % capacity;
+    
+    for (int i = 0; i < source.size; ++i) {
+        const HistoryBucket& bucket = source.buckets[(oldest + i) % capacity];
+        if (bucket.start + bucket.width > from && bucket.start <= to) {
+            result.append(bucket);
+        }
+    }
+    return result;
+}
+
+int TimeSeriesBuffer::levelFor(qint64 from, qint64 to, int maxBuckets) const
+{
+    const qint64 span = qMax<qint64>(0, to - from);
+    
+    for (int i = 0; i < LevelCount; ++i) {
+        const Level& level = m_levels[i];
+        if (span / level.width + 1 > maxBuckets) {
+            continue;
+        }
+        
+        // A level that has evicted buckets only covers back to its oldest one
+        const int capacity = level.buckets.size();
+        const bool wrapped = level.size == capacity;
+        const int oldest = (level.head - level.size + 1 + capacity) % capacity;
+        if (!wrapped || level.buckets[oldest].start <= from) {
+            return i;
+        }
+    }
+    return LevelCount - 1;
+}
+
+size_t TimeSeriesBuffer::memoryUsage() const
+{
+    size_t bytes = sizeof(*this);
+    bytes += m_timestamps.capacity() * sizeof(qint64);
+    bytes += m_values.capacity() * sizeof(double);
+    for (const Level& level : m_levels) {
+        bytes += level.buckets.capacity() * sizeof(HistoryBucket);
+    }
+    return bytes;
+}
+
+TelemetryHistory::TelemetryHistory()
+    : m_depth(DefaultDepth)
+    , m_bucketCount(DefaultBucketCount)
+    , m_recordedSlots(0)
+{
+}
+
+TelemetryHistory::~TelemetryHistory()
+{
+}
+
+void TelemetryHistory::record(const TelemetryPacket& packet)
+{
+    const qint64 receivedMs = packet.receiveTimestampNs() > 0
+                              ? packet.receiveTimestampNs() / 1000000
+                              : QDateTime::currentMSecsSinceEpoch();
+    
+    qint64 timestamp = packet.timestamp();
+    if (timestamp <= 0 || timestamp > receivedMs + MaxFutureSkewMs) {
+        timestamp = receivedMs;
+    }
+    
+    for (quint64 present = packet.presentSlots(); present; present &= present - 1) {
+        const int slot = qCountTrailingZeroBits(present);
+        append(slot, timestamp, packet.parameterValue(slot));
+    }
+}
+
+void TelemetryHistory::record(int slot, qint64 timestamp, double value)
+{
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    if (timestamp > now + MaxFutureSkewMs) {
+        timestamp = now;
+    }
+    append(slot, timestamp, value);
+}
+
+void TelemetryHistory::append(int slot, qint64 timestamp, double value)
+{
+    if (slot < 0 || slot >= TelemetrySchema::MaxSlots) {
+        return;
+    }
+    
+    std::unique_ptr<TimeSeriesBuffer>& series = m_series[slot];
+    if (!series) {
+        series.reset(new TimeSeriesBuffer(m_depth, m_bucketCount));
+        m_recordedSlots |= quint64(1) << slot;
+    }
+    series->append(timestamp, value);
+}
+
+void TelemetryHistory::clear()
+{
+    for (std::unique_ptr<TimeSeriesBuffer>& series : m_series) {
+        series.reset();
+    }
+    m_recordedSlots = 0;
+}
+
+void TelemetryHistory::setDepth(int samples)
+{
+    samples = qBound(MinDepth, samples, MaxDepth);
+    if (samples != m_depth) {
+        m_depth = samples;
+        clear();
+    }
+}
+
+void TelemetryHistory::setBucketCount(int buckets)
+{
+    buckets = qBound(MinBucketCount, buckets, MaxBucketCount);
+    if (buckets != m_bucketCount) {
+        m_bucketCount = buckets;
+        clear();
+    }
+}
+
+const TimeSeriesBuffer* TelemetryHistory::series(int slot) const
+{
+    if (slot < 0 || slot >= TelemetrySchema::MaxSlots) {
+        return nullptr;
+    }
+    return m_series[slot].get();
+}
+
+QVector<HistoryBucket> TelemetryHistory::buckets(int slot, qint64 from, qint64 to, int maxBuckets) const
+{
+    const TimeSeriesBuffer* buffer = series(slot);
+    if (!buffer) {
+        return QVector<HistoryBucket>();
+    }
+    return buffer->buckets(buffer->levelFor(from, to, maxBuckets), from, to);
+}
+
+size_t TelemetryHistory::memoryUsage() const
+{
+    size_t bytes = sizeof(*this);
+    for (const std::unique_ptr<TimeSeriesBuffer>& series : m_series) {
+        if (series) {
+            bytes += series->memoryUsage();
+        }
+    }
+    return bytes;
+}
+
+size_t TelemetryHistory::memoryLimit() const
+{
+    const size_t perSeries = sizeof(TimeSeriesBuffer)
+                             + size_t(m_depth) * (sizeof(qint64) + sizeof(double))
+                             + size_t(TimeSeriesBuffer::LevelCount) * m_bucketCount * sizeof(HistoryBucket);
+    return sizeof(*this) + size_t(TelemetrySchema::slotCount()) * perSeries;
+}
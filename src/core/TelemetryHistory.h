@@ -0,0 +1,168 @@
+/**
+ * @file TelemetryHistory.h
+ * @brief Bounded per-node history of numeric telemetry parameters
+ */
+
+#ifndef TELEMETRYHISTORY_H
+#define TELEMETRYHISTORY_H
+
+#include <QVector>
+#include <memory>
+#include "TelemetrySchema.h"
+
+class TelemetryPacket;
+
+/**
+ * @struct HistorySample
+ * @brief One raw sample of a parameter
+ */
+struct HistorySample {
+    qint64 timestamp = 0;       ///< Sender time, ms since epoch
+    double value = 0.0;
+};
+
+/**
+ * @struct HistoryBucket
+ * @brief Min/max/mean of the samples that fell into one time interval
+ */
+struct HistoryBucket {
+    qint64 start = 0;           ///< Interval start, ms since epoch
+    qint64 width = 0;           ///< Interval length in ms
+    double minimum = 0.0;
+    double maximum = 0.0;
+    double sum = 0.0;
+    quint32 count = 0;
+    
+    double mean() const { return count ? sum / count : 0.0; }
+};
+
+/**
+ * @class TimeSeriesBuffer
+ * @brief Ring of raw samples plus decimated bucket rings for one parameter
+ * 
+ * Raw samples are stored column-wise (timestamps and values in separate
+ * arrays) in a ring of fixed depth. Alongside it every level of
+ * LevelWidthsMs keeps a ring of fixed-width buckets that is updated as
+ * each sample arrives, so reading an hour of history costs a few hundred
+ * buckets no matter how many samples went in. All storage is allocated
+ * up front; append() never allocates.
+ * 
+ * Samples are expected in roughly ascending time order. A late sample
+ * still lands in its bucket if that bucket is in the ring; one older than
+ * a level's oldest bucket is left out of that level.
+ */
+class TimeSeriesBuffer
+{
+public:
+    static constexpr int LevelCount = 4;
+    static constexpr qint64 LevelWidthsMs[LevelCount] = { 1000, 10000, 60000, 600000 };
+    
+    TimeSeriesBuffer(int depth, int bucketCount);
+    
+    void append(qint64 timestamp, double value);
+    void clear();
+    
+    int depth() const { return m_timestamps.size(); }
+    int size() const { return m_size; }
+    bool isEmpty() const { return m_size == 0; }
+    HistorySample latest() const;
+    
+    // Raw samples with timestamp in [from, to], oldest first
+    QVector<HistorySample> samples(qint64 from, qint64 to) const;
+    
+    // Buckets of one level overlapping [from, to], oldest first
+    QVector<HistoryBucket> buckets(int level, qint64 from, qint64 to) const;
+    
+    // Finest level that covers [from, to] in at most maxBuckets buckets
+    int levelFor(qint64 from, qint64 to, int maxBuckets) const;
+    
+    size_t memoryUsage() const;
+    
+private:
+    struct Level {
+        qint64 width;
+        QVector<HistoryBucket> buckets;
+        int head;                   ///< Index of the newest bucket
+        int size;
+    };
+    
+    void addToLevel(Level& level, qint64 timestamp, double value);
+    
+    // Raw ring, column-wise
+    QVector<qint64> m_timestamps;
+    QVector<double> m_values;
+    int m_head;                     ///< Index of the newest sample
+    int m_size;
+    
+    Level m_levels[LevelCount];
+};
+
+/**
+ * @class TelemetryHistory
+ * @brief Time series of every numeric schema parameter a node has reported
+ * 
+ * One TimeSeriesBuffer per TelemetrySchema slot, created the first time
+ * a packet carries that slot. Parameters outside the schema are not
+ * recorded. The memory bound is therefore TelemetrySchema::slotCount()
+ * buffers of the configured depth; memoryUsage() reports what is actually
+ * allocated.
+ * 
+ * Buckets only advance with time, so one sample dated far ahead would
+ * hold every later sample in its bucket until the clock caught up. Samples
+ * more than MaxFutureSkewMs ahead of their arrival are therefore recorded
+ * at the arrival time.
+ * 
+ * Not thread-safe; used from the thread that owns the node.
+ */
+class TelemetryHistory
+{
+public:
+    static constexpr int DefaultDepth = 1024;
+    static constexpr int DefaultBucketCount = 240;
+    static constexpr int MinDepth = 16;
+    static constexpr int MaxDepth = 1 << 20;
+    static constexpr int MinBucketCount = 16;
+    static constexpr int MaxBucketCount = 1 << 16;
+    
+    // How far a sample may be dated ahead of its arrival before it is
+    // recorded at its arrival time instead
+    static constexpr qint64 MaxFutureSkewMs = 2000;
+    
+    TelemetryHistory();
+    ~TelemetryHistory();
+    
+    // Record every present slot of the packet at its timestamp, or at its
+    // receive time if the timestamp is missing or too far in the future
+    void record(const TelemetryPacket& packet);
+    void record(int slot, qint64 timestamp, double value);
+    void clear();
+    
+    // Raw samples and bucket count per level; changing either clears the history
+    void setDepth(int samples);
+    int depth() const { return m_depth; }
+    void setBucketCount(int buckets);
+    int bucketCount() const { return m_bucketCount; }
+    
+    // Series for a slot, nullptr if the node never reported it
+    const TimeSeriesBuffer* series(int slot) const;
+    quint64 recordedSlots() const { return m_recordedSlots; }
+    
+    // Chart helper: buckets at the finest level that fits maxBuckets
+    QVector<HistoryBucket> buckets(int slot, qint64 from, qint64 to, int maxBuckets) const;
+    
+    size_t memoryUsage() const;
+    size_t memoryLimit() const;
+    
+    TelemetryHistory(const TelemetryHistory&) = delete;
+    TelemetryHistory& operator=(const TelemetryHistory&) = delete;
+    
+private:
+    void append(int slot, qint64 timestamp, double value);
+    
+    int m_depth;
+    int m_bucketCount;
+    quint64 m_recordedSlots;
+    std::unique_ptr<TimeSeriesBuffer> m_series[TelemetrySchema::MaxSlots];
+};
+
+#endif // TELEMETRYHISTORY_H
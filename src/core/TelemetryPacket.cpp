@@ -4,50 +4,207 @@
  */
 
 #include "TelemetryPacket.h"
+#include "IdInterner.h"
 #include <QDateTime>
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonArray>
 #include <QDataStream>
+#include <QtAlgorithms>
+
+TelemetryPacketData::TelemetryPacketData()
+    : subsystemHandle(IdInterner::InvalidHandle)
+    , healthCode(HealthCode::UNKNOWN)
+    , timestamp(0)
+    , receiveTimestampNs(0)
+    , presentSlots(0)
+    , slotValues()
+    , slotKinds()
+{
+    // No timestamp: a packet that never carried one must not look fresh
+}
+
+bool TelemetryPacketData::storeInSlot(int slot, const QVariant& value)
+{
+    SlotValue& stored = slotValues[slot];
+    SlotKind& kind = slotKinds[slot];
+    
+    switch (value.typeId()) {
+        case QMetaType::Double:
+            stored.real = value.toDouble();
+            kind = SlotKind::Double;
+            break;
+        case QMetaType::Int:
+            stored.integer = value.toInt();
+            kind = SlotKind::Int;
+            break;
+        case QMetaType::LongLong:
+            stored.integer = value.toLongLong();
+            kind = SlotKind::LongLong;
+            break;
+        case QMetaType::Bool:
+            stored.integer = value.toBool() ? 1 : 0;
+            kind = SlotKind::Bool;
+            break;
+        default:
+            return false;
+    }
+    
+    presentSlots |= quint64(1) << slot;
+    return true;
+}
+
+QVariant TelemetryPacketData::slotVariant(int slot) const
+{
+    const SlotValue& value = slotValues[slot];
+    switch (slotKinds[slot]) {
+        case SlotKind::Double:
+            return value.real;
+        case SlotKind::Int:
+            return static_cast<int>(value.integer);
+        case SlotKind::LongLong:
+            return static_cast<qlonglong>(value.integer);
+        case SlotKind::Bool:
+            return value.integer != 0;
+    }
+    return QVariant();
+}
+
+namespace {
+
+// Shared by every default-constructed packet until its first write
+const QSharedDataPointer<TelemetryPacketData>& sharedEmptyData()
+{
+    static const QSharedDataPointer<TelemetryPacketData> empty(new TelemetryPacketData());
+    return empty;
+}
+
+} // namespace
 
 TelemetryPacket::TelemetryPacket()
-    : m_healthCode(HealthCode::UNKNOWN)
-    , m_timestamp(0)
+    : m_data(sharedEmptyData())
 {
-    updateTimestamp();
 }
 
 TelemetryPacket::TelemetryPacket(const QString& subsystemId, HealthCode healthCode)
-    : m_subsystemId(subsystemId)
-    , m_healthCode(healthCode)
-    , m_timestamp(0)
+    : m_data(new TelemetryPacketData())
 {
+    m_data->subsystemId = subsystemId;
+    m_data->subsystemHandle = IdInterner::instance().find(subsystemId);
+    m_data->healthCode = healthCode;
     updateTimestamp();
 }
 
+void TelemetryPacket::setSubsystemId(const QString& id)
+{
+    m_data->subsystemId = id;
+    
+    // Only look the ID up: IDs from the network must not use up handles
+    m_data->subsystemHandle = IdInterner::instance().find(id);
+}
+
 void TelemetryPacket::updateTimestamp()
 {
-    m_timestamp = QDateTime::currentMSecsSinceEpoch();
+    m_data->timestamp = QDateTime::currentMSecsSinceEpoch();
 }
 
 void TelemetryPacket::addParameter(const QString& key, const QVariant& value)
 {
-    m_parameters[key] = value;
+    const int slot = TelemetrySchema::slotOf(key);
+    if (slot != TelemetrySchema::InvalidSlot) {
+        addParameter(slot, value);
+        return;
+    }
+    m_data->parameters[key] = value;
 }
 
 QVariant TelemetryPacket::parameter(const QString& key) const
 {
-    return m_parameters.value(key, QVariant());
+    const int slot = TelemetrySchema::slotOf(key);
+    if (slot != TelemetrySchema::InvalidSlot) {
+        return parameter(slot);
+    }
+    return m_data->parameters.value(key, QVariant());
 }
 
 bool TelemetryPacket::hasParameter(const QString& key) const
 {
-    return m_parameters.contains(key);
+    const int slot = TelemetrySchema::slotOf(key);
+    if (slot != TelemetrySchema::InvalidSlot) {
+        return hasParameter(slot);
+    }
+    return m_data->parameters.contains(key);
+}
+
+QMap<QString, QVariant> TelemetryPacket::allParameters() const
+{
+    QMap<QString, QVariant> result = m_data->parameters;
+    for (quint64 present = m_data->presentSlots; present; present &= present - 1) {
+        const int slot = qCountTrailingZeroBits(present);
+        result.insert(TelemetrySchema::nameOf(slot), m_data->slotVariant(slot));
+    }
+    return result;
 }
 
 void TelemetryPacket::clearParameters()
 {
-    m_parameters.clear();
+    m_data->presentSlots = 0;
+    m_data->parameters.clear();
+}
+
+void TelemetryPacket::addParameter(int slot, const QVariant& value)
+{
+    if (slot < 0 || slot >= TelemetrySchema::MaxSlots) {
+        return;
+    }
+    
+    // Detach once; a key lives in exactly one place, so drop any copy on
+    // the other side
+    TelemetryPacketData& data = *m_data;
+    if (data.storeInSlot(slot, value)) {
+        if (!data.parameters.isEmpty()) {
+            data.parameters.remove(TelemetrySchema::nameOf(slot));
+        }
+    } else {
+        data.presentSlots &= ~(quint64(1) << slot);
+        data.parameters.insert(TelemetrySchema::nameOf(slot), value);
+    }
+}
+
+QVariant TelemetryPacket::parameter(int slot) const
+{
+    if (slot < 0 || slot >= TelemetrySchema::MaxSlots) {
+        return QVariant();
+    }
+    if (m_data->presentSlots & (quint64(1) << slot)) {
+        return m_data->slotVariant(slot);
+    }
+    if (m_data->parameters.isEmpty()) {
+        return QVariant();
+    }
+    return m_data->parameters.value(TelemetrySchema::nameOf(slot), QVariant());
+}
+
+bool TelemetryPacket::hasParameter(int slot) const
+{
+    if (slot < 0 || slot >= TelemetrySchema::MaxSlots) {
+        return false;
+    }
+    if (m_data->presentSlots & (quint64(1) << slot)) {
+        return true;
+    }
+    return !m_data->parameters.isEmpty() && m_data->parameters.contains(TelemetrySchema::nameOf(slot));
+}
+
+double TelemetryPacket::parameterValue(int slot) const
+{
+    const TelemetryPacketData& data = *m_data;
+    if (slot >= 0 && slot < TelemetrySchema::MaxSlots && (data.presentSlots & (quint64(1) << slot))) {
+        const TelemetryPacketData::SlotValue& value = data.slotValues[slot];
+        return data.slotKinds[slot] == TelemetryPacketData::SlotKind::Double
+               ? value.real : static_cast<double>(value.integer);
+    }
+    return parameter(slot).toDouble();
 }
 
 QByteArray TelemetryPacket::serialize() const
@@ -56,11 +213,11 @@ QByteArray TelemetryPacket::serialize() const
     QDataStream stream(&data, QIODevice::WriteOnly);
     stream.setVersion(QDataStream::Qt_5_12);
     
-    stream << m_subsystemId;
-    stream << static_cast<int>(m_healthCode);
-    stream << m_healthMessage;
-    stream << m_timestamp;
-    stream << m_parameters;
+    stream << m_data->subsystemId;
+    stream << static_cast<int>(m_data->healthCode);
+    stream << m_data->healthMessage;
+    stream << m_data->timestamp;
+    stream << allParameters();
     
     return data;
 }
@@ -72,13 +229,20 @@ TelemetryPacket TelemetryPacket::deserialize(const QByteArray& data)
     stream.setVersion(QDataStream::Qt_5_12);
     
     int healthCodeInt;
-    stream >> packet.m_subsystemId;
+    QString subsystemId;
+    stream >> subsystemId;
+    packet.setSubsystemId(subsystemId);
     stream >> healthCodeInt;
-    stream >> packet.m_healthMessage;
-    stream >> packet.m_timestamp;
-    stream >> packet.m_parameters;
+    stream >> packet.m_data->healthMessage;
+    stream >> packet.m_data->timestamp;
+    
+    QMap<QString, QVariant> parameters;
+    stream >> parameters;
+    for (auto it = parameters.constBegin(); it != parameters.constEnd(); ++it) {
+        packet.addParameter(it.key(), it.value());
+    }
     
-    packet.m_healthCode = static_cast<HealthCode>(healthCodeInt);
+    packet.m_data->healthCode = static_cast<HealthCode>(healthCodeInt);
     
     return packet;
 }
@@ -86,13 +250,14 @@ TelemetryPacket TelemetryPacket::deserialize(const QByteArray& data)
 QString TelemetryPacket::toJson() const
 {
     QJsonObject json;
-    json["subsystem_id"] = m_subsystemId;
-    json["health_code"] = static_cast<int>(m_healthCode);
-    json["health_message"] = m_healthMessage;
-    json["timestamp"] = m_timestamp;
+    json["subsystem_id"] = m_data->subsystemId;
+    json["health_code"] = static_cast<int>(m_data->healthCode);
+    json["health_message"] = m_data->healthMessage;
+    json["timestamp"] = m_data->timestamp;
     
+    const QMap<QString, QVariant> parameters = allParameters();
     QJsonObject params;
-    for (auto it = m_parameters.begin(); it != m_parameters.end(); ++it) {
+    for (auto it = parameters.begin(); it != parameters.end(); ++it) {
         params[it.key()] = QJsonValue::fromVariant(it.value());
     }
     json["parameters"] = params;
@@ -102,23 +267,28 @@ QString TelemetryPacket::toJson() const
 }
 
 TelemetryPacket TelemetryPacket::fromJson(const QString& json)
+{
+    return fromJsonUtf8(json.toUtf8());
+}
+
+TelemetryPacket TelemetryPacket::fromJsonUtf8(const QByteArray& json)
 {
     TelemetryPacket packet;
     
-    QJsonDocument doc = QJsonDocument::fromJson(json.toUtf8());
+    QJsonDocument doc = QJsonDocument::fromJson(json);
     if (doc.isNull() || !doc.isObject()) {
         return packet;
     }
     
     QJsonObject root = doc.object();
-    packet.m_subsystemId = root["subsystem_id"].toString();
-    packet.m_healthCode = static_cast<HealthCode>(root["health_code"].toInt());
-    packet.m_healthMessage = root["health_message"].toString();
-    packet.m_timestamp = static_cast<qint64>(root["timestamp"].toDouble());
+    packet.setSubsystemId(root["subsystem_id"].toString());
+    packet.m_data->healthCode = static_cast<HealthCode>(root["health_code"].toInt());
+    packet.m_data->healthMessage = root["health_message"].toString();
+    packet.m_data->timestamp = static_cast<qint64>(root["timestamp"].toDouble());
     
     QJsonObject params = root["parameters"].toObject();
     for (auto it = params.begin(); it != params.end(); ++it) {
-        packet.m_parameters[it.key()] = it.value().toVariant();
+        packet.addParameter(it.key(), it.value().toVariant());
     }
     
     return packet;
@@ -126,5 +296,5 @@ TelemetryPacket TelemetryPacket::fromJson(const QString& json)
 
 bool TelemetryPacket::isValid() const
 {
-    return !m_subsystemId.isEmpty() && m_timestamp > 0;
+    return !m_data->subsystemId.isEmpty() && m_data->timestamp > 0;
 }
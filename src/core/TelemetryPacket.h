@@ -10,7 +10,43 @@
 #include <QMap>
 #include <QVariant>
 #include <QByteArray>
+#include <QSharedData>
+#include <QSharedDataPointer>
 #include "HealthStatus.h"
+#include "TelemetrySchema.h"
+
+/**
+ * @class TelemetryPacketData
+ * @brief Shared state behind TelemetryPacket
+ */
+class TelemetryPacketData : public QSharedData
+{
+public:
+    enum class SlotKind : quint8 { Double, Int, LongLong, Bool };
+    
+    union SlotValue {
+        double real;
+        qint64 integer;
+    };
+    
+    TelemetryPacketData();
+    
+    bool storeInSlot(int slot, const QVariant& value);
+    QVariant slotVariant(int slot) const;
+    
+    QString subsystemId;
+    quint32 subsystemHandle;
+    HealthCode healthCode;
+    QString healthMessage;
+    qint64 timestamp;
+    qint64 receiveTimestampNs;
+    
+    // Parameters: schema slots plus overflow for everything else
+    quint64 presentSlots;
+    SlotValue slotValues[TelemetrySchema::MaxSlots];
+    SlotKind slotKinds[TelemetrySchema::MaxSlots];
+    QMap<QString, QVariant> parameters;     ///< Overflow: unknown names and text values
+};
 
 /**
  * @class TelemetryPacket
@@ -18,6 +54,17 @@
  * 
  * Thread-safe telemetry packet representation for defense-grade
  * real-time radar health monitoring.
+ * 
+ * Parameters named in TelemetrySchema with a numeric or boolean value are
+ * kept in a flat array of typed slots plus a presence bitmask, so the
+ * typed getters and the slot overloads never build a key or walk a map.
+ * Everything else (unknown names, text values) goes to an overflow map.
+ * The string API works on both and behaves as a single map.
+ * 
+ * Packets are implicitly shared: copying one, passing it through a signal
+ * or across threads only bumps an atomic reference count, and the data is
+ * copied the first time a shared copy is modified. Default-constructed
+ * packets share one empty instance and allocate on first write.
  */
 class TelemetryPacket
 {
@@ -25,45 +72,59 @@ public:
     TelemetryPacket();
     TelemetryPacket(const QString& subsystemId, HealthCode healthCode);
     
-    // Core identification
-    QString subsystemId() const { return m_subsystemId; }
-    void setSubsystemId(const QString& id) { m_subsystemId = id; }
+    // Core identification; the handle is that of the node with this ID, or
+    // IdInterner::InvalidHandle if there is none (see IdInterner::find())
+    QString subsystemId() const { return m_data->subsystemId; }
+    void setSubsystemId(const QString& id);
+    quint32 subsystemHandle() const { return m_data->subsystemHandle; }
     
     // Health information
-    HealthCode healthCode() const { return m_healthCode; }
-    void setHealthCode(HealthCode code) { m_healthCode = code; }
+    HealthCode healthCode() const { return m_data->healthCode; }
+    void setHealthCode(HealthCode code) { m_data->healthCode = code; }
     
-    QString healthMessage() const { return m_healthMessage; }
-    void setHealthMessage(const QString& msg) { m_healthMessage = msg; }
+    QString healthMessage() const { return m_data->healthMessage; }
+    void setHealthMessage(const QString& msg) { m_data->healthMessage = msg; }
     
     // Timestamp
-    qint64 timestamp() const { return m_timestamp; }
-    void setTimestamp(qint64 ts) { m_timestamp = ts; }
+    qint64 timestamp() const { return m_data->timestamp; }
+    void setTimestamp(qint64 ts) { m_data->timestamp = ts; }
     void updateTimestamp();
     
+    // Kernel receive time (ns since epoch, 0 if unknown); receive-side only,
+    // never serialized
+    qint64 receiveTimestampNs() const { return m_data->receiveTimestampNs; }
+    void setReceiveTimestampNs(qint64 ns) { m_data->receiveTimestampNs = ns; }
+    
     // Telemetry parameters (key-value pairs)
     void addParameter(const QString& key, const QVariant& value);
     QVariant parameter(const QString& key) const;
-    QMap<QString, QVariant> allParameters() const { return m_parameters; }
+    QMap<QString, QVariant> allParameters() const;
     bool hasParameter(const QString& key) const;
     void clearParameters();
     
+    // Same by schema slot (TelemetrySchema::slotOf); no key lookup
+    void addParameter(int slot, const QVariant& value);
+    QVariant parameter(int slot) const;
+    bool hasParameter(int slot) const;
+    double parameterValue(int slot) const;  ///< Numeric value, 0.0 if absent
+    quint64 presentSlots() const { return m_data->presentSlots; }
+    
     // Common telemetry fields
-    void setTemperature(double temp) { addParameter("temperature", temp); }
-    void setVoltage(double voltage) { addParameter("voltage", voltage); }
-    void setCurrent(double current) { addParameter("current", current); }
-    void setPower(double power) { addParameter("power", power); }
-    void setFrequency(double freq) { addParameter("frequency", freq); }
-    void setLatency(int latency) { addParameter("latency", latency); }
-    void setErrorCount(int errors) { addParameter("error_count", errors); }
-    
-    double temperature() const { return parameter("temperature").toDouble(); }
-    double voltage() const { return parameter("voltage").toDouble(); }
-    double current() const { return parameter("current").toDouble(); }
-    double power() const { return parameter("power").toDouble(); }
-    double frequency() const { return parameter("frequency").toDouble(); }
-    int latency() const { return parameter("latency").toInt(); }
-    int errorCount() const { return parameter("error_count").toInt(); }
+    void setTemperature(double temp) { addParameter(TelemetrySchema::Temperature, temp); }
+    void setVoltage(double voltage) { addParameter(TelemetrySchema::Voltage, voltage); }
+    void setCurrent(double current) { addParameter(TelemetrySchema::Current, current); }
+    void setPower(double power) { addParameter(TelemetrySchema::Power, power); }
+    void setFrequency(double freq) { addParameter(TelemetrySchema::Frequency, freq); }
+    void setLatency(int latency) { addParameter(TelemetrySchema::Latency, latency); }
+    void setErrorCount(int errors) { addParameter(TelemetrySchema::ErrorCount, errors); }
+    
+    double temperature() const { return parameterValue(TelemetrySchema::Temperature); }
+    double voltage() const { return parameterValue(TelemetrySchema::Voltage); }
+    double current() const { return parameterValue(TelemetrySchema::Current); }
+    double power() const { return parameterValue(TelemetrySchema::Power); }
+    double frequency() const { return parameterValue(TelemetrySchema::Frequency); }
+    int latency() const { return parameter(TelemetrySchema::Latency).toInt(); }
+    int errorCount() const { return parameter(TelemetrySchema::ErrorCount).toInt(); }
     
     // Serialization for UDP transmission
     QByteArray serialize() const;
@@ -72,16 +133,16 @@ public:
     // JSON serialization
     QString toJson() const;
     static TelemetryPacket fromJson(const QString& json);
+    static TelemetryPacket fromJsonUtf8(const QByteArray& json);
     
     // Validation
     bool isValid() const;
     
+    // True if both packets share the same data (no copy was made)
+    bool isSharedWith(const TelemetryPacket& other) const { return m_data == other.m_data; }
+    
 private:
-    QString m_subsystemId;
-    HealthCode m_healthCode;
-    QString m_healthMessage;
-    qint64 m_timestamp;
-    QMap<QString, QVariant> m_parameters;
+    QSharedDataPointer<TelemetryPacketData> m_data;
 };
 
 #endif // TELEMETRYPACKET_H
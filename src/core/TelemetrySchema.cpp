@@ -0,0 +1,111 @@
+/**
+ * @file TelemetrySchema.cpp
+ * @brief Slot layout built from the parameter dictionary
+ */
+
+#include "TelemetrySchema.h"
+#include "ParameterDictionary.h"
+#include <QHash>
+#include <QDebug>
+
+namespace {
+
+// Must follow the CommonSlot enum
+const char* const CommonSlotNames[] = {
+    "temperature", "voltage", "current", "power", "frequency", "latency", "error_count"
+};
+
+static_assert(sizeof(CommonSlotNames) / sizeof(CommonSlotNames[0]) == TelemetrySchema::CommonSlotCount,
+              "CommonSlotNames out of sync with TelemetrySchema::CommonSlot");
+
+// Highest subsystem type ID in ParameterDictionary plus one
+constexpr int TypeCount = ParameterDictionary::EmbeddedController + 1;
+
+struct Layout {
+    QHash<QString, int> slotByName;
+    QHash<quint32, int> slotByWireId;   ///< (typeId << 16) | parameterId
+    QString names[TelemetrySchema::MaxSlots];
+    quint64 commonSlots = 0;
+    quint64 typeSlots[TypeCount] = {};
+    int count = 0;
+    
+    int addSlot(const QString& name)
+    {
+        auto it = slotByName.constFind(name);
+        if (it != slotByName.constEnd()) {
+            return it.value();
+        }
+        if (count == TelemetrySchema::MaxSlots) {
+            qWarning() << "Telemetry schema full, parameter kept by name only:" << name;
+            return TelemetrySchema::InvalidSlot;
+        }
+        names[count] = name;
+        slotByName.insert(name, count);
+        return count++;
+    }
+};
+
+const Layout& layout()
+{
+    static const Layout instance = [] {
+        Layout built;
+        for (const char* name : CommonSlotNames) {
+            built.addSlot(QString::fromLatin1(name));
+        }
+        
+        for (const ParameterDictionary::ParameterInfo& info : ParameterDictionary::parameters()) {
+            const int slot = built.addSlot(info.name);
+            if (slot == TelemetrySchema::InvalidSlot) {
+                continue;
+            }
+            
+            const quint64 bit = quint64(1) << slot;
+            if (info.typeId == ParameterDictionary::Generic) {
+                built.commonSlots |= bit;
+            } else if (info.typeId < TypeCount) {
+                built.typeSlots[info.typeId] |= bit;
+            }
+            built.slotByWireId.insert((quint32(info.typeId) << 16) | info.parameterId, slot);
+        }
+        
+        for (int i = 0; i < TelemetrySchema::CommonSlotCount; ++i) {
+            built.commonSlots |= quint64(1) << i;
+        }
+        return built;
+    }();
+    return instance;
+}
+
+} // namespace
+
+int TelemetrySchema::slotOf(const QString& name)
+{
+    return layout().slotByName.value(name, InvalidSlot);
+}
+
+int TelemetrySchema::slotOf(quint16 typeId, quint16 parameterId)
+{
+    // Common IDs are shared by every type
+    const quint16 owner = parameterId < ParameterDictionary::TypeSpecificBase
+                          ? quint16(ParameterDictionary::Generic) : typeId;
+    return layout().slotByWireId.value((quint32(owner) << 16) | parameterId, InvalidSlot);
+}
+
+QString TelemetrySchema::nameOf(int slot)
+{
+    if (slot < 0 || slot >= MaxSlots) {
+        return QString();
+    }
+    return layout().names[slot];
+}
+
+quint64 TelemetrySchema::typeSlots(quint16 typeId)
+{
+    const Layout& schema = layout();
+    return schema.commonSlots | (typeId < TypeCount ? schema.typeSlots[typeId] : 0);
+}
+
+int TelemetrySchema::slotCount()
+{
+    return layout().count;
+}
@@ -0,0 +1,60 @@
+/**
+ * @file TelemetrySchema.h
+ * @brief Fixed slot layout for known telemetry parameters
+ */
+
+#ifndef TELEMETRYSCHEMA_H
+#define TELEMETRYSCHEMA_H
+
+#include <QString>
+
+/**
+ * @class TelemetrySchema
+ * @brief Assigns every known parameter name a slot in TelemetryPacket
+ * 
+ * Built once from ParameterDictionary: the common parameters come first,
+ * in the order of the CommonSlot enum, followed by each subsystem type's
+ * own parameters. Parameter names are unique across types, so a single
+ * layout serves every packet even before its subsystem type is known;
+ * typeSlots() gives the part of the layout a given type uses.
+ * 
+ * Immutable after construction and safe to use from any thread. Slot
+ * indices are process-local and never leave the process.
+ */
+class TelemetrySchema
+{
+public:
+    static constexpr int MaxSlots = 64;
+    static constexpr int InvalidSlot = -1;
+    
+    // Slots with a typed accessor on TelemetryPacket
+    enum CommonSlot {
+        Temperature = 0,
+        Voltage,
+        Current,
+        Power,
+        Frequency,
+        Latency,
+        ErrorCount,
+        CommonSlotCount
+    };
+    
+    // Slot for a parameter name, InvalidSlot if the name is not in the schema
+    static int slotOf(const QString& name);
+    
+    // Slot for a DefenseProtocol v2 parameter ID of the given subsystem type
+    static int slotOf(quint16 typeId, quint16 parameterId);
+    
+    // Parameter name stored in a slot, "" for an unused slot
+    static QString nameOf(int slot);
+    
+    // Bit n set if slot n is meaningful for the subsystem type
+    static quint64 typeSlots(quint16 typeId);
+    
+    static int slotCount();
+    
+private:
+    TelemetrySchema() = default;
+};
+
+#endif // TELEMETRYSCHEMA_H
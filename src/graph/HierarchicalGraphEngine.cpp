@@ -178,3 +178,16 @@ QString HierarchicalGraphEngine::breadcrumbString() const
     
     return names.join(" > ");
 }
+
+HealthSummary HierarchicalGraphEngine::sceneSummary(const NodeGraphScene* scene)
+{
+    HealthSummary summary;
+    if (!scene) {
+        return summary;
+    }
+    
+    for (SubsystemNode* node : scene->allNodes()) {
+        summary.add(node->healthSummary());
+    }
+    return summary;
+}
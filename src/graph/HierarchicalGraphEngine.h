@@ -9,6 +9,7 @@
 #include <QObject>
 #include <QStack>
 #include <memory>
+#include "../core/HealthSummary.h"
 
 class NodeGraphScene;
 class SubsystemNode;
@@ -35,6 +36,10 @@ struct GraphLevel {
  * 
  * Supports drilling down into subsystem nodes and navigating
  * the hierarchy with breadcrumb navigation.
+ * 
+ * Aggregated health is kept on the nodes themselves (see
+ * SubsystemNode::healthSummary()); a scene's summary is the sum over its
+ * own nodes, each of which already covers everything below it.
  */
 class HierarchicalGraphEngine : public QObject
 {
@@ -64,6 +69,10 @@ public:
     QList<SubsystemNode*> breadcrumbPath() const;
     QString breadcrumbString() const;
     
+    // Health of every node in the scene and below it
+    static HealthSummary sceneSummary(const NodeGraphScene* scene);
+    HealthSummary currentSummary() const { return sceneSummary(currentScene()); }
+    
 signals:
     void sceneChanged(NodeGraphScene* scene);
     void depthChanged(int depth);
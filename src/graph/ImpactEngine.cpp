@@ -0,0 +1,500 @@
+/**
+ * @file ImpactEngine.cpp
+ * @brief Implementation of ImpactEngine
+ */
+
+#include "ImpactEngine.h"
+#include "NodeDataModel.h"
+#include "../core/IdInterner.h"
+#include <QTimer>
+#include <QDebug>
+
+ImpactEngine::ImpactEngine(QObject* parent)
+    : QObject(parent)
+    , m_propagateMask((1u << int(PortType::PowerOutput)) | (1u << int(PortType::SignalOutput))
+                      | (1u << int(PortType::DataOutput)) | (1u << int(PortType::ControlOutput)))
+    , m_pass(0)
+    , m_recomputations(0)
+    , m_nodesVisited(0)
+    , m_recomputeTimer(new QTimer(this))
+{
+    // Zero interval: one pass for all changes made by the current event
+    m_recomputeTimer->setSingleShot(true);
+    m_recomputeTimer->setInterval(0);
+    connect(m_recomputeTimer, &QTimer::timeout, this, &ImpactEngine::recompute);
+}
+
+ImpactEngine::~ImpactEngine()
+{
+}
+
+void ImpactEngine::setModel(NodeDataModel* model)
+{
+    if (m_model == model) {
+        return;
+    }
+    
+    if (m_model) {
+        disconnect(m_model, nullptr, this, nullptr);
+    }
+    reset();
+    
+    m_model = model;
+    if (!m_model) {
+        return;
+    }
+    
+    connect(model, &NodeDataModel::nodeAdded, this, &ImpactEngine::onNodeAdded);
+    connect(model, &NodeDataModel::nodeRemoved, this, &ImpactEngine::onNodeRemoved);
+    connect(model, &NodeDataModel::connectionAdded, this, &ImpactEngine::onConnectionAdded);
+    connect(model, &NodeDataModel::connectionRemoved, this, &ImpactEngine::onConnectionRemoved);
+    connect(model, &NodeDataModel::modelCleared, this, &ImpactEngine::onModelCleared);
+    rebuild();
+}
+
+void ImpactEngine::setPropagates(PortType outputType, bool enabled)
+{
+    const quint32 bit = 1u << int(outputType);
+    const quint32 mask = enabled ? (m_propagateMask | bit) : (m_propagateMask & ~bit);
+    if (mask == m_propagateMask) {
+        return;
+    }
+    
+    // Any connection may have changed, so everything is recomputed
+    m_propagateMask = mask;
+    for (int handle = 0; handle < m_entries.size(); ++handle) {
+        markDirty(handle);
+    }
+}
+
+bool ImpactEngine::propagates(PortType outputType) const
+{
+    return (m_propagateMask & (1u << int(outputType))) != 0;
+}
+
+bool ImpactEngine::isFailed(HealthCode code)
+{
+    return code == HealthCode::ERROR || code == HealthCode::OFFLINE;
+}
+
+void ImpactEngine::onNodeAdded(const QString& nodeId)
+{
+    if (m_model) {
+        track(m_model->getNode(nodeId));
+    }
+}
+
+void ImpactEngine::onNodeRemoved(const QString& nodeId)
+{
+    // The model has already removed the node's connections
+    const quint32 handle = IdInterner::instance().find(nodeId);
+    if (handle < quint32(m_entries.size()) && m_entries[int(handle)].tracked) {
+        untrack(int(handle));
+    }
+}
+
+void ImpactEngine::onConnectionAdded(const QString& connectionId)
+{
+    if (!m_model) {
+        return;
+    }
+    
+    if (const NodeConnection* connection = m_model->getConnection(connectionId)) {
+        addEdge(*connection);
+    }
+}
+
+void ImpactEngine::onConnectionRemoved(const QString& connectionId)
+{
+    const int index = m_edgeIndex.value(connectionId, -1);
+    if (index >= 0) {
+        removeEdge(index);
+    }
+}
+
+void ImpactEngine::onModelCleared()
+{
+    reset();
+}
+
+void ImpactEngine::rebuild()
+{
+    for (SubsystemNode* node : m_model->allNodes()) {
+        track(node);
+    }
+    for (const NodeConnection& connection : m_model->allConnections()) {
+        addEdge(connection);
+    }
+}
+
+void ImpactEngine::track(SubsystemNode* node)
+{
+    if (!node) {
+        return;
+    }
+    
+    const quint32 handle = node->handle();
+    if (handle == IdInterner::InvalidHandle) {
+        qWarning() << "Cannot track impact of node without a valid ID:" << node->nodeId();
+        return;
+    }
+    
+    if (handle >= quint32(m_entries.size())) {
+        m_entries.resize(int(handle) + 1);
+    }
+    
+    Entry& entry = m_entries[int(handle)];
+    if (entry.tracked) {
+        return;
+    }
+    
+    // Without connections yet, nothing reaches the node but itself
+    entry.node = node;
+    entry.tracked = true;
+    entry.failed = isFailed(node->healthStatus().code());
+    entry.reachedBy[0] = entry.failed ? int(handle) : NoNode;
+    entry.rootCause = entry.reachedBy[0];
+    entry.healthConnection = connect(node, &SubsystemNode::healthStatusChanged, this,
+                                     [this, handle](const HealthStatus& status) {
+                                         onHealthChanged(int(handle), status.code());
+                                     });
+}
+
+void ImpactEngine::untrack(int handle)
+{
+    // Left over only if the node was deleted without being removed first
+    const QVector<int> edges = m_entries[handle].out + m_entries[handle].in;
+    for (int index : edges) {
+        removeEdge(index);
+    }
+    
+    Entry& entry = m_entries[handle];
+    QObject::disconnect(entry.healthConnection);
+    const QPointer<SubsystemNode> node = entry.node;
+    entry = Entry();
+    
+    if (node) {
+        node->setImpact(ImpactState::None);
+    }
+}
+
+void ImpactEngine::addEdge(const NodeConnection& connection)
+{
+    if (m_edgeIndex.contains(connection.connectionId)) {
+        return;
+    }
+    
+    const quint32 source = IdInterner::instance().find(connection.sourceNodeId);
+    const quint32 target = IdInterner::instance().find(connection.targetNodeId);
+    if (source >= quint32(m_entries.size()) || !m_entries[int(source)].tracked
+        || target >= quint32(m_entries.size()) || !m_entries[int(target)].tracked) {
+        qWarning() << "Connection between unknown nodes:" << connection.connectionId;
+        return;
+    }
+    
+    Edge edge;
+    edge.connectionId = connection.connectionId;
+    edge.source = int(source);
+    edge.target = int(target);
+    if (SubsystemNode* node = m_entries[edge.source].node) {
+        if (const NodePort* port = node->getOutputPort(connection.sourcePort)) {
+            edge.type = int(port->type);
+        }
+    }
+    
+    int index;
+    if (!m_freeEdges.isEmpty()) {
+        index = m_freeEdges.takeLast();
+        m_edges[index] = edge;
+    } else {
+        index = m_edges.size();
+        m_edges.append(edge);
+    }
+    
+    m_edgeIndex.insert(edge.connectionId, index);
+    m_entries[edge.source].out.append(index);
+    m_entries[edge.target].in.append(index);
+    if (carries(edge)) {
+        markDirty(edge.target);
+    }
+}
+
+void ImpactEngine::removeEdge(int index)
+{
+    const Edge edge = m_edges[index];
+    if (edge.source == NoNode) {
+        return;
+    }
+    
+    m_entries[edge.source].out.removeOne(index);
+    m_entries[edge.target].in.removeOne(index);
+    m_edgeIndex.remove(edge.connectionId);
+    m_edges[index] = Edge();
+    m_freeEdges.append(index);
+    
+    if (carries(edge)) {
+        markDirty(edge.target);
+    }
+}
+
+void ImpactEngine::reset()
+{
+    m_recomputeTimer->stop();
+    
+    QVector<QPointer<SubsystemNode>> nodes;
+    for (Entry& entry : m_entries) {
+        if (entry.tracked) {
+            QObject::disconnect(entry.healthConnection);
+            nodes.append(entry.node);
+        }
+    }
+    
+    m_entries.clear();
+    m_edges.clear();
+    m_freeEdges.clear();
+    m_edgeIndex.clear();
+    m_dirty.clear();
+    
+    for (const QPointer<SubsystemNode>& node : nodes) {
+        if (node) {
+            node->setImpact(ImpactState::None);
+        }
+    }
+}
+
+void ImpactEngine::onHealthChanged(int handle, HealthCode code)
+{
+    if (handle >= m_entries.size() || !m_entries[handle].tracked) {
+        return;
+    }
+    
+    Entry& entry = m_entries[handle];
+    const bool failed = isFailed(code);
+    if (failed != entry.failed) {
+        entry.failed = failed;
+        markDirty(handle);
+    }
+    
+    // Impacted or suppressed only depends on the node's own health
+    if (entry.impacted) {
+        applyImpact(handle);
+    }
+}
+
+void ImpactEngine::markDirty(int handle)
+{
+    Entry& entry = m_entries[handle];
+    if (!entry.tracked || entry.dirty) {
+        return;
+    }
+    
+    entry.dirty = true;
+    m_dirty.append(handle);
+    if (!m_recomputeTimer->isActive()) {
+        m_recomputeTimer->start();
+    }
+}
+
+bool ImpactEngine::carries(const Edge& edge) const
+{
+    return edge.type >= 0 && (m_propagateMask & (1u << edge.type)) != 0;
+}
+
+bool ImpactEngine::isDown(int handle) const
+{
+    return m_entries[handle].failed || m_entries[handle].impacted;
+}
+
+bool ImpactEngine::isRoot(int handle) const
+{
+    return m_entries[handle].failed && !m_entries[handle].impacted;
+}
+
+bool ImpactEngine::addReachedBy(Entry& entry, int failed)
+{
+    for (int& slot : entry.reachedBy) {
+        if (slot == failed) {
+            return false;
+        }
+        if (slot == NoNode) {
+            slot = failed;
+            return true;
+        }
+    }
+    return false;
+}
+
+void ImpactEngine::recompute()
+{
+    m_recomputeTimer->stop();
+    if (m_dirty.isEmpty()) {
+        return;
+    }
+    
+    const QVector<int> starts = m_dirty;
+    m_dirty.clear();
+    const quint32 pass = ++m_pass;
+    
+    // Only nodes downstream of a change can change; the rest stays as kept
+    QVector<int> region;
+    for (int handle : starts) {
+        Entry& entry = m_entries[handle];
+        entry.dirty = false;
+        if (entry.tracked && entry.mark != pass) {
+            entry.mark = pass;
+            region.append(handle);
+        }
+    }
+    for (int i = 0; i < region.size(); ++i) {
+        for (int index : m_entries[region[i]].out) {
+            const Edge& edge = m_edges[index];
+            if (carries(edge) && m_entries[edge.target].mark != pass) {
+                m_entries[edge.target].mark = pass;
+                region.append(edge.target);
+            }
+        }
+    }
+    
+    m_recomputations++;
+    m_nodesVisited += region.size();
+    
+    QVector<bool> wasImpacted(region.size());
+    QVector<int> oldRootCause(region.size());
+    for (int i = 0; i < region.size(); ++i) {
+        Entry& entry = m_entries[region[i]];
+        wasImpacted[i] = entry.impacted;
+        oldRootCause[i] = entry.rootCause;
+        entry.reachedBy[0] = entry.failed ? region[i] : NoNode;
+        entry.reachedBy[1] = NoNode;
+        entry.pendingRoot = NoNode;
+    }
+    
+    // Failed nodes reaching each node, starting from the region's own and
+    // from those kept by the nodes feeding into it. Each node is queued at
+    // most once per failed node it takes on.
+    QVector<int> queue;
+    for (int handle : region) {
+        Entry& entry = m_entries[handle];
+        for (int index : entry.in) {
+            const Edge& edge = m_edges[index];
+            const Entry& from = m_entries[edge.source];
+            if (!carries(edge) || from.mark == pass) {
+                continue;
+            }
+            for (int failed : from.reachedBy) {
+                if (failed != NoNode) {
+                    addReachedBy(entry, failed);
+                }
+            }
+        }
+        if (entry.reachedBy[0] != NoNode) {
+            queue.append(handle);
+        }
+    }
+    for (int i = 0; i < queue.size(); ++i) {
+        const int handle = queue[i];
+        for (int index : m_entries[handle].out) {
+            const Edge& edge = m_edges[index];
+            if (!carries(edge)) {
+                continue;
+            }
+            bool added = false;
+            for (int failed : m_entries[handle].reachedBy) {
+                if (failed != NoNode && addReachedBy(m_entries[edge.target], failed)) {
+                    added = true;
+                }
+            }
+            if (added) {
+                queue.append(edge.target);
+            }
+        }
+    }
+    
+    for (int handle : region) {
+        Entry& entry = m_entries[handle];
+        entry.impacted = (entry.reachedBy[0] != NoNode && entry.reachedBy[0] != handle)
+                         || (entry.reachedBy[1] != NoNode && entry.reachedBy[1] != handle);
+    }
+    
+    // Root causes spread outward from the nearest failed, unimpacted nodes
+    queue.clear();
+    for (int handle : region) {
+        Entry& entry = m_entries[handle];
+        if (isRoot(handle)) {
+            entry.pendingRoot = handle;
+            queue.append(handle);
+            continue;
+        }
+        if (!entry.impacted) {
+            continue;
+        }
+        for (int index : entry.in) {
+            const Edge& edge = m_edges[index];
+            if (!carries(edge) || m_entries[edge.source].mark == pass || !isDown(edge.source)) {
+                continue;
+            }
+            const int rootCause = m_entries[edge.source].rootCause;
+            if (rootCause != NoNode && isRoot(rootCause)) {
+                entry.pendingRoot = rootCause;
+                queue.append(handle);
+                break;
+            }
+        }
+    }
+    for (int i = 0; i < queue.size(); ++i) {
+        const int handle = queue[i];
+        for (int index : m_entries[handle].out) {
+            const Edge& edge = m_edges[index];
+            Entry& to = m_entries[edge.target];
+            if (carries(edge) && to.impacted && to.pendingRoot == NoNode) {
+                to.pendingRoot = m_entries[handle].pendingRoot;
+                queue.append(edge.target);
+            }
+        }
+    }
+    
+    // Commit the whole region before any node hears about it
+    QVector<int> changed;
+    for (int i = 0; i < region.size(); ++i) {
+        const int handle = region[i];
+        Entry& entry = m_entries[handle];
+        if (entry.impacted && entry.pendingRoot == NoNode) {
+            // Only failed nodes feeding each other in a loop reach this one
+            entry.pendingRoot = entry.reachedBy[0] != handle ? entry.reachedBy[0]
+                                                              : entry.reachedBy[1];
+        }
+        entry.rootCause = entry.pendingRoot;
+        if (entry.impacted != wasImpacted[i]
+            || (entry.impacted && entry.rootCause != oldRootCause[i])) {
+            changed.append(handle);
+        }
+    }
+    
+    for (int handle : changed) {
+        applyImpact(handle);
+    }
+}
+
+void ImpactEngine::applyImpact(int handle)
+{
+    if (handle >= m_entries.size() || !m_entries[handle].tracked || !m_entries[handle].node) {
+        return;
+    }
+    
+    const Entry& entry = m_entries[handle];
+    SubsystemNode* node = entry.node;
+    if (!entry.impacted) {
+        node->setImpact(ImpactState::None);
+        return;
+    }
+    
+    QString rootCauseName;
+    if (entry.rootCause != NoNode && m_entries[entry.rootCause].node) {
+        rootCauseName = m_entries[entry.rootCause].node->nodeName();
+    }
+    
+    const HealthCode code = node->healthStatus().code();
+    node->setImpact(code == HealthCode::OK || code == HealthCode::UNKNOWN
+                    ? ImpactState::Impacted : ImpactState::Suppressed,
+                    rootCauseName);
+}
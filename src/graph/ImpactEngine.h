@@ -0,0 +1,131 @@
+/**
+ * @file ImpactEngine.h
+ * @brief Propagates subsystem failures downstream along graph connections
+ */
+
+#ifndef IMPACTENGINE_H
+#define IMPACTENGINE_H
+
+#include <QObject>
+#include <QHash>
+#include <QPointer>
+#include <QString>
+#include <QVector>
+#include "../core/SubsystemNode.h"
+
+class QTimer;
+class NodeDataModel;
+struct NodeConnection;
+
+/**
+ * @class ImpactEngine
+ * @brief Marks nodes fed by a failed node as impacted and names the root cause
+ * 
+ * A node is failed while its health is ERROR or OFFLINE. A connection
+ * carries a failure from its source to its target if propagation is
+ * enabled for the type of the source's output port (all four output types
+ * by default). A node is impacted when a failed node other than itself
+ * reaches it over such connections, directly or through other nodes.
+ * 
+ * Impacted nodes get SubsystemNode::setImpact(): ImpactState::Impacted if
+ * their own health is OK or UNKNOWN, ImpactState::Suppressed if they raise
+ * an alarm of their own, which is then taken as a symptom. The root cause
+ * named is the nearest failed node upstream that is not impacted itself;
+ * only where failed nodes feed each other in a loop is there none, and
+ * one of them is named instead.
+ * 
+ * Each node keeps up to two failed nodes that reach it, which is enough
+ * to tell whether one other than itself does. A change to a node's failed
+ * state or to a connection only recomputes the nodes downstream of it,
+ * reading the kept state of the nodes feeding into that region. Changes
+ * are collected and recomputed together once control returns to the
+ * event loop, and setImpact() is only called on nodes whose impact
+ * actually changed.
+ * 
+ * Single-threaded: call from the thread the nodes live on.
+ */
+class ImpactEngine : public QObject
+{
+    Q_OBJECT
+    
+public:
+    explicit ImpactEngine(QObject* parent = nullptr);
+    ~ImpactEngine();
+    
+    // Follows the nodes and connections of this model; nullptr detaches
+    void setModel(NodeDataModel* model);
+    NodeDataModel* model() const { return m_model; }
+    
+    // Whether connections from an output port of this type carry failures
+    void setPropagates(PortType outputType, bool enabled);
+    bool propagates(PortType outputType) const;
+    
+    static bool isFailed(HealthCode code);
+    
+    quint64 recomputations() const { return m_recomputations; }
+    quint64 nodesVisited() const { return m_nodesVisited; }
+    
+public slots:
+    // Recomputes every node touched by a change since the last pass
+    void recompute();
+    
+private slots:
+    void onNodeAdded(const QString& nodeId);
+    void onNodeRemoved(const QString& nodeId);
+    void onConnectionAdded(const QString& connectionId);
+    void onConnectionRemoved(const QString& connectionId);
+    void onModelCleared();
+    
+private:
+    static constexpr int NoNode = -1;
+    
+    struct Edge {
+        QString connectionId;
+        int source = NoNode;
+        int target = NoNode;
+        int type = -1;              ///< PortType of the source port, -1 if unknown
+    };
+    
+    struct Entry {
+        QPointer<SubsystemNode> node;
+        QMetaObject::Connection healthConnection;
+        QVector<int> out;           ///< Indices into m_edges
+        QVector<int> in;
+        int reachedBy[2] = { NoNode, NoNode };  ///< Failed nodes reaching this one
+        int rootCause = NoNode;     ///< Own handle for a failed, unimpacted node
+        int pendingRoot = NoNode;
+        quint32 mark = 0;
+        bool tracked = false;
+        bool failed = false;
+        bool impacted = false;
+        bool dirty = false;
+    };
+    
+    void rebuild();
+    void track(SubsystemNode* node);
+    void untrack(int handle);
+    void addEdge(const NodeConnection& connection);
+    void removeEdge(int index);
+    void reset();
+    void onHealthChanged(int handle, HealthCode code);
+    void markDirty(int handle);
+    bool carries(const Edge& edge) const;
+    bool isDown(int handle) const;
+    bool isRoot(int handle) const;
+    bool addReachedBy(Entry& entry, int failed);
+    void applyImpact(int handle);
+    
+    QPointer<NodeDataModel> m_model;
+    QVector<Entry> m_entries;       ///< Indexed by interned node handle
+    QVector<Edge> m_edges;
+    QVector<int> m_freeEdges;
+    QHash<QString, int> m_edgeIndex;
+    QVector<int> m_dirty;
+    quint32 m_propagateMask;
+    quint32 m_pass;
+    quint64 m_recomputations;
+    quint64 m_nodesVisited;
+    QTimer* m_recomputeTimer;
+};
+
+#endif // IMPACTENGINE_H
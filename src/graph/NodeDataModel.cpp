@@ -5,6 +5,7 @@
 
 #include "NodeDataModel.h"
 #include "../core/SubsystemNode.h"
+#include "../core/IdInterner.h"
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonArray>
@@ -28,17 +29,22 @@ void NodeDataModel::addNode(SubsystemNode* node, const QPointF& position)
     }
     
     QString nodeId = node->nodeId();
-    if (m_nodes.contains(nodeId)) {
+    const quint32 handle = node->handle();
+    if (handle == IdInterner::InvalidHandle) {
+        qWarning() << "Cannot add node without a valid ID:" << nodeId;
+        return;
+    }
+    if (m_nodes.contains(handle)) {
         qWarning() << "Node already exists:" << nodeId;
         return;
     }
     
-    m_nodes[nodeId] = node;
+    m_nodes[handle] = node;
     
     NodeLayout layout;
     layout.nodeId = nodeId;
     layout.position = position;
-    m_layouts[nodeId] = layout;
+    m_layouts[handle] = layout;
     
     emit nodeAdded(nodeId);
     qDebug() << "Added node to model:" << nodeId << node->nodeName();
@@ -46,7 +52,8 @@ void NodeDataModel::addNode(SubsystemNode* node, const QPointF& position)
 
 void NodeDataModel::removeNode(const QString& nodeId)
 {
-    if (!m_nodes.contains(nodeId)) {
+    const quint32 handle = handleOf(nodeId);
+    if (!m_nodes.contains(handle)) {
         qWarning() << "Node not found:" << nodeId;
         return;
     }
@@ -64,8 +71,8 @@ void NodeDataModel::removeNode(const QString& nodeId)
     }
     
     // Remove node
-    m_nodes.remove(nodeId);
-    m_layouts.remove(nodeId);
+    m_nodes.remove(handle);
+    m_layouts.remove(handle);
     
     emit nodeRemoved(nodeId);
     qDebug() << "Removed node from model:" << nodeId;
@@ -73,7 +80,12 @@ void NodeDataModel::removeNode(const QString& nodeId)
 
 SubsystemNode* NodeDataModel::getNode(const QString& nodeId) const
 {
-    return m_nodes.value(nodeId, nullptr);
+    return m_nodes.value(handleOf(nodeId), nullptr);
+}
+
+SubsystemNode* NodeDataModel::getNode(quint32 handle) const
+{
+    return m_nodes.value(handle, nullptr);
 }
 
 QList<SubsystemNode*> NodeDataModel::allNodes() const
@@ -140,35 +152,47 @@ QList<NodeConnection> NodeDataModel::connectionsForNode(const QString& nodeId) c
 
 void NodeDataModel::setNodePosition(const QString& nodeId, const QPointF& position)
 {
-    if (!m_layouts.contains(nodeId)) {
+    auto it = m_layouts.find(handleOf(nodeId));
+    if (it == m_layouts.end()) {
         qWarning() << "Node layout not found:" << nodeId;
         return;
     }
     
-    m_layouts[nodeId].position = position;
+    it->position = position;
     emit nodePositionChanged(nodeId, position);
 }
 
 QPointF NodeDataModel::nodePosition(const QString& nodeId) const
 {
-    return m_layouts.value(nodeId).position;
+    return m_layouts.value(handleOf(nodeId)).position;
 }
 
 void NodeDataModel::setNodeSize(const QString& nodeId, const QSizeF& size)
 {
-    if (m_layouts.contains(nodeId)) {
-        m_layouts[nodeId].size = size;
+    auto it = m_layouts.find(handleOf(nodeId));
+    if (it != m_layouts.end()) {
+        it->size = size;
     }
 }
 
 QSizeF NodeDataModel::nodeSize(const QString& nodeId) const
 {
-    return m_layouts.value(nodeId).size;
+    return m_layouts.value(handleOf(nodeId)).size;
 }
 
 NodeLayout NodeDataModel::nodeLayout(const QString& nodeId) const
 {
-    return m_layouts.value(nodeId);
+    return m_layouts.value(handleOf(nodeId));
+}
+
+NodeLayout NodeDataModel::nodeLayout(quint32 handle) const
+{
+    return m_layouts.value(handle);
+}
+
+quint32 NodeDataModel::handleOf(const QString& nodeId)
+{
+    return IdInterner::instance().find(nodeId);
 }
 
 bool NodeDataModel::canConnect(const QString& srcNode, const QString& srcPort,
@@ -272,8 +296,9 @@ bool NodeDataModel::deserialize(const QString& data)
         layout.zIndex = nodeObj["zIndex"].toInt();
         
         // Only restore if node exists
-        if (m_nodes.contains(layout.nodeId)) {
-            m_layouts[layout.nodeId] = layout;
+        const quint32 handle = handleOf(layout.nodeId);
+        if (m_nodes.contains(handle)) {
+            m_layouts[handle] = layout;
         }
     }
     
@@ -290,7 +315,8 @@ bool NodeDataModel::deserialize(const QString& data)
         conn.isValid = true;
         
         // Validate that nodes exist
-        if (m_nodes.contains(conn.sourceNodeId) && m_nodes.contains(conn.targetNodeId)) {
+        if (m_nodes.contains(handleOf(conn.sourceNodeId))
+            && m_nodes.contains(handleOf(conn.targetNodeId))) {
             m_connections[conn.connectionId] = conn;
         }
     }
@@ -11,6 +11,8 @@
 #include <QUuid>
 #include <QPointF>
 #include <QList>
+#include <QHash>
+#include <QMap>
 #include <memory>
 
 class SubsystemNode;
@@ -64,6 +66,9 @@ struct NodeLayout {
  * 
  * Manages nodes, connections, and layout in a graph scene.
  * Separate from visual representation for clean architecture.
+ * 
+ * Nodes are stored by their interned handle (SubsystemNode::handle());
+ * the string overloads resolve the handle first.
  */
 class NodeDataModel : public QObject
 {
@@ -77,6 +82,7 @@ public:
     void addNode(SubsystemNode* node, const QPointF& position = QPointF(0, 0));
     void removeNode(const QString& nodeId);
     SubsystemNode* getNode(const QString& nodeId) const;
+    SubsystemNode* getNode(quint32 handle) const;
     QList<SubsystemNode*> allNodes() const;
     int nodeCount() const { return m_nodes.size(); }
     
@@ -95,6 +101,7 @@ public:
     void setNodeSize(const QString& nodeId, const QSizeF& size);
     QSizeF nodeSize(const QString& nodeId) const;
     NodeLayout nodeLayout(const QString& nodeId) const;
+    NodeLayout nodeLayout(quint32 handle) const;
     
     // Validation
     bool canConnect(const QString& srcNode, const QString& srcPort,
@@ -118,9 +125,12 @@ signals:
     void modelCleared();
     
 private:
-    QMap<QString, SubsystemNode*> m_nodes;
+    static quint32 handleOf(const QString& nodeId);
+    
+    // Nodes and layouts are keyed by interned node handle
+    QHash<quint32, SubsystemNode*> m_nodes;
     QMap<QString, NodeConnection> m_connections;
-    QMap<QString, NodeLayout> m_layouts;
+    QHash<quint32, NodeLayout> m_layouts;
 };
 
 #endif // NODEDATAMODEL_H
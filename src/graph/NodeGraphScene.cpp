@@ -7,6 +7,7 @@
 #include "ConnectionManager.h"
 #include "../ui/NodeWidget.h"
 #include "../core/SubsystemNode.h"
+#include "../core/IdInterner.h"
 #include <QGraphicsSceneMouseEvent>
 #include <QGraphicsView>
 #include <QKeyEvent>
@@ -43,6 +44,17 @@ void NodeGraphScene::addNode(SubsystemNode* node, const QPointF& position)
     
     // Add to data model
     m_dataModel->addNode(node, position);
+    if (m_dataModel->getNode(node->nodeId()) != node) {
+        return;
+    }
+    
+    // Nodes in a child graph roll their health up into its owner
+    if (SubsystemNode* owner = qobject_cast<SubsystemNode*>(parent())) {
+        if (!node->setParentNode(owner)) {
+            m_dataModel->removeNode(node->nodeId());
+            return;
+        }
+    }
     
     // Create visual widget
     createNodeWidget(node, position);
@@ -52,6 +64,8 @@ void NodeGraphScene::addNode(SubsystemNode* node, const QPointF& position)
 
 void NodeGraphScene::removeNode(const QString& nodeId)
 {
+    detachFromOwner(getNode(nodeId));
+    
     // Remove visual widget
     removeNodeWidget(nodeId);
     
@@ -73,7 +87,12 @@ QList<SubsystemNode*> NodeGraphScene::allNodes() const
 
 NodeWidget* NodeGraphScene::getNodeWidget(const QString& nodeId) const
 {
-    return m_nodeWidgets.value(nodeId, nullptr);
+    return m_nodeWidgets.value(IdInterner::instance().find(nodeId), nullptr);
+}
+
+NodeWidget* NodeGraphScene::getNodeWidget(quint32 handle) const
+{
+    return m_nodeWidgets.value(handle, nullptr);
 }
 
 QString NodeGraphScene::createConnection(const QString& srcNode, const QString& srcPort,
@@ -108,6 +127,10 @@ QList<NodeConnection> NodeGraphScene::allConnections() const
 
 void NodeGraphScene::clearScene()
 {
+    for (SubsystemNode* node : allNodes()) {
+        detachFromOwner(node);
+    }
+    
     // Remove all visual widgets
     for (auto widget : m_nodeWidgets) {
         removeItem(widget);
@@ -235,8 +258,9 @@ void NodeGraphScene::handleNodePositionChanged(const QString& nodeId, const QPoi
 void NodeGraphScene::createNodeWidget(SubsystemNode* node, const QPointF& position)
 {
     QString nodeId = node->nodeId();
+    const quint32 handle = node->handle();
     
-    if (m_nodeWidgets.contains(nodeId)) {
+    if (m_nodeWidgets.contains(handle)) {
         qWarning() << "Node widget already exists:" << nodeId;
         return;
     }
@@ -245,21 +269,28 @@ void NodeGraphScene::createNodeWidget(SubsystemNode* node, const QPointF& positi
     widget->setPos(position);
     addItem(widget);
     
-    m_nodeWidgets[nodeId] = widget;
+    m_nodeWidgets[handle] = widget;
     
     qDebug() << "Created node widget:" << nodeId << "at" << position;
 }
 
+void NodeGraphScene::detachFromOwner(SubsystemNode* node)
+{
+    SubsystemNode* owner = qobject_cast<SubsystemNode*>(parent());
+    if (node && owner && node->parentNode() == owner) {
+        node->setParentNode(nullptr);
+    }
+}
+
 void NodeGraphScene::removeNodeWidget(const QString& nodeId)
 {
-    if (!m_nodeWidgets.contains(nodeId)) {
+    NodeWidget* widget = m_nodeWidgets.take(IdInterner::instance().find(nodeId));
+    if (!widget) {
         return;
     }
     
-    NodeWidget* widget = m_nodeWidgets[nodeId];
     removeItem(widget);
     delete widget;
-    m_nodeWidgets.remove(nodeId);
     
     qDebug() << "Removed node widget:" << nodeId;
 }
@@ -7,7 +7,7 @@
 #define NODEGRAPHSCENE_H
 
 #include <QGraphicsScene>
-#include <QMap>
+#include <QHash>
 #include <memory>
 #include "NodeDataModel.h"
 
@@ -22,6 +22,9 @@ class ConnectionManager;
  * 
  * Provides visual representation of radar subsystem architecture
  * with interactive node placement and connection editing.
+ * 
+ * A scene that is a node's child graph makes that node the parentNode()
+ * of every node added to it, and detaches them again on removal.
  */
 class NodeGraphScene : public QGraphicsScene
 {
@@ -39,6 +42,7 @@ public:
     
     // Visual node items
     NodeWidget* getNodeWidget(const QString& nodeId) const;
+    NodeWidget* getNodeWidget(quint32 handle) const;
     
     // Connection management
     QString createConnection(const QString& srcNode, const QString& srcPort,
@@ -86,10 +90,11 @@ private slots:
 private:
     void createNodeWidget(SubsystemNode* node, const QPointF& position);
     void removeNodeWidget(const QString& nodeId);
+    void detachFromOwner(SubsystemNode* node);
     
     std::unique_ptr<NodeDataModel> m_dataModel;
     std::unique_ptr<ConnectionManager> m_connectionManager;
-    QMap<QString, NodeWidget*> m_nodeWidgets;
+    QHash<quint32, NodeWidget*> m_nodeWidgets;     ///< Keyed by node handle
     
     // Interaction state
     bool m_isDragging;
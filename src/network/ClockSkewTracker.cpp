@@ -0,0 +1,98 @@
+/**
+ * @file ClockSkewTracker.cpp
+ * @brief Implementation of per-subsystem clock skew tracking
+ */
+
+#include "ClockSkewTracker.h"
+#include "../core/IdInterner.h"
+#include <chrono>
+
+namespace {
+
+// Exponential smoothing weight; 1/16 follows a change within a few dozen packets
+constexpr double SmoothingFactor = 1.0 / 16.0;
+
+} // namespace
+
+ClockSkewTracker::ClockSkewTracker()
+    : m_windowNs(DefaultWindowMs * 1000000)
+{
+}
+
+qint64 ClockSkewTracker::currentTimeNs()
+{
+    using namespace std::chrono;
+    return duration_cast<nanoseconds>(system_clock::now().time_since_epoch()).count();
+}
+
+void ClockSkewTracker::addSample(quint32 subsystemHandle, qint64 senderTimestampMs,
+                                 qint64 receiveTimestampNs, qint64 dispatchTimestampNs)
+{
+    if (subsystemHandle == IdInterner::InvalidHandle
+        || receiveTimestampNs <= 0 || senderTimestampMs <= 0) {
+        return;
+    }
+    
+    SenderState& state = m_senders[subsystemHandle];
+    ClockSkewEstimate& estimate = state.estimate;
+    
+    const double delayMs = receiveTimestampNs / 1e6 - static_cast<double>(senderTimestampMs);
+    const double processingMs = (dispatchTimestampNs - receiveTimestampNs) / 1e6;
+    
+    // Two-window minimum: the floor can rise again after a clock step,
+    // but a single slow window cannot lift it
+    if (estimate.samples == 0) {
+        state.windowStartNs = receiveTimestampNs;
+        state.windowMinimumMs = delayMs;
+        state.previousWindowMinimumMs = delayMs;
+    } else if (receiveTimestampNs - state.windowStartNs >= m_windowNs) {
+        state.previousWindowMinimumMs = state.windowMinimumMs;
+        state.windowMinimumMs = delayMs;
+        state.windowStartNs = receiveTimestampNs;
+    } else {
+        state.windowMinimumMs = qMin(state.windowMinimumMs, delayMs);
+    }
+    
+    estimate.clockOffsetMs = qMin(state.windowMinimumMs, state.previousWindowMinimumMs);
+    const double networkMs = delayMs - estimate.clockOffsetMs;
+    
+    if (estimate.samples == 0) {
+        estimate.networkLatencyMs = networkMs;
+        estimate.processingLatencyMs = processingMs;
+    } else {
+        estimate.networkLatencyMs += (networkMs - estimate.networkLatencyMs) * SmoothingFactor;
+        estimate.processingLatencyMs += (processingMs - estimate.processingLatencyMs) * SmoothingFactor;
+    }
+    
+    estimate.samples++;
+    estimate.lastDelayMs = delayMs;
+    estimate.lastReceiveTimestampNs = receiveTimestampNs;
+}
+
+ClockSkewEstimate ClockSkewTracker::estimate(quint32 subsystemHandle) const
+{
+    auto it = m_senders.constFind(subsystemHandle);
+    if (it == m_senders.constEnd()) {
+        return ClockSkewEstimate();
+    }
+    return it->estimate;
+}
+
+QMap<QString, ClockSkewEstimate> ClockSkewTracker::estimates() const
+{
+    QMap<QString, ClockSkewEstimate> result;
+    for (auto it = m_senders.constBegin(); it != m_senders.constEnd(); ++it) {
+        result.insert(IdInterner::instance().name(it.key()), it->estimate);
+    }
+    return result;
+}
+
+void ClockSkewTracker::setWindow(qint64 msec)
+{
+    m_windowNs = qMax<qint64>(1, msec) * 1000000;
+}
+
+void ClockSkewTracker::clear()
+{
+    m_senders.clear();
+}
@@ -0,0 +1,73 @@
+/**
+ * @file ClockSkewTracker.h
+ * @brief Per-subsystem clock offset and ingest latency estimation
+ */
+
+#ifndef CLOCKSKEWTRACKER_H
+#define CLOCKSKEWTRACKER_H
+
+#include <QHash>
+#include <QMap>
+#include <QString>
+
+/**
+ * @struct ClockSkewEstimate
+ * @brief Current estimates for one subsystem, all in milliseconds
+ */
+struct ClockSkewEstimate {
+    quint64 samples = 0;
+    double clockOffsetMs = 0.0;         ///< Receiver clock minus sender clock (incl. minimum path delay)
+    double networkLatencyMs = 0.0;      ///< Smoothed delay above the fastest recent packet
+    double processingLatencyMs = 0.0;   ///< Smoothed kernel receive -> dispatcher delay
+    double lastDelayMs = 0.0;           ///< Raw receive time minus sender timestamp
+    qint64 lastReceiveTimestampNs = 0;
+};
+
+/**
+ * @class ClockSkewTracker
+ * @brief Separates sender clock offset, network delay and local processing delay
+ * 
+ * Each sample pairs the sender's timestamp with the kernel receive time
+ * and the time the packet reached the dispatcher. One-way measurements
+ * cannot tell a constant path delay from clock offset, so the offset is
+ * taken as the smallest raw delay seen over the last one to two windows
+ * (which also tracks slow drift); the network latency is the smoothed
+ * excess over that floor. Processing latency needs no sender clock at all.
+ * 
+ * Not thread-safe; callers serialise access (the dispatcher stripes
+ * trackers by subsystem).
+ */
+class ClockSkewTracker
+{
+public:
+    static constexpr qint64 DefaultWindowMs = 10000;
+    
+    ClockSkewTracker();
+    
+    // Wall clock in ns (CLOCK_REALTIME, the clock SO_TIMESTAMPNS reports)
+    static qint64 currentTimeNs();
+    
+    // Subsystems are keyed by interned handle (see IdInterner)
+    void addSample(quint32 subsystemHandle, qint64 senderTimestampMs,
+                   qint64 receiveTimestampNs, qint64 dispatchTimestampNs);
+    
+    ClockSkewEstimate estimate(quint32 subsystemHandle) const;
+    QMap<QString, ClockSkewEstimate> estimates() const;     ///< Keyed by subsystem ID
+    
+    void setWindow(qint64 msec);
+    qint64 window() const { return m_windowNs / 1000000; }
+    void clear();
+    
+private:
+    struct SenderState {
+        ClockSkewEstimate estimate;
+        double windowMinimumMs = 0.0;
+        double previousWindowMinimumMs = 0.0;
+        qint64 windowStartNs = 0;
+    };
+    
+    QHash<quint32, SenderState> m_senders;
+    qint64 m_windowNs;
+};
+
+#endif // CLOCKSKEWTRACKER_H
@@ -0,0 +1,370 @@
+/**
+ * @file DatagramBatchReader.cpp
+ * @brief Implementation of batched UDP datagram reader
+ */
+
+#include "DatagramBatchReader.h"
+#include <QDebug>
+#include <algorithm>
+#include <cstring>
+
+#ifdef PLATFORM_LINUX
+#include <netinet/in.h>
+#include <time.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+DatagramBatchReader::DatagramBatchReader(int batchSize, DatagramBufferPool* pool)
+    : m_fd(-1)
+    , m_batchSize(std::clamp(batchSize, 1, MaxBatchSize))
+    , m_count(0)
+    , m_kernelDropCount(0)
+    , m_reportedDropCount(0)
+    , m_pool(pool)
+{
+#ifdef PLATFORM_LINUX
+    if (!m_pool) {
+        m_ownedPool = std::make_unique<DatagramBufferPool>(m_batchSize, MaxDatagramSize);
+        m_pool = m_ownedPool.get();
+    }
+    
+    // One receive buffer per batch slot, refilled from the pool as taken
+    m_buffers.resize(m_batchSize);
+    m_headers.resize(m_batchSize);
+    m_iovecs.resize(m_batchSize);
+    m_addresses.resize(m_batchSize);
+    m_control.resize(m_batchSize);
+    m_timestamps.resize(m_batchSize);
+    
+    for (int i = 0; i < m_batchSize; ++i) {
+        std::memset(&m_headers[i], 0, sizeof(mmsghdr));
+        m_headers[i].msg_hdr.msg_iov = &m_iovecs[i];
+        m_headers[i].msg_hdr.msg_iovlen = 1;
+        m_headers[i].msg_hdr.msg_name = &m_addresses[i];
+        m_headers[i].msg_hdr.msg_namelen = sizeof(sockaddr_storage);
+    }
+#endif
+}
+
+DatagramBatchReader::~DatagramBatchReader()
+{
+    close();
+    
+    // Return the slot buffers before a private pool is destroyed
+    m_buffers.clear();
+}
+
+bool DatagramBatchReader::isSupported()
+{
+#ifdef PLATFORM_LINUX
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool DatagramBatchReader::open(quint16 port, bool reusePort, int receiveBufferSize)
+{
+    close();
+    
+#ifdef PLATFORM_LINUX
+    // Dual-stack like QUdpSocket bound to QHostAddress::Any: an IPv6 socket
+    // that also takes IPv4 as mapped addresses, or plain IPv4 on a kernel
+    // built without IPv6
+    bool dualStack = true;
+    int fd = ::socket(AF_INET6, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0 && errno == EAFNOSUPPORT) {
+        dualStack = false;
+        fd = ::socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    }
+    if (fd < 0) {
+        setError();
+        return false;
+    }
+    
+    if (dualStack) {
+        int v6Only = 0;
+        if (::setsockopt(fd, IPPROTO_IPV6, IPV6_V6ONLY, &v6Only, sizeof(v6Only)) < 0) {
+            setError();
+            ::close(fd);
+            return false;
+        }
+    }
+    
+    // SO_REUSEPORT must be set on every socket before bind; the kernel then
+    // hashes each flow (source address and port) onto one of the sockets
+    if (reusePort) {
+        int enable = 1;
+        if (::setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &enable, sizeof(enable)) < 0) {
+            setError();
+            ::close(fd);
+            return false;
+        }
+    }
+    
+    sockaddr_storage address;
+    socklen_t addressLength;
+    std::memset(&address, 0, sizeof(address));
+    if (dualStack) {
+        sockaddr_in6* any = reinterpret_cast<sockaddr_in6*>(&address);
+        any->sin6_family = AF_INET6;
+        any->sin6_port = htons(port);
+        any->sin6_addr = in6addr_any;
+        addressLength = sizeof(sockaddr_in6);
+    } else {
+        sockaddr_in* any = reinterpret_cast<sockaddr_in*>(&address);
+        any->sin_family = AF_INET;
+        any->sin_port = htons(port);
+        any->sin_addr.s_addr = htonl(INADDR_ANY);
+        addressLength = sizeof(sockaddr_in);
+    }
+    
+    // Kernel receive timestamps; without them latency is measured from
+    // when userspace got round to reading, which hides socket queueing
+    int timestamping = 1;
+    if (::setsockopt(fd, SOL_SOCKET, SO_TIMESTAMPNS, &timestamping, sizeof(timestamping)) < 0) {
+        qWarning() << "SO_TIMESTAMPNS unavailable:" << std::strerror(errno);
+    }
+    
+    // Kernel drop counter delivered with every datagram
+    int overflowReporting = 1;
+    if (::setsockopt(fd, SOL_SOCKET, SO_RXQ_OVFL, &overflowReporting, sizeof(overflowReporting)) < 0) {
+        qWarning() << "SO_RXQ_OVFL unavailable:" << std::strerror(errno);
+    }
+    
+    if (receiveBufferSize > 0) {
+        // SO_RCVBUFFORCE ignores net.core.rmem_max but needs CAP_NET_ADMIN
+        if (::setsockopt(fd, SOL_SOCKET, SO_RCVBUFFORCE,
+                         &receiveBufferSize, sizeof(receiveBufferSize)) < 0
+            && ::setsockopt(fd, SOL_SOCKET, SO_RCVBUF,
+                            &receiveBufferSize, sizeof(receiveBufferSize)) < 0) {
+            qWarning() << "Failed to set SO_RCVBUF:" << std::strerror(errno);
+        }
+    }
+    
+    if (::bind(fd, reinterpret_cast<sockaddr*>(&address), addressLength) < 0) {
+        setError();
+        ::close(fd);
+        return false;
+    }
+    
+    m_fd = fd;
+    m_kernelDropCount = 0;
+    m_reportedDropCount = 0;
+    m_errorString.clear();
+    
+    // The kernel doubles the requested size for bookkeeping overhead
+    if (receiveBufferSize > 0 && this->receiveBufferSize() / 2 < receiveBufferSize) {
+        qWarning() << "Receive buffer capped at" << this->receiveBufferSize() / 2
+                   << "bytes (requested" << receiveBufferSize << "); raise net.core.rmem_max";
+    }
+    return true;
+#else
+    Q_UNUSED(port)
+    Q_UNUSED(reusePort)
+    Q_UNUSED(receiveBufferSize)
+    m_errorString = "Batched receive is only supported on Linux";
+    return false;
+#endif
+}
+
+void DatagramBatchReader::close()
+{
+#ifdef PLATFORM_LINUX
+    if (m_fd >= 0) {
+        ::close(m_fd);
+    }
+#endif
+    m_fd = -1;
+    m_count = 0;
+}
+
+int DatagramBatchReader::receiveBatch()
+{
+    m_count = 0;
+    
+#ifdef PLATFORM_LINUX
+    if (m_fd < 0) {
+        return -1;
+    }
+    
+    refillBuffers();
+    
+    // The kernel overwrites these on every call
+    for (int i = 0; i < m_batchSize; ++i) {
+        m_headers[i].msg_hdr.msg_namelen = sizeof(sockaddr_storage);
+        m_headers[i].msg_hdr.msg_control = m_control[i].data;
+        m_headers[i].msg_hdr.msg_controllen = sizeof(m_control[i].data);
+        m_headers[i].msg_hdr.msg_flags = 0;
+        m_headers[i].msg_len = 0;
+    }
+    
+    int received = ::recvmmsg(m_fd, m_headers.data(), m_batchSize, MSG_DONTWAIT, nullptr);
+    if (received < 0) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+            return 0;
+        }
+        setError();
+        return -1;
+    }
+    
+    for (int i = 0; i < received; ++i) {
+        m_timestamps[i] = 0;
+        
+        msghdr* header = &m_headers[i].msg_hdr;
+        for (cmsghdr* cmsg = CMSG_FIRSTHDR(header); cmsg; cmsg = CMSG_NXTHDR(header, cmsg)) {
+            if (cmsg->cmsg_level != SOL_SOCKET) {
+                continue;
+            }
+            if (cmsg->cmsg_type == SCM_TIMESTAMPNS) {
+                timespec stamp;
+                std::memcpy(&stamp, CMSG_DATA(cmsg), sizeof(stamp));
+                m_timestamps[i] = static_cast<qint64>(stamp.tv_sec) * 1000000000 + stamp.tv_nsec;
+            } else if (cmsg->cmsg_type == SO_RXQ_OVFL) {
+                std::memcpy(&m_kernelDropCount, CMSG_DATA(cmsg), sizeof(m_kernelDropCount));
+            }
+        }
+    }
+    
+    m_count = received;
+    return received;
+#else
+    return -1;
+#endif
+}
+
+QByteArray DatagramBatchReader::datagram(int index) const
+{
+    if (index < 0 || index >= m_count) {
+        return QByteArray();
+    }
+    
+    // Raw-data view: no copy, valid until the buffer is reused
+    const DatagramBuffer& buffer = m_buffers[index];
+    if (buffer.isNull()) {
+        return QByteArray();
+    }
+    return QByteArray::fromRawData(buffer.constData(), datagramLength(index));
+}
+
+DatagramBuffer DatagramBatchReader::takeDatagram(int index)
+{
+    if (index < 0 || index >= m_count) {
+        return DatagramBuffer();
+    }
+    
+    DatagramBuffer buffer = std::move(m_buffers[index]);
+    buffer.setSize(datagramLength(index));
+    return buffer;
+}
+
+void DatagramBatchReader::refillBuffers()
+{
+#ifdef PLATFORM_LINUX
+    for (int i = 0; i < m_batchSize; ++i) {
+        if (m_buffers[i].isNull()) {
+            m_buffers[i] = m_pool->acquire(MaxDatagramSize);
+            m_iovecs[i].iov_base = m_buffers[i].data();
+            m_iovecs[i].iov_len = static_cast<size_t>(m_buffers[i].capacity());
+        }
+    }
+#endif
+}
+
+int DatagramBatchReader::datagramLength(int index) const
+{
+#ifdef PLATFORM_LINUX
+    return static_cast<int>(std::min<unsigned int>(m_headers[index].msg_len, MaxDatagramSize));
+#else
+    Q_UNUSED(index)
+    return 0;
+#endif
+}
+
+bool DatagramBatchReader::isTruncated(int index) const
+{
+#ifdef PLATFORM_LINUX
+    if (index >= 0 && index < m_count) {
+        return (m_headers[index].msg_hdr.msg_flags & MSG_TRUNC) != 0;
+    }
+#else
+    Q_UNUSED(index)
+#endif
+    return false;
+}
+
+QHostAddress DatagramBatchReader::senderAddress(int index) const
+{
+#ifdef PLATFORM_LINUX
+    if (index >= 0 && index < m_count) {
+        // IPv4 senders arrive as mapped addresses on the dual-stack socket
+        QHostAddress address(reinterpret_cast<const sockaddr*>(&m_addresses[index]));
+        bool ipv4 = false;
+        const quint32 ipv4Address = address.toIPv4Address(&ipv4);
+        return ipv4 ? QHostAddress(ipv4Address) : address;
+    }
+#else
+    Q_UNUSED(index)
+#endif
+    return QHostAddress();
+}
+
+quint16 DatagramBatchReader::senderPort(int index) const
+{
+#ifdef PLATFORM_LINUX
+    if (index >= 0 && index < m_count) {
+        const sockaddr_storage& storage = m_addresses[index];
+        if (storage.ss_family == AF_INET) {
+            return ntohs(reinterpret_cast<const sockaddr_in*>(&storage)->sin_port);
+        }
+        if (storage.ss_family == AF_INET6) {
+            return ntohs(reinterpret_cast<const sockaddr_in6*>(&storage)->sin6_port);
+        }
+    }
+#else
+    Q_UNUSED(index)
+#endif
+    return 0;
+}
+
+int DatagramBatchReader::receiveBufferSize() const
+{
+#ifdef PLATFORM_LINUX
+    if (m_fd >= 0) {
+        int size = 0;
+        socklen_t length = sizeof(size);
+        if (::getsockopt(m_fd, SOL_SOCKET, SO_RCVBUF, &size, &length) == 0) {
+            return size;
+        }
+    }
+#endif
+    return 0;
+}
+
+quint32 DatagramBatchReader::takeKernelDrops()
+{
+    // Unsigned subtraction copes with the 32-bit counter wrapping
+    quint32 drops = m_kernelDropCount - m_reportedDropCount;
+    m_reportedDropCount = m_kernelDropCount;
+    return drops;
+}
+
+qint64 DatagramBatchReader::receiveTimestampNs(int index) const
+{
+#ifdef PLATFORM_LINUX
+    if (index >= 0 && index < m_count) {
+        return m_timestamps[index];
+    }
+#else
+    Q_UNUSED(index)
+#endif
+    return 0;
+}
+
+void DatagramBatchReader::setError()
+{
+#ifdef PLATFORM_LINUX
+    m_errorString = QString::fromLocal8Bit(std::strerror(errno));
+#endif
+}
@@ -0,0 +1,120 @@
+/**
+ * @file DatagramBatchReader.h
+ * @brief Batched UDP datagram reader using recvmmsg on Linux
+ */
+
+#ifndef DATAGRAMBATCHREADER_H
+#define DATAGRAMBATCHREADER_H
+
+#include <QByteArray>
+#include <QHostAddress>
+#include <QString>
+#include <memory>
+#include <vector>
+#include "DatagramBufferPool.h"
+
+#ifdef PLATFORM_LINUX
+#include <sys/socket.h>
+#include <sys/uio.h>
+#endif
+
+/**
+ * @class DatagramBatchReader
+ * @brief Drains up to N datagrams per system call into preallocated buffers
+ * 
+ * Owns a non-blocking UDP socket, dual-stack like a QUdpSocket bound to
+ * QHostAddress::Any, and one receive buffer per batch slot, taken from a
+ * DatagramBufferPool (a private pool if none is given).
+ * datagram() returns a raw-data view that stays valid until the next call
+ * to receiveBatch(); takeDatagram() hands the buffer itself to the caller
+ * and the slot is refilled from the pool before the next receive.
+ * 
+ * Each datagram carries its kernel receive time (SO_TIMESTAMPNS) and the
+ * socket's running drop count (SO_RXQ_OVFL), both read from the control
+ * messages delivered with it.
+ * 
+ * Only available on Linux; isSupported() returns false elsewhere and the
+ * caller is expected to fall back to QUdpSocket.
+ */
+class DatagramBatchReader
+{
+public:
+    static constexpr int DefaultBatchSize = 32;
+    static constexpr int MaxBatchSize = 1024;        ///< Kernel limit (UIO_MAXIOV)
+    static constexpr int MaxDatagramSize = 9216;     ///< Jumbo frame payload
+    
+    explicit DatagramBatchReader(int batchSize = DefaultBatchSize,
+                                 DatagramBufferPool* pool = nullptr);
+    ~DatagramBatchReader();
+    
+    DatagramBatchReader(const DatagramBatchReader&) = delete;
+    DatagramBatchReader& operator=(const DatagramBatchReader&) = delete;
+    
+    static bool isSupported();
+    
+    // Socket lifecycle; reusePort lets several readers share one port,
+    // receiveBufferSize (bytes, 0 = system default) sets SO_RCVBUF
+    bool open(quint16 port, bool reusePort = false, int receiveBufferSize = 0);
+    void close();
+    bool isOpen() const { return m_fd >= 0; }
+    int socketDescriptor() const { return m_fd; }
+    QString errorString() const { return m_errorString; }
+    
+    int batchSize() const { return m_batchSize; }
+    
+    // Effective SO_RCVBUF as reported by the kernel (0 if not open)
+    int receiveBufferSize() const;
+    
+    /**
+     * @brief Datagrams the kernel dropped for lack of buffer space since the last call
+     * 
+     * Updated whenever a datagram arrives, so drops only become visible
+     * once traffic resumes.
+     */
+    quint32 takeKernelDrops();
+    
+    /**
+     * @brief Receive up to batchSize() datagrams with a single recvmmsg call
+     * @return Number of datagrams received, 0 if none pending, -1 on error
+     */
+    int receiveBatch();
+    
+    // Access to the most recent batch (valid until the next receiveBatch)
+    int count() const { return m_count; }
+    QByteArray datagram(int index) const;
+    DatagramBuffer takeDatagram(int index);
+    bool isTruncated(int index) const;
+    QHostAddress senderAddress(int index) const;
+    quint16 senderPort(int index) const;
+    qint64 receiveTimestampNs(int index) const;     ///< 0 if the kernel supplied none
+    
+private:
+    void setError();
+    void refillBuffers();
+    int datagramLength(int index) const;
+    
+    int m_fd;
+    int m_batchSize;
+    int m_count;
+    quint32 m_kernelDropCount;      ///< Latest SO_RXQ_OVFL value (cumulative per socket)
+    quint32 m_reportedDropCount;
+    QString m_errorString;
+    std::unique_ptr<DatagramBufferPool> m_ownedPool;
+    DatagramBufferPool* m_pool;
+    std::vector<DatagramBuffer> m_buffers;
+    
+#ifdef PLATFORM_LINUX
+    std::vector<mmsghdr> m_headers;
+    std::vector<iovec> m_iovecs;
+    std::vector<sockaddr_storage> m_addresses;
+    
+    // Ancillary data per slot; room for the timestamp and the drop count
+    struct ControlBuffer {
+        alignas(cmsghdr) char data[64];
+    };
+    std::vector<ControlBuffer> m_control;
+    std::vector<qint64> m_timestamps;
+#endif
+};
+
+#endif // DATAGRAMBATCHREADER_H
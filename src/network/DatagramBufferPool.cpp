@@ -0,0 +1,212 @@
+/**
+ * @file DatagramBufferPool.cpp
+ * @brief Implementation of the receive buffer pool
+ */
+
+#include "DatagramBufferPool.h"
+#include <QDebug>
+#include <QtGlobal>
+#include <utility>
+
+// ============================================================================
+// DatagramBuffer
+// ============================================================================
+
+DatagramBuffer::DatagramBuffer(const DatagramBuffer& other)
+    : m_slot(other.m_slot)
+{
+    if (m_slot) {
+        m_slot->refs.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+DatagramBuffer::DatagramBuffer(DatagramBuffer&& other) noexcept
+    : m_slot(other.m_slot)
+{
+    other.m_slot = nullptr;
+}
+
+DatagramBuffer& DatagramBuffer::operator=(const DatagramBuffer& other)
+{
+    if (m_slot != other.m_slot) {
+        DatagramBuffer copy(other);
+        std::swap(m_slot, copy.m_slot);
+    }
+    return *this;
+}
+
+DatagramBuffer& DatagramBuffer::operator=(DatagramBuffer&& other) noexcept
+{
+    if (this != &other) {
+        reset();
+        m_slot = other.m_slot;
+        other.m_slot = nullptr;
+    }
+    return *this;
+}
+
+DatagramBuffer::~DatagramBuffer()
+{
+    reset();
+}
+
+void DatagramBuffer::setSize(qsizetype size)
+{
+    if (m_slot) {
+        m_slot->size = qBound<qsizetype>(0, size, m_slot->capacity);
+    }
+}
+
+void DatagramBuffer::reset()
+{
+    if (!m_slot) {
+        return;
+    }
+    
+    // The last reference hands the slot back; acq_rel orders every earlier
+    // read of the bytes before the slot can be reused
+    if (m_slot->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        DatagramBufferPool::release(m_slot);
+    }
+    m_slot = nullptr;
+}
+
+// ============================================================================
+// DatagramBufferPool
+// ============================================================================
+
+DatagramBufferPool::DatagramBufferPool(int bufferCount, int bufferSize)
+    : m_bufferCount(qMax(1, bufferCount))
+    , m_bufferSize(qMax(1, bufferSize))
+    , m_storage(new char[static_cast<size_t>(m_bufferCount) * m_bufferSize])
+    , m_slots(new DatagramBufferSlot[m_bufferCount])
+    , m_freeHead(0)
+    , m_inUse(0)
+    , m_highWaterMark(0)
+    , m_acquired(0)
+    , m_exhaustions(0)
+    , m_heapAllocations(0)
+{
+    // Chain every slot into the free list in index order
+    for (int i = 0; i < m_bufferCount; ++i) {
+        DatagramBufferSlot& slot = m_slots[i];
+        slot.data = m_storage.get() + static_cast<size_t>(i) * m_bufferSize;
+        slot.capacity = m_bufferSize;
+        slot.pool = this;
+        slot.next.store(i + 1 < m_bufferCount ? quint32(i + 1) : NoIndex,
+                        std::memory_order_relaxed);
+    }
+}
+
+DatagramBufferPool::~DatagramBufferPool()
+{
+    int outstanding = inUse();
+    if (outstanding > 0) {
+        qCritical() << "Datagram buffer pool destroyed with" << outstanding
+                    << "buffer(s) still in use";
+    }
+}
+
+DatagramBuffer DatagramBufferPool::acquire(qsizetype minimumSize)
+{
+    m_acquired.fetch_add(1, std::memory_order_relaxed);
+    
+    if (minimumSize <= m_bufferSize) {
+        quint32 index = popFree();
+        if (index != NoIndex) {
+            DatagramBufferSlot* slot = &m_slots[index];
+            slot->size = 0;
+            slot->refs.store(1, std::memory_order_relaxed);
+            
+            int used = m_inUse.fetch_add(1, std::memory_order_relaxed) + 1;
+            int peak = m_highWaterMark.load(std::memory_order_relaxed);
+            while (used > peak
+                   && !m_highWaterMark.compare_exchange_weak(peak, used, std::memory_order_relaxed)) {
+            }
+            
+            return DatagramBuffer(slot);
+        }
+        m_exhaustions.fetch_add(1, std::memory_order_relaxed);
+    }
+    
+    // Fallback: a one-off buffer freed again on release
+    m_heapAllocations.fetch_add(1, std::memory_order_relaxed);
+    
+    DatagramBufferSlot* slot = new DatagramBufferSlot;
+    slot->capacity = qMax<qsizetype>(minimumSize, m_bufferSize);
+    slot->data = new char[static_cast<size_t>(slot->capacity)];
+    slot->refs.store(1, std::memory_order_relaxed);
+    return DatagramBuffer(slot);
+}
+
+DatagramBufferPool::Statistics DatagramBufferPool::statistics() const
+{
+    Statistics stats;
+    stats.capacity = m_bufferCount;
+    stats.inUse = inUse();
+    stats.highWaterMark = highWaterMark();
+    stats.acquired = m_acquired.load(std::memory_order_relaxed);
+    stats.exhaustions = exhaustions();
+    stats.heapAllocations = m_heapAllocations.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void DatagramBufferPool::resetStatistics()
+{
+    m_highWaterMark.store(inUse(), std::memory_order_relaxed);
+    m_acquired.store(0, std::memory_order_relaxed);
+    m_exhaustions.store(0, std::memory_order_relaxed);
+    m_heapAllocations.store(0, std::memory_order_relaxed);
+}
+
+void DatagramBufferPool::release(DatagramBufferSlot* slot)
+{
+    if (slot->pool) {
+        slot->pool->recycle(slot);
+        return;
+    }
+    
+    delete[] slot->data;
+    delete slot;
+}
+
+void DatagramBufferPool::recycle(DatagramBufferSlot* slot)
+{
+    m_inUse.fetch_sub(1, std::memory_order_relaxed);
+    pushFree(static_cast<quint32>(slot - m_slots.get()));
+}
+
+quint32 DatagramBufferPool::popFree()
+{
+    quint64 head = m_freeHead.load(std::memory_order_acquire);
+    
+    for (;;) {
+        quint32 index = static_cast<quint32>(head);
+        if (index == NoIndex) {
+            return NoIndex;
+        }
+        
+        // A stale link is harmless: the tag makes the CAS below fail
+        quint32 next = m_slots[index].next.load(std::memory_order_relaxed);
+        quint64 replacement = (((head >> 32) + 1) << 32) | next;
+        
+        if (m_freeHead.compare_exchange_weak(head, replacement,
+                                             std::memory_order_acquire,
+                                             std::memory_order_acquire)) {
+            return index;
+        }
+    }
+}
+
+void DatagramBufferPool::pushFree(quint32 index)
+{
+    quint64 head = m_freeHead.load(std::memory_order_relaxed);
+    quint64 replacement;
+    
+    do {
+        m_slots[index].next.store(static_cast<quint32>(head), std::memory_order_relaxed);
+        replacement = (((head >> 32) + 1) << 32) | index;
+    } while (!m_freeHead.compare_exchange_weak(head, replacement,
+                                               std::memory_order_release,
+                                               std::memory_order_relaxed));
+}
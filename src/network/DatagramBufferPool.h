@@ -0,0 +1,150 @@
+/**
+ * @file DatagramBufferPool.h
+ * @brief Fixed-size pool of reference-counted receive buffers
+ */
+
+#ifndef DATAGRAMBUFFERPOOL_H
+#define DATAGRAMBUFFERPOOL_H
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <atomic>
+#include <memory>
+
+class DatagramBufferPool;
+
+/**
+ * @struct DatagramBufferSlot
+ * @brief Storage and reference count behind a DatagramBuffer
+ */
+struct DatagramBufferSlot {
+    char* data = nullptr;
+    qsizetype capacity = 0;
+    qsizetype size = 0;
+    std::atomic<int> refs{0};
+    std::atomic<quint32> next{0};       ///< Free-list link while in the pool
+    DatagramBufferPool* pool = nullptr; ///< nullptr for heap fallback buffers
+};
+
+/**
+ * @class DatagramBuffer
+ * @brief Shared handle to one receive buffer
+ * 
+ * Copies share the same bytes; the buffer goes back to its pool when the
+ * last handle is released. Only the holder of the sole reference should
+ * write to data().
+ */
+class DatagramBuffer
+{
+public:
+    DatagramBuffer() : m_slot(nullptr) {}
+    DatagramBuffer(const DatagramBuffer& other);
+    DatagramBuffer(DatagramBuffer&& other) noexcept;
+    DatagramBuffer& operator=(const DatagramBuffer& other);
+    DatagramBuffer& operator=(DatagramBuffer&& other) noexcept;
+    ~DatagramBuffer();
+    
+    bool isNull() const { return m_slot == nullptr; }
+    bool isPooled() const { return m_slot && m_slot->pool; }
+    
+    char* data() { return m_slot ? m_slot->data : nullptr; }
+    const char* constData() const { return m_slot ? m_slot->data : nullptr; }
+    qsizetype capacity() const { return m_slot ? m_slot->capacity : 0; }
+    qsizetype size() const { return m_slot ? m_slot->size : 0; }
+    void setSize(qsizetype size);
+    
+    // Views over the valid bytes; only valid while this handle is held
+    QByteArrayView view() const { return QByteArrayView(constData(), size()); }
+    QByteArray toByteArray() const { return QByteArray::fromRawData(constData(), size()); }
+    
+    void reset();
+    
+private:
+    friend class DatagramBufferPool;
+    explicit DatagramBuffer(DatagramBufferSlot* slot) : m_slot(slot) {}
+    
+    DatagramBufferSlot* m_slot;
+};
+
+/**
+ * @class DatagramBufferPool
+ * @brief Recycles a fixed set of equally sized receive buffers
+ * 
+ * All buffers are carved out of one allocation made up front. Free
+ * buffers sit on a lock-free stack (tagged head index, so a buffer may be
+ * released from any thread), which makes steady-state acquire/release
+ * allocation free.
+ * 
+ * When the pool is empty, or a request is larger than the buffer size,
+ * acquire() falls back to a one-off heap buffer and records the event so
+ * the pool can be sized from the statistics. The pool must outlive every
+ * buffer acquired from it.
+ */
+class DatagramBufferPool
+{
+public:
+    static constexpr int DefaultBufferCount = 256;
+    static constexpr int DefaultBufferSize = 9216;
+    
+    /**
+     * @struct Statistics
+     * @brief Point-in-time copy of the pool counters
+     */
+    struct Statistics {
+        int capacity = 0;
+        int inUse = 0;
+        int highWaterMark = 0;
+        quint64 acquired = 0;
+        quint64 exhaustions = 0;        ///< Acquires that found the pool empty
+        quint64 heapAllocations = 0;    ///< Fallback buffers (exhausted or oversized)
+    };
+    
+    explicit DatagramBufferPool(int bufferCount = DefaultBufferCount,
+                                int bufferSize = DefaultBufferSize);
+    ~DatagramBufferPool();
+    
+    DatagramBufferPool(const DatagramBufferPool&) = delete;
+    DatagramBufferPool& operator=(const DatagramBufferPool&) = delete;
+    
+    /**
+     * @brief Take a buffer with at least minimumSize bytes of capacity
+     * 
+     * Never fails; see the class description for the fallback.
+     */
+    DatagramBuffer acquire(qsizetype minimumSize = 0);
+    
+    int capacity() const { return m_bufferCount; }
+    int bufferSize() const { return m_bufferSize; }
+    int inUse() const { return m_inUse.load(std::memory_order_relaxed); }
+    int highWaterMark() const { return m_highWaterMark.load(std::memory_order_relaxed); }
+    quint64 exhaustions() const { return m_exhaustions.load(std::memory_order_relaxed); }
+    
+    Statistics statistics() const;
+    void resetStatistics();
+    
+private:
+    friend class DatagramBuffer;
+    
+    static constexpr quint32 NoIndex = 0xFFFFFFFFu;
+    
+    static void release(DatagramBufferSlot* slot);
+    void recycle(DatagramBufferSlot* slot);
+    quint32 popFree();
+    void pushFree(quint32 index);
+    
+    int m_bufferCount;
+    int m_bufferSize;
+    std::unique_ptr<char[]> m_storage;
+    std::unique_ptr<DatagramBufferSlot[]> m_slots;
+    
+    // Low 32 bits: index of the first free slot; high 32 bits: ABA tag
+    alignas(64) std::atomic<quint64> m_freeHead;
+    
+    alignas(64) std::atomic<int> m_inUse;
+    std::atomic<int> m_highWaterMark;
+    std::atomic<quint64> m_acquired;
+    std::atomic<quint64> m_exhaustions;
+    std::atomic<quint64> m_heapAllocations;
+};
+
+#endif // DATAGRAMBUFFERPOOL_H
@@ -0,0 +1,120 @@
+/**
+ * @file EpochSnapshot.h
+ * @brief Read-mostly immutable snapshot published through an atomic pointer
+ */
+
+#ifndef EPOCHSNAPSHOT_H
+#define EPOCHSNAPSHOT_H
+
+#include <atomic>
+#include <memory>
+#include <thread>
+
+/**
+ * @class EpochSnapshot
+ * @brief Lock-free readers, copy-on-write writers, epoch-based reclamation
+ * 
+ * Readers pin the current epoch in a ReadGuard, load the snapshot pointer
+ * and use it until the guard goes out of scope; that costs two atomic
+ * increments and never blocks. A writer builds a complete replacement,
+ * swaps it in and then waits until every reader that could still see the
+ * old snapshot has left before deleting it. Like user-space RCU this flips
+ * the epoch twice, so a reader that stalled between reading the epoch and
+ * registering under it is still waited for.
+ * 
+ * Writers must be serialised by the caller and must not hold a ReadGuard
+ * of the same snapshot while publishing. Read sections should be short:
+ * a writer spins (yielding) until they finish.
+ */
+template<typename T>
+class EpochSnapshot
+{
+public:
+    class ReadGuard
+    {
+    public:
+        explicit ReadGuard(const EpochSnapshot& owner)
+            : m_owner(&owner)
+            , m_parity(owner.m_epoch.load() & 1)
+        {
+            m_owner->m_readers[m_parity].fetch_add(1);
+            m_snapshot = m_owner->m_current.load();
+        }
+        
+        ~ReadGuard()
+        {
+            if (m_owner) {
+                m_owner->m_readers[m_parity].fetch_sub(1, std::memory_order_release);
+            }
+        }
+        
+        ReadGuard(ReadGuard&& other) noexcept
+            : m_owner(other.m_owner)
+            , m_parity(other.m_parity)
+            , m_snapshot(other.m_snapshot)
+        {
+            other.m_owner = nullptr;
+        }
+        
+        ReadGuard(const ReadGuard&) = delete;
+        ReadGuard& operator=(const ReadGuard&) = delete;
+        ReadGuard& operator=(ReadGuard&&) = delete;
+        
+        const T* get() const { return m_snapshot; }
+        const T* operator->() const { return m_snapshot; }
+        const T& operator*() const { return *m_snapshot; }
+    
+    private:
+        const EpochSnapshot* m_owner;
+        unsigned m_parity;
+        const T* m_snapshot;
+    };
+    
+    explicit EpochSnapshot(std::unique_ptr<T> initial = std::unique_ptr<T>(new T()))
+        : m_current(initial.release())
+        , m_epoch(0)
+    {
+        m_readers[0].store(0, std::memory_order_relaxed);
+        m_readers[1].store(0, std::memory_order_relaxed);
+    }
+    
+    ~EpochSnapshot()
+    {
+        delete m_current.load(std::memory_order_relaxed);
+    }
+    
+    EpochSnapshot(const EpochSnapshot&) = delete;
+    EpochSnapshot& operator=(const EpochSnapshot&) = delete;
+    
+    ReadGuard read() const { return ReadGuard(*this); }
+    
+    /**
+     * @brief Replace the snapshot (writers only, serialised by the caller)
+     * 
+     * Returns once no reader can still reach the previous snapshot, which
+     * has then been deleted.
+     */
+    void publish(std::unique_ptr<T> next)
+    {
+        const T* previous = m_current.exchange(next.release());
+        synchronize();
+        delete previous;
+    }
+    
+private:
+    void synchronize()
+    {
+        for (int flip = 0; flip < 2; ++flip) {
+            const unsigned parity = m_epoch.fetch_add(1) & 1;
+            while (m_readers[parity].load(std::memory_order_acquire) != 0) {
+                std::this_thread::yield();
+            }
+        }
+    }
+    
+    std::atomic<const T*> m_current;
+    std::atomic<unsigned> m_epoch;
+    mutable std::atomic<int> m_readers[2];
+};
+
+#endif // EPOCHSNAPSHOT_H
@@ -6,15 +6,42 @@
 #include "HealthStatusDispatcher.h"
 #include "UdpTelemetryReceiver.h"
 #include "../core/SubsystemNode.h"
+#include "../core/IdInterner.h"
+#include <QHash>
 #include <QMutexLocker>
+#include <memory>
+#include <QThread>
+#include <QTimer>
 #include <QDebug>
 
+namespace {
+
+// Runs on the node's thread, after the node has taken its packets
+void afterDelivery(SubsystemNode* node, StalenessMonitor* monitor, HealthRuleEngine* ruleEngine)
+{
+    if (monitor) {
+        monitor->touch(node->handle());
+    }
+    if (ruleEngine) {
+        ruleEngine->touch(node->handle());
+    }
+}
+
+} // namespace
+
 HealthStatusDispatcher::HealthStatusDispatcher(QObject* parent)
     : QObject(parent)
     , m_receiver(nullptr)
     , m_packetsDispatched(0)
     , m_packetsUnrouted(0)
+    , m_conflationEnabled(false)
+    , m_conflationTimer(new QTimer(this))
 {
+    // ~30 Hz, matching what the operator can actually see
+    m_conflationTimer->setSingleShot(true);
+    m_conflationTimer->setInterval(33);
+    connect(m_conflationTimer, &QTimer::timeout,
+            this, &HealthStatusDispatcher::flushConflatedPackets);
 }
 
 HealthStatusDispatcher::~HealthStatusDispatcher()
@@ -32,12 +59,24 @@ void HealthStatusDispatcher::registerNode(SubsystemNode* node)
     QMutexLocker locker(&m_mutex);
     
     QString nodeId = node->nodeId();
-    if (m_nodeRegistry.contains(nodeId)) {
+    const quint32 handle = node->handle();
+    if (handle == IdInterner::InvalidHandle) {
+        qWarning() << "Cannot register node without a valid ID:" << nodeId;
+        return;
+    }
+    
+    std::unique_ptr<NodeRegistry> registry(new NodeRegistry(*m_nodeRegistry.read()));
+    if (registry->value(handle)) {
         qWarning() << "Node already registered:" << nodeId;
         return;
     }
     
-    m_nodeRegistry[nodeId] = node;
+    if (handle >= static_cast<quint32>(registry->nodes.size())) {
+        registry->nodes.resize(handle + 1);
+    }
+    registry->nodes[handle] = node;
+    registry->count++;
+    m_nodeRegistry.publish(std::move(registry));
     qDebug() << "Registered node for telemetry:" << nodeId << node->nodeName();
 }
 
@@ -52,80 +91,316 @@ void HealthStatusDispatcher::unregisterNode(SubsystemNode* node)
 
 void HealthStatusDispatcher::unregisterNode(const QString& nodeId)
 {
+    const quint32 handle = IdInterner::instance().find(nodeId);
+    
     QMutexLocker locker(&m_mutex);
     
-    if (m_nodeRegistry.remove(nodeId) > 0) {
-        qDebug() << "Unregistered node:" << nodeId;
+    if (!m_nodeRegistry.read()->value(handle)) {
+        return;
     }
+    
+    std::unique_ptr<NodeRegistry> registry(new NodeRegistry(*m_nodeRegistry.read()));
+    registry->nodes[handle] = nullptr;
+    registry->count--;
+    m_nodeRegistry.publish(std::move(registry));
+    qDebug() << "Unregistered node:" << nodeId;
 }
 
 void HealthStatusDispatcher::clearNodes()
 {
     QMutexLocker locker(&m_mutex);
-    m_nodeRegistry.clear();
+    m_nodeRegistry.publish(std::unique_ptr<NodeRegistry>(new NodeRegistry()));
     qDebug() << "Cleared all registered nodes";
 }
 
+SubsystemNode* HealthStatusDispatcher::node(const QString& nodeId) const
+{
+    return node(IdInterner::instance().find(nodeId));
+}
+
+SubsystemNode* HealthStatusDispatcher::node(quint32 handle) const
+{
+    return m_nodeRegistry.read()->value(handle);
+}
+
+int HealthStatusDispatcher::nodeCount() const
+{
+    return m_nodeRegistry.read()->count;
+}
+
 void HealthStatusDispatcher::setTelemetryReceiver(UdpTelemetryReceiver* receiver)
 {
     // Disconnect old receiver
     if (m_receiver) {
-        disconnect(m_receiver, &UdpTelemetryReceiver::telemetryReceived,
-                   this, &HealthStatusDispatcher::handleTelemetryPacket);
+        disconnect(m_receiver, &UdpTelemetryReceiver::telemetryBatchReceived,
+                   this, &HealthStatusDispatcher::handleTelemetryBatch);
     }
     
     m_receiver = receiver;
     
-    // Connect new receiver
+    // Connect new receiver; it already drains its queues on this thread,
+    // so a further queued hop would only copy every packet again
     if (m_receiver) {
-        connect(m_receiver, &UdpTelemetryReceiver::telemetryReceived,
-                this, &HealthStatusDispatcher::handleTelemetryPacket,
-                Qt::QueuedConnection);
+        connect(m_receiver, &UdpTelemetryReceiver::telemetryBatchReceived,
+                this, &HealthStatusDispatcher::handleTelemetryBatch,
+                Qt::AutoConnection);
         qInfo() << "Connected telemetry receiver to dispatcher";
     }
 }
 
+void HealthStatusDispatcher::setStalenessMonitor(StalenessMonitor* monitor)
+{
+    m_stalenessMonitor = monitor;
+}
+
+void HealthStatusDispatcher::setHealthRuleEngine(HealthRuleEngine* engine)
+{
+    m_ruleEngine = engine;
+}
+
+void HealthStatusDispatcher::setConflationEnabled(bool enabled)
+{
+    if (m_conflationEnabled == enabled) {
+        return;
+    }
+    
+    m_conflationEnabled = enabled;
+    
+    // Do not strand packets that were held back
+    if (!enabled) {
+        m_conflationTimer->stop();
+        flushConflatedPackets();
+    }
+    
+    qInfo() << "Telemetry conflation" << (enabled ? "enabled" : "disabled");
+}
+
+void HealthStatusDispatcher::setConflationInterval(int msec)
+{
+    m_conflationTimer->setInterval(qMax(1, msec));
+}
+
+int HealthStatusDispatcher::conflationInterval() const
+{
+    return m_conflationTimer->interval();
+}
+
 void HealthStatusDispatcher::resetStatistics()
 {
-    QMutexLocker locker(&m_mutex);
-    m_packetsDispatched = 0;
-    m_packetsUnrouted = 0;
+    m_packetsDispatched.storeRelaxed(0);
+    m_packetsUnrouted.storeRelaxed(0);
+    m_conflator.resetStatistics();
+    
+    for (ClockSkewStripe& stripe : m_clockSkew) {
+        QMutexLocker locker(&stripe.mutex);
+        stripe.tracker.clear();
+    }
 }
 
-void HealthStatusDispatcher::handleTelemetryPacket(const TelemetryPacket& packet)
+TelemetryStatistics HealthStatusDispatcher::statistics() const
+{
+    TelemetryStatistics stats = m_receiver ? m_receiver->statistics() : TelemetryStatistics();
+    stats.packetsDispatched = m_packetsDispatched.loadRelaxed();
+    stats.packetsUnrouted = m_packetsUnrouted.loadRelaxed();
+    return stats;
+}
+
+HealthStatusDispatcher::ClockSkewStripe& HealthStatusDispatcher::clockSkewStripe(quint32 subsystemHandle) const
+{
+    return m_clockSkew[subsystemHandle & (ClockSkewStripes - 1)];
+}
+
+ClockSkewEstimate HealthStatusDispatcher::clockSkew(const QString& subsystemId) const
+{
+    const quint32 handle = IdInterner::instance().find(subsystemId);
+    ClockSkewStripe& stripe = clockSkewStripe(handle);
+    QMutexLocker locker(&stripe.mutex);
+    return stripe.tracker.estimate(handle);
+}
+
+QMap<QString, ClockSkewEstimate> HealthStatusDispatcher::clockSkewEstimates() const
+{
+    QMap<QString, ClockSkewEstimate> result;
+    for (const ClockSkewStripe& stripe : m_clockSkew) {
+        QMutexLocker locker(&stripe.mutex);
+        result.insert(stripe.tracker.estimates());
+    }
+    return result;
+}
+
+bool HealthStatusDispatcher::acceptPacket(const TelemetryPacket& packet)
 {
     if (!packet.isValid()) {
         qWarning() << "Received invalid telemetry packet";
+        return false;
+    }
+    
+    // Sampled before conflation so every received packet counts; the
+    // stripe lock is only contended by shards carrying the same subsystem.
+    // Packets for IDs no node has are left out (they are unrouted anyway).
+    if (packet.receiveTimestampNs() > 0 && packet.subsystemHandle() != IdInterner::InvalidHandle) {
+        ClockSkewStripe& stripe = clockSkewStripe(packet.subsystemHandle());
+        QMutexLocker locker(&stripe.mutex);
+        stripe.tracker.addSample(packet.subsystemHandle(), packet.timestamp(),
+                                 packet.receiveTimestampNs(), ClockSkewTracker::currentTimeNs());
+    }
+    
+    return true;
+}
+
+void HealthStatusDispatcher::conflatePacket(const TelemetryPacket& packet)
+{
+    m_conflator.add(packet);
+    if (!m_conflationTimer->isActive()) {
+        m_conflationTimer->start();
+    }
+}
+
+void HealthStatusDispatcher::handleTelemetryPacket(const TelemetryPacket& packet)
+{
+    if (!acceptPacket(packet)) {
         return;
     }
     
-    QString subsystemId = packet.subsystemId();
-    SubsystemNode* targetNode = nullptr;
+    if (m_conflationEnabled) {
+        conflatePacket(packet);
+        return;
+    }
     
-    {
-        QMutexLocker locker(&m_mutex);
-        targetNode = m_nodeRegistry.value(subsystemId, nullptr);
+    dispatchPacket(packet);
+}
+
+void HealthStatusDispatcher::handleTelemetryBatch(const QVector<TelemetryPacket>& packets)
+{
+    // Only copy the batch if something has to be filtered out of it
+    QVector<TelemetryPacket> accepted;
+    bool filtered = false;
+    
+    for (int i = 0; i < packets.size(); ++i) {
+        if (acceptPacket(packets[i])) {
+            if (filtered) {
+                accepted.append(packets[i]);
+            }
+        } else if (!filtered) {
+            accepted = packets.mid(0, i);
+            filtered = true;
+        }
+    }
+    
+    const QVector<TelemetryPacket>& batch = filtered ? accepted : packets;
+    
+    if (m_conflationEnabled) {
+        for (const TelemetryPacket& packet : batch) {
+            conflatePacket(packet);
+        }
+        return;
+    }
+    
+    dispatchBatch(batch);
+}
+
+void HealthStatusDispatcher::flushConflatedPackets()
+{
+    dispatchBatch(m_conflator.takePending());
+}
+
+void HealthStatusDispatcher::deliverToNode(SubsystemNode* node, QVector<TelemetryPacket> packets)
+{
+    // Nodes live on the GUI thread alongside the dispatcher; only cross
+    // threads through the event loop when they do not
+    QPointer<StalenessMonitor> monitor = m_stalenessMonitor;
+    QPointer<HealthRuleEngine> ruleEngine = m_ruleEngine;
+    if (node->thread() == QThread::currentThread()) {
+        node->updateHealthBatch(packets);
+        afterDelivery(node, monitor, ruleEngine);
+    } else {
+        QMetaObject::invokeMethod(node, [node, monitor, ruleEngine, packets = std::move(packets)]() {
+            node->updateHealthBatch(packets);
+            afterDelivery(node, monitor, ruleEngine);
+        }, Qt::QueuedConnection);
     }
+}
+
+void HealthStatusDispatcher::dispatchPacket(const TelemetryPacket& packet)
+{
+    QString subsystemId = packet.subsystemId();
+    SubsystemNode* targetNode = m_nodeRegistry.read()->value(packet.subsystemHandle());
     
     if (targetNode) {
-        // Dispatch to node (thread-safe via signal/slot)
-        QMetaObject::invokeMethod(targetNode, [targetNode, packet]() {
+        QPointer<StalenessMonitor> monitor = m_stalenessMonitor;
+        QPointer<HealthRuleEngine> ruleEngine = m_ruleEngine;
+        if (targetNode->thread() == QThread::currentThread()) {
             targetNode->updateHealth(packet);
-        }, Qt::QueuedConnection);
-        
-        {
-            QMutexLocker locker(&m_mutex);
-            m_packetsDispatched++;
+            afterDelivery(targetNode, monitor, ruleEngine);
+        } else {
+            QMetaObject::invokeMethod(targetNode, [targetNode, monitor, ruleEngine, packet]() {
+                targetNode->updateHealth(packet);
+                afterDelivery(targetNode, monitor, ruleEngine);
+            }, Qt::QueuedConnection);
         }
         
+        m_packetsDispatched.fetchAndAddRelaxed(1);
+        
         emit packetDispatched(subsystemId, packet);
     } else {
-        {
-            QMutexLocker locker(&m_mutex);
-            m_packetsUnrouted++;
-        }
+        m_packetsUnrouted.fetchAndAddRelaxed(1);
         
         qDebug() << "No registered node for subsystem:" << subsystemId;
         emit unroutedPacket(packet);
     }
 }
+
+void HealthStatusDispatcher::dispatchBatch(const QVector<TelemetryPacket>& packets)
+{
+    if (packets.isEmpty()) {
+        return;
+    }
+    
+    if (packets.size() == 1) {
+        dispatchPacket(packets.first());
+        return;
+    }
+    
+    // Group by target node in order of first appearance; each node's packets
+    // keep their arrival order. The registry guard is released before any
+    // node code runs, since a node may edit the registry in response.
+    QVector<SubsystemNode*> targets(packets.size(), nullptr);
+    QVector<NodeBatch> batches;
+    
+    {
+        auto registry = m_nodeRegistry.read();
+        QHash<SubsystemNode*, int> batchIndex;
+        
+        for (int i = 0; i < packets.size(); ++i) {
+            SubsystemNode* node = registry->value(packets[i].subsystemHandle());
+            targets[i] = node;
+            if (!node) {
+                continue;
+            }
+            
+            auto it = batchIndex.constFind(node);
+            if (it == batchIndex.constEnd()) {
+                it = batchIndex.insert(node, batches.size());
+                batches.append(NodeBatch{node, QVector<TelemetryPacket>()});
+            }
+            batches[it.value()].packets.append(packets[i]);
+        }
+    }
+    
+    for (NodeBatch& batch : batches) {
+        m_packetsDispatched.fetchAndAddRelaxed(batch.packets.size());
+        deliverToNode(batch.node, std::move(batch.packets));
+    }
+    
+    for (int i = 0; i < packets.size(); ++i) {
+        const TelemetryPacket& packet = packets[i];
+        if (targets[i]) {
+            emit packetDispatched(packet.subsystemId(), packet);
+        } else {
+            m_packetsUnrouted.fetchAndAddRelaxed(1);
+            
+            qDebug() << "No registered node for subsystem:" << packet.subsystemId();
+            emit unroutedPacket(packet);
+        }
+    }
+}
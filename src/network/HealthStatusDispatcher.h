@@ -9,8 +9,18 @@
 #include <QObject>
 #include <QMap>
 #include <QMutex>
+#include <QVector>
+#include <QAtomicInteger>
+#include <QPointer>
 #include "../core/TelemetryPacket.h"
+#include "TelemetryConflator.h"
+#include "ClockSkewTracker.h"
+#include "TelemetryStatistics.h"
+#include "EpochSnapshot.h"
+#include "StalenessMonitor.h"
+#include "../core/HealthRuleEngine.h"
 
+class QTimer;
 class SubsystemNode;
 class UdpTelemetryReceiver;
 
@@ -20,6 +30,30 @@ class UdpTelemetryReceiver;
  * 
  * Routes incoming telemetry packets to the appropriate subsystem nodes
  * based on subsystem ID. Maintains registry of active nodes.
+ * 
+ * With conflation enabled, packets are held per subsystem and only the
+ * newest one (per health code) is dispatched when the conflation timer
+ * fires, which bounds node updates to roughly the display refresh rate.
+ * 
+ * Every packet with a receive timestamp also feeds a per-subsystem clock
+ * skew estimate, separating network delay from local processing delay.
+ * 
+ * The node registry only changes when the operator edits the graph, so it
+ * is published as an immutable snapshot: routing a packet is an atomic
+ * pointer load and an array index by the packet's interned subsystem
+ * handle, and registration copies the table and swaps it in. Counters
+ * are atomic and clock skew state is striped by subsystem, so receive
+ * shards calling handleTelemetryPacket() directly (with conflation
+ * disabled) do not serialise on a dispatcher lock.
+ * 
+ * handleTelemetryBatch() takes a whole receiver drain (or conflation
+ * flush), groups it by target node and hands each node its packets in one
+ * updateHealthBatch() call, so a node reporting at high rate costs one
+ * update per drain instead of one per packet, and one notification unless
+ * its health code changes within the drain.
+ * 
+ * Every delivery also touches the StalenessMonitor and HealthRuleEngine,
+ * if set, on the node's thread.
  */
 class HealthStatusDispatcher : public QObject
 {
@@ -34,14 +68,36 @@ public:
     void unregisterNode(SubsystemNode* node);
     void unregisterNode(const QString& nodeId);
     void clearNodes();
+    SubsystemNode* node(const QString& nodeId) const;
+    SubsystemNode* node(quint32 handle) const;
+    int nodeCount() const;
     
     // Telemetry receiver integration
     void setTelemetryReceiver(UdpTelemetryReceiver* receiver);
     UdpTelemetryReceiver* telemetryReceiver() const { return m_receiver; }
     
-    // Statistics
-    quint64 packetsDispatched() const { return m_packetsDispatched; }
-    quint64 packetsUnrouted() const { return m_packetsUnrouted; }
+    // Must live on the nodes' thread
+    void setStalenessMonitor(StalenessMonitor* monitor);
+    StalenessMonitor* stalenessMonitor() const { return m_stalenessMonitor; }
+    void setHealthRuleEngine(HealthRuleEngine* engine);
+    HealthRuleEngine* healthRuleEngine() const { return m_ruleEngine; }
+    
+    // Latest-wins conflation between dispatches
+    void setConflationEnabled(bool enabled);
+    bool isConflationEnabled() const { return m_conflationEnabled; }
+    void setConflationInterval(int msec);
+    int conflationInterval() const;
+    
+    // Statistics; statistics() adds the receiver's counters when one is set
+    TelemetryStatistics statistics() const;
+    quint64 packetsDispatched() const { return m_packetsDispatched.loadRelaxed(); }
+    quint64 packetsUnrouted() const { return m_packetsUnrouted.loadRelaxed(); }
+    quint64 packetsConflated() const { return m_conflator.packetsConflated(); }
+    quint64 packetsForwarded() const { return m_conflator.packetsForwarded(); }
+    
+    // Ingest latency per subsystem
+    ClockSkewEstimate clockSkew(const QString& subsystemId) const;
+    QMap<QString, ClockSkewEstimate> clockSkewEstimates() const;
     void resetStatistics();
     
 signals:
@@ -50,13 +106,58 @@ signals:
     
 public slots:
     void handleTelemetryPacket(const TelemetryPacket& packet);
+    void handleTelemetryBatch(const QVector<TelemetryPacket>& packets);
+    
+private slots:
+    void flushConflatedPackets();
     
 private:
-    QMap<QString, SubsystemNode*> m_nodeRegistry;
-    UdpTelemetryReceiver* m_receiver;
-    quint64 m_packetsDispatched;
-    quint64 m_packetsUnrouted;
+    // Indexed by interned node handle; holes are nullptr
+    struct NodeRegistry {
+        QVector<SubsystemNode*> nodes;
+        int count = 0;
+        
+        SubsystemNode* value(quint32 handle) const
+        {
+            return handle < static_cast<quint32>(nodes.size()) ? nodes.at(handle) : nullptr;
+        }
+    };
+    
+    // Power of two; a subsystem always maps to the same stripe
+    static constexpr int ClockSkewStripes = 16;
+    
+    struct ClockSkewStripe {
+        mutable QMutex mutex;
+        ClockSkewTracker tracker;
+    };
+    
+    struct NodeBatch {
+        SubsystemNode* node;
+        QVector<TelemetryPacket> packets;
+    };
+    
+    bool acceptPacket(const TelemetryPacket& packet);
+    void conflatePacket(const TelemetryPacket& packet);
+    void dispatchPacket(const TelemetryPacket& packet);
+    void dispatchBatch(const QVector<TelemetryPacket>& packets);
+    void deliverToNode(SubsystemNode* node, QVector<TelemetryPacket> packets);
+    ClockSkewStripe& clockSkewStripe(quint32 subsystemHandle) const;
+    
+    // Readers are lock-free; m_mutex serialises registry writers only
+    EpochSnapshot<NodeRegistry> m_nodeRegistry;
     mutable QMutex m_mutex;
+    
+    UdpTelemetryReceiver* m_receiver;
+    QPointer<StalenessMonitor> m_stalenessMonitor;
+    QPointer<HealthRuleEngine> m_ruleEngine;
+    QAtomicInteger<quint64> m_packetsDispatched;
+    QAtomicInteger<quint64> m_packetsUnrouted;
+    mutable ClockSkewStripe m_clockSkew[ClockSkewStripes];
+    
+    // Conflation stage (dispatcher thread only)
+    bool m_conflationEnabled;
+    TelemetryConflator m_conflator;
+    QTimer* m_conflationTimer;
 };
 
 #endif // HEALTHSTATUSDISPATCHER_H
@@ -0,0 +1,263 @@
+/**
+ * @file StalenessMonitor.cpp
+ * @brief Implementation of the telemetry staleness monitor
+ */
+
+#include "StalenessMonitor.h"
+#include "../core/SubsystemNode.h"
+#include "../core/IdInterner.h"
+#include <QTimer>
+#include <QDebug>
+#include <algorithm>
+
+StalenessMonitor::StalenessMonitor(QObject* parent)
+    : QObject(parent)
+    , m_watchedCount(0)
+    , m_scheduledCount(0)
+    , m_expirations(0)
+    , m_currentTick(0)
+    , m_timer(new QTimer(this))
+{
+    std::fill(std::begin(m_heads), std::end(m_heads), NoEntry);
+    m_clock.start();
+    
+    m_timer->setInterval(TickMs);
+    connect(m_timer, &QTimer::timeout, this, &StalenessMonitor::tick);
+}
+
+StalenessMonitor::~StalenessMonitor()
+{
+}
+
+void StalenessMonitor::watch(SubsystemNode* node)
+{
+    if (!node) {
+        return;
+    }
+    
+    const quint32 handle = node->handle();
+    if (handle == IdInterner::InvalidHandle) {
+        qWarning() << "Cannot watch node without a valid ID:" << node->nodeId();
+        return;
+    }
+    
+    if (handle >= quint32(m_entries.size())) {
+        m_entries.resize(int(handle) + 1);
+    }
+    
+    Entry& entry = m_entries[int(handle)];
+    if (!entry.watched) {
+        entry.watched = true;
+        m_watchedCount++;
+    }
+    entry.node = node;
+    entry.timeoutMs = timeout(node->subsystemType());
+}
+
+void StalenessMonitor::unwatch(const QString& nodeId)
+{
+    const quint32 handle = IdInterner::instance().find(nodeId);
+    if (handle >= quint32(m_entries.size()) || !m_entries[int(handle)].watched) {
+        return;
+    }
+    
+    unlink(int(handle));
+    m_entries[int(handle)] = Entry();
+    m_watchedCount--;
+}
+
+void StalenessMonitor::clear()
+{
+    m_timer->stop();
+    m_entries.clear();
+    std::fill(std::begin(m_heads), std::end(m_heads), NoEntry);
+    m_watchedCount = 0;
+    m_scheduledCount = 0;
+}
+
+void StalenessMonitor::touch(quint32 handle)
+{
+    if (handle >= quint32(m_entries.size())) {
+        return;
+    }
+    
+    Entry& entry = m_entries[int(handle)];
+    if (!entry.watched) {
+        return;
+    }
+    
+    // Scheduled entries pick the new time up when their slot comes round
+    entry.lastSeenMs = m_clock.elapsed();
+    if (entry.slot == NoEntry) {
+        schedule(int(handle), entry.lastSeenMs + entry.timeoutMs);
+    }
+}
+
+void StalenessMonitor::setTimeout(const QString& subsystemType, qint64 msec)
+{
+    msec = qBound(MinTimeoutMs, msec, MaxTimeoutMs);
+    m_timeouts.insert(subsystemType, msec);
+    
+    // A shorter timeout must not wait for a deadline computed with the old one
+    for (int handle = 0; handle < m_entries.size(); ++handle) {
+        Entry& entry = m_entries[handle];
+        if (!entry.node || entry.node->subsystemType() != subsystemType) {
+            continue;
+        }
+        entry.timeoutMs = msec;
+        if (entry.slot != NoEntry) {
+            unlink(handle);
+            schedule(handle, entry.lastSeenMs + msec);
+        }
+    }
+}
+
+qint64 StalenessMonitor::timeout(const QString& subsystemType) const
+{
+    return m_timeouts.value(subsystemType, DefaultTimeoutMs);
+}
+
+void StalenessMonitor::schedule(int handle, qint64 deadlineMs)
+{
+    // After an idle spell, skip the ticks that had nothing to do
+    if (!m_timer->isActive()) {
+        m_currentTick = m_clock.elapsed() / TickMs;
+        m_timer->start();
+    }
+    
+    Entry& entry = m_entries[handle];
+    entry.deadlineTick = qMax(m_currentTick + 1, (deadlineMs + TickMs - 1) / TickMs);
+    link(handle);
+}
+
+void StalenessMonitor::link(int handle)
+{
+    Entry& entry = m_entries[handle];
+    const qint64 delta = entry.deadlineTick - m_currentTick;
+    
+    int slot;
+    if (delta < InnerSlots) {
+        slot = int(entry.deadlineTick & (InnerSlots - 1));
+    } else if (delta < InnerSlots * OuterSlots) {
+        slot = InnerSlots + int((entry.deadlineTick >> InnerBits) & (OuterSlots - 1));
+    } else {
+        // Beyond the wheel: wait at the far end and re-check from there
+        entry.deadlineTick = qMin(entry.deadlineTick,
+                                  m_currentTick + qint64(InnerSlots) * OuterSlots * OuterSlots - 1);
+        slot = InnerSlots + OuterSlots
+               + int((entry.deadlineTick >> (InnerBits + OuterBits)) & (OuterSlots - 1));
+    }
+    
+    entry.slot = slot;
+    entry.prev = NoEntry;
+    entry.next = m_heads[slot];
+    if (entry.next != NoEntry) {
+        m_entries[entry.next].prev = handle;
+    }
+    m_heads[slot] = handle;
+    m_scheduledCount++;
+}
+
+void StalenessMonitor::unlink(int handle)
+{
+    Entry& entry = m_entries[handle];
+    if (entry.slot == NoEntry) {
+        return;
+    }
+    
+    if (entry.prev != NoEntry) {
+        m_entries[entry.prev].next = entry.next;
+    } else {
+        m_heads[entry.slot] = entry.next;
+    }
+    if (entry.next != NoEntry) {
+        m_entries[entry.next].prev = entry.prev;
+    }
+    
+    entry.slot = NoEntry;
+    entry.prev = NoEntry;
+    entry.next = NoEntry;
+    m_scheduledCount--;
+}
+
+QVector<int> StalenessMonitor::takeSlot(int slot)
+{
+    QVector<int> handles;
+    for (int handle = m_heads[slot]; handle != NoEntry; ) {
+        Entry& entry = m_entries[handle];
+        const int next = entry.next;
+        entry.slot = NoEntry;
+        entry.prev = NoEntry;
+        entry.next = NoEntry;
+        handles.append(handle);
+        handle = next;
+    }
+    
+    m_heads[slot] = NoEntry;
+    m_scheduledCount -= handles.size();
+    return handles;
+}
+
+void StalenessMonitor::tick()
+{
+    const qint64 targetTick = m_clock.elapsed() / TickMs;
+    
+    while (m_currentTick < targetTick && m_scheduledCount > 0) {
+        const qint64 tick = ++m_currentTick;
+        
+        // Bring the outer slots that are now within reach one level in
+        if ((tick & (InnerSlots - 1)) == 0) {
+            const int middle = int((tick >> InnerBits) & (OuterSlots - 1));
+            if (middle == 0) {
+                const int outer = int((tick >> (InnerBits + OuterBits)) & (OuterSlots - 1));
+                for (int handle : takeSlot(InnerSlots + OuterSlots + outer)) {
+                    link(handle);
+                }
+            }
+            for (int handle : takeSlot(InnerSlots + middle)) {
+                link(handle);
+            }
+        }
+        
+        for (int handle : takeSlot(int(tick & (InnerSlots - 1)))) {
+            // An earlier expiry's listeners may have changed this entry already
+            if (handle >= m_entries.size() || m_entries[handle].slot != NoEntry) {
+                continue;
+            }
+            
+            Entry& entry = m_entries[handle];
+            if (!entry.watched) {
+                continue;
+            }
+            if (!entry.node) {
+                // Deleted without being unwatched
+                entry = Entry();
+                m_watchedCount--;
+                continue;
+            }
+            
+            const qint64 deadlineMs = entry.lastSeenMs + entry.timeoutMs;
+            if (deadlineMs > tick * TickMs) {
+                schedule(handle, deadlineMs);
+            } else {
+                expire(handle);
+            }
+        }
+    }
+    
+    if (m_scheduledCount == 0) {
+        m_timer->stop();
+    }
+}
+
+void StalenessMonitor::expire(int handle)
+{
+    SubsystemNode* node = m_entries[handle].node;
+    const qint64 silentMs = m_clock.elapsed() - m_entries[handle].lastSeenMs;
+    m_expirations++;
+    
+    // Listeners may watch or unwatch nodes, so no entry reference is held here
+    node->updateHealth(HealthCode::OFFLINE,
+                       QString("No telemetry for %1 s").arg(silentMs / 1000.0, 0, 'f', 1));
+    emit nodeStale(node, silentMs);
+}
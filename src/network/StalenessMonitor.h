@@ -0,0 +1,109 @@
+/**
+ * @file StalenessMonitor.h
+ * @brief Detects subsystems that stopped sending telemetry
+ */
+
+#ifndef STALENESSMONITOR_H
+#define STALENESSMONITOR_H
+
+#include <QObject>
+#include <QHash>
+#include <QPointer>
+#include <QVector>
+#include <QElapsedTimer>
+
+class QTimer;
+class SubsystemNode;
+
+/**
+ * @class StalenessMonitor
+ * @brief Hierarchical timer wheel that moves silent nodes to OFFLINE
+ * 
+ * touch() only stores the arrival time of a node's latest telemetry, so
+ * it costs the same however often a node reports. Each reporting node
+ * also has one entry in the wheel at its last known deadline. When that
+ * slot comes round, the entry either moves to the deadline implied by
+ * the node's latest arrival or, if there is none newer, takes the node
+ * to HealthCode::OFFLINE. A tick therefore costs one step per entry that
+ * is due, not one per node.
+ * 
+ * The wheel has three levels: 256 slots of TickMs, then 64 slots each for
+ * the next two levels. Far deadlines wait on an outer level and move
+ * inward as the wheel turns. The timer only runs while some entry is
+ * scheduled.
+ * 
+ * Nodes that have never reported are not timed. An expired node is timed
+ * again from its next packet. Timeouts are per subsystem type.
+ * 
+ * Single-threaded: call from the thread the nodes live on.
+ */
+class StalenessMonitor : public QObject
+{
+    Q_OBJECT
+    
+public:
+    static constexpr int TickMs = 100;
+    static constexpr qint64 DefaultTimeoutMs = 5000;
+    static constexpr qint64 MinTimeoutMs = TickMs;
+    static constexpr qint64 MaxTimeoutMs = qint64(24) * 3600 * 1000;
+    
+    explicit StalenessMonitor(QObject* parent = nullptr);
+    ~StalenessMonitor();
+    
+    void watch(SubsystemNode* node);
+    void unwatch(const QString& nodeId);
+    void clear();
+    int watchedCount() const { return m_watchedCount; }
+    
+    // A packet for the node with this handle has just been delivered
+    void touch(quint32 handle);
+    
+    void setTimeout(const QString& subsystemType, qint64 msec);
+    qint64 timeout(const QString& subsystemType) const;
+    
+    quint64 expirations() const { return m_expirations; }
+    
+signals:
+    void nodeStale(SubsystemNode* node, qint64 silentMs);
+    
+private slots:
+    void tick();
+    
+private:
+    static constexpr int InnerBits = 8;
+    static constexpr int OuterBits = 6;
+    static constexpr int InnerSlots = 1 << InnerBits;
+    static constexpr int OuterSlots = 1 << OuterBits;
+    static constexpr int SlotCount = InnerSlots + 2 * OuterSlots;
+    static constexpr int NoEntry = -1;
+    
+    struct Entry {
+        QPointer<SubsystemNode> node;
+        qint64 lastSeenMs = 0;
+        qint64 timeoutMs = DefaultTimeoutMs;
+        qint64 deadlineTick = 0;
+        int slot = NoEntry;         ///< NoEntry while not scheduled
+        int prev = NoEntry;
+        int next = NoEntry;
+        bool watched = false;
+    };
+    
+    void schedule(int handle, qint64 deadlineMs);
+    void link(int handle);
+    void unlink(int handle);
+    QVector<int> takeSlot(int slot);
+    void expire(int handle);
+    
+    QVector<Entry> m_entries;       ///< Indexed by interned node handle
+    int m_heads[SlotCount];
+    QHash<QString, qint64> m_timeouts;
+    int m_watchedCount;
+    int m_scheduledCount;
+    quint64 m_expirations;
+    
+    QElapsedTimer m_clock;
+    qint64 m_currentTick;
+    QTimer* m_timer;
+};
+
+#endif // STALENESSMONITOR_H
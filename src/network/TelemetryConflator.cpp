@@ -0,0 +1,61 @@
+/**
+ * @file TelemetryConflator.cpp
+ * @brief Implementation of per-subsystem telemetry conflation
+ */
+
+#include "TelemetryConflator.h"
+#include "../core/IdInterner.h"
+
+TelemetryConflator::TelemetryConflator()
+    : m_packetsConflated(0)
+    , m_packetsForwarded(0)
+{
+}
+
+bool TelemetryConflator::add(const TelemetryPacket& packet)
+{
+    // Without a handle the subsystem cannot be told apart; pass it through
+    const quint32 handle = packet.subsystemHandle();
+    if (handle == IdInterner::InvalidHandle) {
+        m_pending.append(packet);
+        return false;
+    }
+    
+    auto it = m_latestIndex.find(handle);
+    
+    if (it != m_latestIndex.end()) {
+        TelemetryPacket& latest = m_pending[it.value()];
+        if (latest.healthCode() == packet.healthCode()) {
+            latest = packet;
+            m_packetsConflated++;
+            return true;
+        }
+    }
+    
+    // New subsystem or a health-code transition: keep it as its own entry
+    m_latestIndex.insert(handle, m_pending.size());
+    m_pending.append(packet);
+    return false;
+}
+
+QVector<TelemetryPacket> TelemetryConflator::takePending()
+{
+    QVector<TelemetryPacket> pending;
+    pending.swap(m_pending);
+    m_latestIndex.clear();
+    
+    m_packetsForwarded += pending.size();
+    return pending;
+}
+
+void TelemetryConflator::clear()
+{
+    m_pending.clear();
+    m_latestIndex.clear();
+}
+
+void TelemetryConflator::resetStatistics()
+{
+    m_packetsConflated = 0;
+    m_packetsForwarded = 0;
+}
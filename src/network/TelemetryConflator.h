@@ -0,0 +1,55 @@
+/**
+ * @file TelemetryConflator.h
+ * @brief Latest-wins conflation of telemetry packets per subsystem
+ */
+
+#ifndef TELEMETRYCONFLATOR_H
+#define TELEMETRYCONFLATOR_H
+
+#include <QHash>
+#include <QString>
+#include <QVector>
+#include "../core/TelemetryPacket.h"
+
+/**
+ * @class TelemetryConflator
+ * @brief Keeps only the newest packet per subsystem between drains
+ * 
+ * A packet replaces the subsystem's pending packet only when both carry
+ * the same health code. A packet with a different code is queued behind
+ * it instead, so every health-code transition survives conflation.
+ * Pending packets are drained in first-touched order.
+ * 
+ * Not thread-safe; intended to be owned by a single dispatcher thread.
+ */
+class TelemetryConflator
+{
+public:
+    TelemetryConflator();
+    
+    /**
+     * @brief Queue a packet, merging it into the pending one if possible
+     * @return true if the packet replaced an already pending packet
+     */
+    bool add(const TelemetryPacket& packet);
+    
+    // Remove and return all pending packets
+    QVector<TelemetryPacket> takePending();
+    
+    int pendingCount() const { return m_pending.size(); }
+    bool hasPending() const { return !m_pending.isEmpty(); }
+    void clear();
+    
+    // Statistics
+    quint64 packetsConflated() const { return m_packetsConflated; }
+    quint64 packetsForwarded() const { return m_packetsForwarded; }
+    void resetStatistics();
+    
+private:
+    QVector<TelemetryPacket> m_pending;
+    QHash<quint32, int> m_latestIndex;  ///< Subsystem handle -> newest pending slot
+    quint64 m_packetsConflated;
+    quint64 m_packetsForwarded;
+};
+
+#endif // TELEMETRYCONFLATOR_H
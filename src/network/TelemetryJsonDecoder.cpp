@@ -0,0 +1,493 @@
+/**
+ * @file TelemetryJsonDecoder.cpp
+ * @brief Implementation of the single-pass telemetry JSON decoder
+ */
+
+#include "TelemetryJsonDecoder.h"
+#include <QtAlgorithms>
+#include <limits>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+enum class Field {
+    Unknown,
+    SubsystemId,
+    HealthCode,
+    HealthMessage,
+    Timestamp,
+    Parameters
+};
+
+inline bool isJsonSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+inline bool isDigit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+inline bool isHexDigit(char c)
+{
+    return isDigit(c) || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+}
+
+inline int hexValue(char c)
+{
+    if (isDigit(c)) {
+        return c - '0';
+    }
+    return (c | 0x20) - 'a' + 10;
+}
+
+// Bytes the string scanner must stop at: quote, backslash, control
+// characters and anything outside ASCII (left to the validating parser)
+inline bool isStringStop(char c)
+{
+    const quint8 byte = static_cast<quint8>(c);
+    return c == '"' || c == '\\' || byte < 0x20 || byte >= 0x80;
+}
+
+const char* findStringStop(const char* pos, const char* end)
+{
+#if defined(__SSE2__)
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i space = _mm_set1_epi8(0x20);
+    
+    while (end - pos >= 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pos));
+        // Signed compare: bytes >= 0x80 are negative and count as below 0x20
+        __m128i hits = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, quote),
+                                                 _mm_cmpeq_epi8(chunk, backslash)),
+                                    _mm_cmplt_epi8(chunk, space));
+        int mask = _mm_movemask_epi8(hits);
+        if (mask != 0) {
+            return pos + qCountTrailingZeroBits(static_cast<quint32>(mask));
+        }
+        pos += 16;
+    }
+#endif
+    
+    while (pos < end && !isStringStop(*pos)) {
+        ++pos;
+    }
+    return pos;
+}
+
+// Unescape a string body already validated by JsonCursor::readString()
+QString decodeString(QByteArrayView raw, bool escaped)
+{
+    if (!escaped) {
+        return QString::fromLatin1(raw.data(), raw.size());
+    }
+    
+    QString result;
+    result.reserve(raw.size());
+    
+    const char* pos = raw.data();
+    const char* end = pos + raw.size();
+    while (pos < end) {
+        if (*pos != '\\') {
+            result.append(QLatin1Char(*pos++));
+            continue;
+        }
+        
+        ++pos;
+        switch (*pos++) {
+            case 'b': result.append(QLatin1Char('\b')); break;
+            case 'f': result.append(QLatin1Char('\f')); break;
+            case 'n': result.append(QLatin1Char('\n')); break;
+            case 'r': result.append(QLatin1Char('\r')); break;
+            case 't': result.append(QLatin1Char('\t')); break;
+            case 'u': {
+                // UTF-16 code unit; surrogate pairs arrive as two escapes
+                char16_t unit = 0;
+                for (int i = 0; i < 4; ++i) {
+                    unit = static_cast<char16_t>((unit << 4) | hexValue(*pos++));
+                }
+                result.append(QChar(unit));
+                break;
+            }
+            default:
+                // '"', '\\' and '/'
+                result.append(QLatin1Char(pos[-1]));
+                break;
+        }
+    }
+    
+    return result;
+}
+
+Field fieldFor(QByteArrayView raw, bool escaped)
+{
+    QByteArray decoded;
+    if (escaped) {
+        decoded = decodeString(raw, true).toUtf8();
+        raw = decoded;
+    }
+    
+    if (raw == "subsystem_id") {
+        return Field::SubsystemId;
+    }
+    if (raw == "health_code") {
+        return Field::HealthCode;
+    }
+    if (raw == "health_message") {
+        return Field::HealthMessage;
+    }
+    if (raw == "timestamp") {
+        return Field::Timestamp;
+    }
+    if (raw == "parameters") {
+        return Field::Parameters;
+    }
+    return Field::Unknown;
+}
+
+// QJsonValue::toString()/toInt()/toDouble() semantics for decoded scalars
+QString toJsonString(const QVariant& value)
+{
+    return value.typeId() == QMetaType::QString ? value.toString() : QString();
+}
+
+int toJsonInt(const QVariant& value)
+{
+    if (value.typeId() == QMetaType::LongLong) {
+        qlonglong number = value.toLongLong();
+        return qlonglong(int(number)) == number ? int(number) : 0;
+    }
+    if (value.typeId() == QMetaType::Double) {
+        double number = value.toDouble();
+        if (number >= std::numeric_limits<int>::min()
+            && number <= std::numeric_limits<int>::max()
+            && double(int(number)) == number) {
+            return int(number);
+        }
+    }
+    return 0;
+}
+
+double toJsonDouble(const QVariant& value)
+{
+    if (value.typeId() == QMetaType::LongLong || value.typeId() == QMetaType::Double) {
+        return value.toDouble();
+    }
+    return 0.0;
+}
+
+/**
+ * Forward-only reader over the datagram bytes. Every read returns false
+ * on malformed input or on a construct the fast path does not handle.
+ */
+class JsonCursor
+{
+public:
+    JsonCursor(const char* begin, const char* end)
+        : m_pos(begin)
+        , m_end(end)
+    {
+    }
+    
+    void skipWhitespace()
+    {
+        while (m_pos < m_end && isJsonSpace(*m_pos)) {
+            ++m_pos;
+        }
+    }
+    
+    bool atEnd()
+    {
+        skipWhitespace();
+        return m_pos == m_end;
+    }
+    
+    char peek()
+    {
+        skipWhitespace();
+        return m_pos < m_end ? *m_pos : '\0';
+    }
+    
+    bool consume(char c)
+    {
+        if (peek() != c) {
+            return false;
+        }
+        ++m_pos;
+        return true;
+    }
+    
+    bool readString(QByteArrayView& raw, bool& escaped)
+    {
+        if (!consume('"')) {
+            return false;
+        }
+        
+        const char* begin = m_pos;
+        escaped = false;
+        
+        while (true) {
+            m_pos = findStringStop(m_pos, m_end);
+            if (m_pos == m_end) {
+                return false;
+            }
+            
+            if (*m_pos == '"') {
+                raw = QByteArrayView(begin, m_pos - begin);
+                ++m_pos;
+                return true;
+            }
+            
+            if (*m_pos != '\\' || !skipEscape()) {
+                return false;
+            }
+            escaped = true;
+        }
+    }
+    
+    bool readScalar(QVariant& value)
+    {
+        switch (peek()) {
+            case '"': {
+                QByteArrayView raw;
+                bool escaped = false;
+                if (!readString(raw, escaped)) {
+                    return false;
+                }
+                value = decodeString(raw, escaped);
+                return true;
+            }
+            case 't':
+                value = true;
+                return readLiteral("true");
+            case 'f':
+                value = false;
+                return readLiteral("false");
+            case 'n':
+                value = QVariant::fromValue(nullptr);
+                return readLiteral("null");
+            case '{':
+            case '[':
+                // Nested values are left to QJsonDocument
+                return false;
+            default:
+                return readNumber(value);
+        }
+    }
+    
+private:
+    bool skipEscape()
+    {
+        // m_pos is on the backslash
+        if (m_end - m_pos < 2) {
+            return false;
+        }
+        
+        switch (m_pos[1]) {
+            case '"': case '\\': case '/':
+            case 'b': case 'f': case 'n': case 'r': case 't':
+                m_pos += 2;
+                return true;
+            case 'u':
+                if (m_end - m_pos < 6) {
+                    return false;
+                }
+                for (int i = 2; i < 6; ++i) {
+                    if (!isHexDigit(m_pos[i])) {
+                        return false;
+                    }
+                }
+                m_pos += 6;
+                return true;
+            default:
+                return false;
+        }
+    }
+    
+    bool readLiteral(const char* literal)
+    {
+        for (; *literal; ++literal, ++m_pos) {
+            if (m_pos == m_end || *m_pos != *literal) {
+                return false;
+            }
+        }
+        return true;
+    }
+    
+    bool readDigits()
+    {
+        if (m_pos == m_end || !isDigit(*m_pos)) {
+            return false;
+        }
+        while (m_pos < m_end && isDigit(*m_pos)) {
+            ++m_pos;
+        }
+        return true;
+    }
+    
+    bool readNumber(QVariant& value)
+    {
+        const char* begin = m_pos;
+        bool integral = true;
+        
+        if (m_pos < m_end && *m_pos == '-') {
+            ++m_pos;
+        }
+        if (m_pos < m_end && *m_pos == '0') {
+            ++m_pos;
+        } else if (!readDigits()) {
+            return false;
+        }
+        
+        if (m_pos < m_end && *m_pos == '.') {
+            integral = false;
+            ++m_pos;
+            if (!readDigits()) {
+                return false;
+            }
+        }
+        
+        if (m_pos < m_end && (*m_pos == 'e' || *m_pos == 'E')) {
+            integral = false;
+            ++m_pos;
+            if (m_pos < m_end && (*m_pos == '+' || *m_pos == '-')) {
+                ++m_pos;
+            }
+            if (!readDigits()) {
+                return false;
+            }
+        }
+        
+        // Locale-independent conversion straight from the datagram bytes;
+        // integral literals stay integers as they do in QJsonValue
+        const QByteArray text = QByteArray::fromRawData(begin, m_pos - begin);
+        bool ok = false;
+        
+        if (integral) {
+            qlonglong number = text.toLongLong(&ok);
+            if (ok) {
+                value = number;
+                return true;
+            }
+        }
+        
+        double number = text.toDouble(&ok);
+        if (!ok) {
+            return false;
+        }
+        value = number;
+        return true;
+    }
+    
+    const char* m_pos;
+    const char* m_end;
+};
+
+bool readParameters(JsonCursor& cursor, TelemetryPacket& packet)
+{
+    if (!cursor.consume('{')) {
+        return false;
+    }
+    if (cursor.consume('}')) {
+        return true;
+    }
+    
+    do {
+        QByteArrayView key;
+        bool escaped = false;
+        QVariant value;
+        
+        if (!cursor.readString(key, escaped) || !cursor.consume(':')
+            || !cursor.readScalar(value)) {
+            return false;
+        }
+        packet.addParameter(decodeString(key, escaped), value);
+    } while (cursor.consume(','));
+    
+    return cursor.consume('}');
+}
+
+} // namespace
+
+bool TelemetryJsonDecoder::decode(QByteArrayView json, TelemetryPacket& packet)
+{
+    JsonCursor cursor(json.data(), json.data() + json.size());
+    if (!cursor.consume('{')) {
+        return false;
+    }
+    
+    // Absent fields decode the way QJsonValue defaults them
+    TelemetryPacket decoded;
+    decoded.setHealthCode(static_cast<HealthCode>(0));
+    
+    if (!cursor.consume('}')) {
+        do {
+            QByteArrayView key;
+            bool escaped = false;
+            if (!cursor.readString(key, escaped) || !cursor.consume(':')) {
+                return false;
+            }
+            
+            const Field field = fieldFor(key, escaped);
+            
+            if (field == Field::Parameters) {
+                // Duplicate keys: the last occurrence wins, as in QJsonObject
+                decoded.clearParameters();
+                if (cursor.peek() == '{') {
+                    if (!readParameters(cursor, decoded)) {
+                        return false;
+                    }
+                    continue;
+                }
+            }
+            
+            QVariant value;
+            if (!cursor.readScalar(value)) {
+                return false;
+            }
+            
+            switch (field) {
+                case Field::SubsystemId:
+                    decoded.setSubsystemId(toJsonString(value));
+                    break;
+                case Field::HealthCode:
+                    decoded.setHealthCode(static_cast<HealthCode>(toJsonInt(value)));
+                    break;
+                case Field::HealthMessage:
+                    decoded.setHealthMessage(toJsonString(value));
+                    break;
+                case Field::Timestamp:
+                    decoded.setTimestamp(static_cast<qint64>(toJsonDouble(value)));
+                    break;
+                case Field::Parameters:
+                case Field::Unknown:
+                    break;
+            }
+        } while (cursor.consume(','));
+        
+        if (!cursor.consume('}')) {
+            return false;
+        }
+    }
+    
+    if (!cursor.atEnd()) {
+        return false;
+    }
+    
+    packet = decoded;
+    return true;
+}
+
+bool TelemetryJsonDecoder::isSimdAccelerated()
+{
+#if defined(__SSE2__)
+    return true;
+#else
+    return false;
+#endif
+}
@@ -0,0 +1,42 @@
+/**
+ * @file TelemetryJsonDecoder.h
+ * @brief Single-pass JSON decoder specialised for telemetry packets
+ */
+
+#ifndef TELEMETRYJSONDECODER_H
+#define TELEMETRYJSONDECODER_H
+
+#include <QByteArrayView>
+#include "../core/TelemetryPacket.h"
+
+/**
+ * @class TelemetryJsonDecoder
+ * @brief Streams a telemetry JSON object straight into a TelemetryPacket
+ * 
+ * Understands the schema written by TelemetryPacket::toJson():
+ * subsystem_id, health_code, health_message, timestamp and a flat
+ * parameters object. Strings without escapes are converted directly from
+ * the datagram bytes and no intermediate DOM is built. String scanning
+ * uses SSE2 when the target supports it.
+ * 
+ * Field conversion follows the QJsonDocument path exactly (integral
+ * numbers become qlonglong, others double). Anything outside the fast
+ * path's scope - nested arrays or objects, malformed input - makes
+ * decode() return false so the caller can fall back to QJsonDocument.
+ */
+class TelemetryJsonDecoder
+{
+public:
+    /**
+     * @brief Decode a UTF-8 JSON telemetry object
+     * @return false if the input must be handled by the generic parser
+     */
+    static bool decode(QByteArrayView json, TelemetryPacket& packet);
+    
+    static bool isSimdAccelerated();
+    
+private:
+    TelemetryJsonDecoder() = default;
+};
+
+#endif // TELEMETRYJSONDECODER_H
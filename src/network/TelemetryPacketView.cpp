@@ -0,0 +1,476 @@
+/**
+ * @file TelemetryPacketView.cpp
+ * @brief Implementation of zero-copy DefenseProtocol view
+ */
+
+#include "TelemetryPacketView.h"
+#include "../core/ParameterDictionary.h"
+#include "../core/TelemetrySchema.h"
+#include <QtEndian>
+#include <QUuid>
+#include <cstring>
+
+namespace {
+
+inline quint8 byteAt(QByteArrayView data, qsizetype offset)
+{
+    return static_cast<quint8>(data[offset]);
+}
+
+inline quint64 readLittleEndian64(QByteArrayView data, qsizetype offset = 0)
+{
+    return qFromLittleEndian<quint64>(data.data() + offset);
+}
+
+inline bool isAsciiSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f';
+}
+
+} // namespace
+
+// ============================================================================
+// Parameter
+// ============================================================================
+
+double TelemetryPacketView::Parameter::toDouble() const
+{
+    switch (type) {
+        case ValueType::Double: {
+            double val = 0;
+            memcpy(&val, value.data(), sizeof(val));
+            return val;
+        }
+        case ValueType::Float64: {
+            quint64 bits = readLittleEndian64(value);
+            double val = 0;
+            memcpy(&val, &bits, sizeof(val));
+            return val;
+        }
+        case ValueType::Integer:
+            return toInt();
+        case ValueType::Int64:
+        case ValueType::Bool:
+        case ValueType::Enum:
+            return static_cast<double>(toInt64());
+        case ValueType::String:
+            return QString::fromUtf8(value).toDouble();
+    }
+    return 0.0;
+}
+
+qint32 TelemetryPacketView::Parameter::toInt() const
+{
+    switch (type) {
+        case ValueType::Integer: {
+            qint32 val = 0;
+            memcpy(&val, value.data(), sizeof(val));
+            return val;
+        }
+        case ValueType::Double:
+        case ValueType::Float64:
+            return static_cast<qint32>(toDouble());
+        case ValueType::Int64:
+        case ValueType::Bool:
+        case ValueType::Enum:
+            return static_cast<qint32>(toInt64());
+        case ValueType::String:
+            return QString::fromUtf8(value).toInt();
+    }
+    return 0;
+}
+
+qint64 TelemetryPacketView::Parameter::toInt64() const
+{
+    switch (type) {
+        case ValueType::Int64:
+        case ValueType::Enum:
+            return static_cast<qint64>(readLittleEndian64(value));
+        case ValueType::Bool:
+            return readLittleEndian64(value) != 0 ? 1 : 0;
+        case ValueType::Integer:
+            return toInt();
+        case ValueType::Double:
+        case ValueType::Float64:
+            return static_cast<qint64>(toDouble());
+        case ValueType::String:
+            return QString::fromUtf8(value).toLongLong();
+    }
+    return 0;
+}
+
+QVariant TelemetryPacketView::Parameter::toVariant() const
+{
+    switch (type) {
+        case ValueType::Double:
+        case ValueType::Float64:
+            return toDouble();
+        case ValueType::Integer:
+            return toInt();
+        case ValueType::Int64:
+            return static_cast<qlonglong>(toInt64());
+        case ValueType::Bool:
+            return toInt64() != 0;
+        case ValueType::Enum:
+            return toInt();
+        case ValueType::String:
+            return QString::fromUtf8(value);
+    }
+    return QVariant();
+}
+
+// ============================================================================
+// const_iterator
+// ============================================================================
+
+TelemetryPacketView::const_iterator::const_iterator(QByteArrayView data, int version,
+                                                    qsizetype offset, int index, int count)
+    : m_data(data)
+    , m_version(version)
+    , m_offset(offset)
+    , m_index(index)
+    , m_count(count)
+{
+    if (m_index < m_count) {
+        readCurrent();
+    }
+}
+
+TelemetryPacketView::const_iterator& TelemetryPacketView::const_iterator::operator++()
+{
+    if (++m_index < m_count) {
+        readCurrent();
+    }
+    return *this;
+}
+
+void TelemetryPacketView::const_iterator::readCurrent()
+{
+    // Bounds were proven when the view was constructed
+    if (m_version == Version2) {
+        readParameterV2(m_data, m_offset, m_current);
+    } else {
+        readParameter(m_data, m_offset, m_current);
+    }
+}
+
+// ============================================================================
+// TelemetryPacketView
+// ============================================================================
+
+TelemetryPacketView::TelemetryPacketView()
+    : m_version(0)
+    , m_valid(false)
+    , m_error("Empty defense protocol packet")
+    , m_declaredCount(0)
+    , m_parameterCount(0)
+{
+}
+
+TelemetryPacketView::TelemetryPacketView(QByteArrayView data)
+    : m_data(data)
+    , m_version(1)
+    , m_valid(false)
+    , m_error(nullptr)
+    , m_declaredCount(0)
+    , m_parameterCount(0)
+{
+    if (data.size() < HeaderSize) {
+        m_error = "Defense protocol packet too small";
+        return;
+    }
+    
+    if (memcmp(data.data(), "RHMS", 4) != 0) {
+        m_error = "Invalid defense protocol header";
+        return;
+    }
+    
+    // v1 carries a printable subsystem ID at offset 4, so a version byte
+    // there cannot be mistaken for one
+    if (byteAt(data, 4) == Version2) {
+        m_version = Version2;
+        
+        if (data.size() < V2HeaderSize) {
+            m_error = "Defense protocol packet too small";
+            return;
+        }
+        
+        m_declaredCount = qFromLittleEndian<quint16>(data.data() + 32);
+        
+        // Fixed-size records: count the complete ones, then check types
+        qsizetype available = (data.size() - V2HeaderSize) / V2RecordSize;
+        int complete = static_cast<int>(qMin<qsizetype>(m_declaredCount, available));
+        
+        qsizetype offset = V2HeaderSize;
+        Parameter parameter;
+        while (m_parameterCount < complete && readParameterV2(data, offset, parameter)) {
+            m_parameterCount++;
+        }
+        
+        m_valid = true;
+        return;
+    }
+    
+    m_declaredCount = (byteAt(data, 29) << 8) | byteAt(data, 30);
+    
+    // Single validation pass; a truncated or unknown parameter ends the list
+    qsizetype offset = HeaderSize;
+    Parameter parameter;
+    while (m_parameterCount < m_declaredCount && readParameter(data, offset, parameter)) {
+        m_parameterCount++;
+    }
+    
+    m_valid = true;
+}
+
+bool TelemetryPacketView::readParameter(QByteArrayView data, qsizetype& offset,
+                                        Parameter& parameter)
+{
+    qsizetype pos = offset;
+    
+    if (pos >= data.size()) {
+        return false;
+    }
+    quint8 keyLen = byteAt(data, pos++);
+    
+    // Key must be followed by at least the value type byte
+    if (pos + keyLen >= data.size()) {
+        return false;
+    }
+    parameter.key = data.sliced(pos, keyLen);
+    pos += keyLen;
+    
+    quint8 valueType = byteAt(data, pos++);
+    
+    switch (valueType) {
+        case 0:
+            if (pos + 8 > data.size()) {
+                return false;
+            }
+            parameter.type = ValueType::Double;
+            parameter.value = data.sliced(pos, 8);
+            pos += 8;
+            break;
+        case 1:
+            if (pos + 4 > data.size()) {
+                return false;
+            }
+            parameter.type = ValueType::Integer;
+            parameter.value = data.sliced(pos, 4);
+            pos += 4;
+            break;
+        case 2: {
+            if (pos >= data.size()) {
+                return false;
+            }
+            quint8 strLen = byteAt(data, pos++);
+            if (pos + strLen > data.size()) {
+                return false;
+            }
+            parameter.type = ValueType::String;
+            parameter.value = data.sliced(pos, strLen);
+            pos += strLen;
+            break;
+        }
+        default:
+            return false;
+    }
+    
+    offset = pos;
+    return true;
+}
+
+bool TelemetryPacketView::readParameterV2(QByteArrayView data, qsizetype& offset,
+                                          Parameter& parameter)
+{
+    if (offset + V2RecordSize > data.size()) {
+        return false;
+    }
+    
+    switch (byteAt(data, offset + 2)) {
+        case 0:
+            parameter.type = ValueType::Float64;
+            break;
+        case 1:
+            parameter.type = ValueType::Int64;
+            break;
+        case 2:
+            parameter.type = ValueType::Bool;
+            break;
+        case 3:
+            parameter.type = ValueType::Enum;
+            break;
+        default:
+            return false;
+    }
+    
+    parameter.key = QByteArrayView();
+    parameter.id = qFromLittleEndian<quint16>(data.data() + offset);
+    parameter.value = data.sliced(offset + 8, 8);
+    
+    offset += V2RecordSize;
+    return true;
+}
+
+qsizetype TelemetryPacketView::parametersOffset() const
+{
+    return m_version == Version2 ? V2HeaderSize : HeaderSize;
+}
+
+QByteArrayView TelemetryPacketView::subsystemId() const
+{
+    if (!m_valid) {
+        return QByteArrayView();
+    }
+    
+    if (m_version == Version2) {
+        return m_data.sliced(16, 16);
+    }
+    
+    // 16-byte field, space padded
+    qsizetype begin = 4;
+    qsizetype end = 20;
+    while (begin < end && isAsciiSpace(m_data[begin])) {
+        ++begin;
+    }
+    while (end > begin && isAsciiSpace(m_data[end - 1])) {
+        --end;
+    }
+    return m_data.sliced(begin, end - begin);
+}
+
+QString TelemetryPacketView::subsystemIdString() const
+{
+    if (m_version == Version2) {
+        if (!m_valid) {
+            return QString();
+        }
+        return QUuid::fromRfc4122(subsystemId()).toString(QUuid::WithoutBraces);
+    }
+    return QString::fromUtf8(subsystemId());
+}
+
+quint16 TelemetryPacketView::subsystemTypeId() const
+{
+    if (!m_valid || m_version != Version2) {
+        return ParameterDictionary::Generic;
+    }
+    return qFromLittleEndian<quint16>(m_data.data() + 6);
+}
+
+HealthCode TelemetryPacketView::healthCode() const
+{
+    if (!m_valid) {
+        return HealthCode::UNKNOWN;
+    }
+    return static_cast<HealthCode>(byteAt(m_data, m_version == Version2 ? 5 : 20));
+}
+
+qint64 TelemetryPacketView::timestamp() const
+{
+    if (!m_valid) {
+        return 0;
+    }
+    
+    if (m_version == Version2) {
+        return static_cast<qint64>(readLittleEndian64(m_data, 8));
+    }
+    
+    // Big-endian qint64
+    qint64 timestamp = 0;
+    for (int i = 0; i < 8; ++i) {
+        timestamp = (timestamp << 8) | byteAt(m_data, 21 + i);
+    }
+    return timestamp;
+}
+
+TelemetryPacketView::const_iterator TelemetryPacketView::begin() const
+{
+    return const_iterator(m_data, m_version, parametersOffset(), 0, m_parameterCount);
+}
+
+TelemetryPacketView::const_iterator TelemetryPacketView::end() const
+{
+    return const_iterator(m_data, m_version, parametersOffset(), m_parameterCount, m_parameterCount);
+}
+
+bool TelemetryPacketView::findParameter(QByteArrayView key, Parameter* parameter) const
+{
+    if (m_version == Version2) {
+        quint16 id = ParameterDictionary::parameterId(subsystemTypeId(), QString::fromUtf8(key));
+        return id != ParameterDictionary::InvalidParameterId && findParameter(id, parameter);
+    }
+    
+    for (const Parameter& candidate : *this) {
+        if (candidate.key == key) {
+            if (parameter) {
+                *parameter = candidate;
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+bool TelemetryPacketView::findParameter(quint16 id, Parameter* parameter) const
+{
+    if (m_version != Version2) {
+        return false;
+    }
+    
+    for (const Parameter& candidate : *this) {
+        if (candidate.id == id) {
+            if (parameter) {
+                *parameter = candidate;
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+TelemetryPacket TelemetryPacketView::toPacket() const
+{
+    if (!m_valid) {
+        return TelemetryPacket();
+    }
+    
+    TelemetryPacket packet;
+    packet.setSubsystemId(subsystemIdString());
+    packet.setHealthCode(healthCode());
+    packet.setTimestamp(timestamp());
+    
+    if (m_version != Version2) {
+        for (const Parameter& parameter : *this) {
+            packet.addParameter(QString::fromUtf8(parameter.key), parameter.toVariant());
+        }
+        return packet;
+    }
+    
+    // Names and enumerations are resolved only for the owning copy; known
+    // numeric IDs go straight to their schema slot
+    const quint16 typeId = subsystemTypeId();
+    for (const Parameter& parameter : *this) {
+        if (parameter.type != ValueType::Enum) {
+            const int slot = TelemetrySchema::slotOf(typeId, parameter.id);
+            if (slot != TelemetrySchema::InvalidSlot) {
+                packet.addParameter(slot, parameter.toVariant());
+                continue;
+            }
+        }
+        
+        QString name = ParameterDictionary::parameterName(typeId, parameter.id);
+        if (name.isEmpty()) {
+            name = QString("param_%1").arg(parameter.id);
+        }
+        
+        if (parameter.type == ValueType::Enum) {
+            QString text = ParameterDictionary::enumText(typeId, parameter.id, parameter.toInt());
+            packet.addParameter(name, text.isEmpty() ? parameter.toVariant() : QVariant(text));
+        } else {
+            packet.addParameter(name, parameter.toVariant());
+        }
+    }
+    
+    return packet;
+}
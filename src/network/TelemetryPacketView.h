@@ -0,0 +1,136 @@
+/**
+ * @file TelemetryPacketView.h
+ * @brief Non-owning, zero-copy view over a DefenseProtocol datagram (v1 and v2)
+ */
+
+#ifndef TELEMETRYPACKETVIEW_H
+#define TELEMETRYPACKETVIEW_H
+
+#include <QByteArrayView>
+#include <QVariant>
+#include "../core/TelemetryPacket.h"
+
+/**
+ * @class TelemetryPacketView
+ * @brief Validates an RHMS frame once and reads fields in place
+ * 
+ * Wire format (v1):
+ * [Header:4 "RHMS"][SubsystemID:16][HealthCode:1][Timestamp:8 BE][ParamCount:2 BE][Params...]
+ * 
+ * Each parameter is [KeyLen:1][Key][ValueType:1][Value], where the value
+ * is a host-order double (type 0), a host-order int32 (type 1) or a
+ * length-prefixed UTF-8 string (type 2).
+ * 
+ * Wire format (v2), all fields little-endian, 8-byte values 8-byte aligned:
+ * [0]  "RHMS"          [4]  Version:1 (0x02)    [5]  HealthCode:1
+ * [6]  SubsystemType:2 [8]  Timestamp:8 (ms)     [16] SubsystemID:16 (RFC 4122 UUID)
+ * [32] ParamCount:2    [34] Reserved:6
+ * followed by ParamCount 16-byte records:
+ * [0] ParameterID:2 [2] ValueType:1 [3] Reserved:5 [8] Value:8
+ * where the value is a double (type 0), int64 (type 1), bool (type 2) or
+ * an enumerated status (type 3). Parameter IDs and enumerations come from
+ * ParameterDictionary; no strings are carried on the wire.
+ * 
+ * The constructor walks the frame once and records how many parameters
+ * are well formed; iteration afterwards needs no further bounds checks.
+ * Keys and strings are returned as views into the datagram, which must
+ * outlive the view. toPacket() builds an owning TelemetryPacket only when
+ * one is actually needed.
+ */
+class TelemetryPacketView
+{
+public:
+    static constexpr int HeaderSize = 31;
+    static constexpr int V2HeaderSize = 40;
+    static constexpr int V2RecordSize = 16;
+    static constexpr quint8 Version2 = 0x02;
+    
+    enum class ValueType : quint8 {
+        Double,     ///< v1: host-order double
+        Integer,    ///< v1: host-order int32
+        String,     ///< v1: UTF-8 bytes
+        Float64,    ///< v2: little-endian double
+        Int64,      ///< v2: little-endian int64
+        Bool,       ///< v2: non-zero is true
+        Enum        ///< v2: index into the parameter's ParameterDictionary enumeration
+    };
+    
+    /**
+     * @struct Parameter
+     * @brief One decoded parameter; key and string payload point into the datagram
+     * 
+     * v1 parameters are named by key; v2 parameters by numeric id.
+     */
+    struct Parameter {
+        QByteArrayView key;
+        quint16 id = 0;
+        ValueType type = ValueType::Double;
+        QByteArrayView value;   ///< Raw value bytes (string payload for String)
+        
+        double toDouble() const;
+        qint32 toInt() const;
+        qint64 toInt64() const;
+        QVariant toVariant() const;
+    };
+    
+    class const_iterator
+    {
+    public:
+        const Parameter& operator*() const { return m_current; }
+        const Parameter* operator->() const { return &m_current; }
+        const_iterator& operator++();
+        bool operator==(const const_iterator& other) const { return m_index == other.m_index; }
+        bool operator!=(const const_iterator& other) const { return m_index != other.m_index; }
+    
+    private:
+        friend class TelemetryPacketView;
+        const_iterator(QByteArrayView data, int version, qsizetype offset, int index, int count);
+        void readCurrent();
+        
+        QByteArrayView m_data;
+        int m_version;
+        qsizetype m_offset;
+        int m_index;
+        int m_count;
+        Parameter m_current;
+    };
+    
+    TelemetryPacketView();
+    explicit TelemetryPacketView(QByteArrayView data);
+    
+    bool isValid() const { return m_valid; }
+    const char* errorString() const { return m_error; }
+    int version() const { return m_version; }
+    
+    // Header fields; subsystemId() is text for v1 and a binary UUID for v2
+    QByteArrayView subsystemId() const;
+    QString subsystemIdString() const;
+    quint16 subsystemTypeId() const;
+    HealthCode healthCode() const;
+    qint64 timestamp() const;
+    
+    // Parameters (only the well-formed prefix is exposed)
+    int parameterCount() const { return m_parameterCount; }
+    int declaredParameterCount() const { return m_declaredCount; }
+    const_iterator begin() const;
+    const_iterator end() const;
+    bool findParameter(QByteArrayView key, Parameter* parameter) const;
+    bool findParameter(quint16 id, Parameter* parameter) const;
+    
+    // Owning copy
+    TelemetryPacket toPacket() const;
+    
+private:
+    static bool readParameter(QByteArrayView data, qsizetype& offset, Parameter& parameter);
+    static bool readParameterV2(QByteArrayView data, qsizetype& offset, Parameter& parameter);
+    qsizetype parametersOffset() const;
+    
+    QByteArrayView m_data;
+    int m_version;
+    bool m_valid;
+    const char* m_error;
+    int m_declaredCount;
+    int m_parameterCount;
+};
+
+#endif // TELEMETRYPACKETVIEW_H
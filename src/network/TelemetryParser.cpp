@@ -4,9 +4,15 @@
  */
 
 #include "TelemetryParser.h"
+#include "TelemetryPacketView.h"
+#include "TelemetryJsonDecoder.h"
+#include "../core/ParameterDictionary.h"
 #include <QJsonDocument>
 #include <QJsonObject>
+#include <QtEndian>
+#include <QUuid>
 #include <QDebug>
+#include <cstring>
 
 TelemetryPacket TelemetryParser::parse(const QByteArray& data, Format format)
 {
@@ -27,6 +33,7 @@ TelemetryPacket TelemetryParser::parse(const QByteArray& data, Format format)
         case Format::Json:
             return parseJson(data);
         case Format::DefenseProtocol:
+        case Format::DefenseProtocolV2:
             return parseDefenseProtocol(data);
         default:
             qWarning() << "Unknown telemetry format";
@@ -34,6 +41,19 @@ TelemetryPacket TelemetryParser::parse(const QByteArray& data, Format format)
     }
 }
 
+QVector<TelemetryPacket> TelemetryParser::parseBatch(const QVector<QByteArray>& datagrams,
+                                                     Format format)
+{
+    QVector<TelemetryPacket> packets;
+    packets.reserve(datagrams.size());
+    
+    for (const QByteArray& datagram : datagrams) {
+        packets.append(parse(datagram, format));
+    }
+    
+    return packets;
+}
+
 TelemetryPacket TelemetryParser::parseBinary(const QByteArray& data)
 {
     // Use TelemetryPacket's built-in deserialization
@@ -42,96 +62,29 @@ TelemetryPacket TelemetryParser::parseBinary(const QByteArray& data)
 
 TelemetryPacket TelemetryParser::parseJson(const QByteArray& data)
 {
-    QString jsonString = QString::fromUtf8(data);
-    return TelemetryPacket::fromJson(jsonString);
+    // Flat packets written by TelemetryPacket::toJson() decode in one pass;
+    // anything else goes through QJsonDocument with identical results
+    TelemetryPacket packet;
+    if (TelemetryJsonDecoder::decode(data, packet)) {
+        return packet;
+    }
+    return TelemetryPacket::fromJsonUtf8(data);
 }
 
 TelemetryPacket TelemetryParser::parseDefenseProtocol(const QByteArray& data)
 {
-    // Custom defense protocol parser
-    // Format: [Header:4][SubsystemID:16][HealthCode:1][Timestamp:8][ParamCount:2][Params...]
-    
-    if (data.size() < 31) {
-        qWarning() << "Defense protocol packet too small";
-        return TelemetryPacket();
-    }
-    
-    TelemetryPacket packet;
-    
-    // Parse header (magic number: "RHMS")
-    QByteArray header = data.mid(0, 4);
-    if (header != "RHMS") {
-        qWarning() << "Invalid defense protocol header";
+    // Custom defense protocol parser (v1 and v2, see TelemetryPacketView)
+    // v1: [Header:4][SubsystemID:16][HealthCode:1][Timestamp:8][ParamCount:2][Params...]
+    // v2: [Header:4][Version:1][HealthCode:1][Type:2][Timestamp:8][UUID:16][ParamCount:2]...
+    // The view validates the frame in place; strings are only built for
+    // the owning packet
+    TelemetryPacketView view(data);
+    if (!view.isValid()) {
+        qWarning() << view.errorString();
         return TelemetryPacket();
     }
     
-    // Parse subsystem ID (16 bytes, UUID without braces)
-    QString subsystemId = QString::fromUtf8(data.mid(4, 16)).trimmed();
-    packet.setSubsystemId(subsystemId);
-    
-    // Parse health code (1 byte)
-    quint8 healthCode = static_cast<quint8>(data.at(20));
-    packet.setHealthCode(static_cast<HealthCode>(healthCode));
-    
-    // Parse timestamp (8 bytes, big-endian qint64)
-    qint64 timestamp = 0;
-    for (int i = 0; i < 8; ++i) {
-        timestamp = (timestamp << 8) | static_cast<quint8>(data.at(21 + i));
-    }
-    packet.setTimestamp(timestamp);
-    
-    // Parse parameter count (2 bytes, big-endian quint16)
-    quint16 paramCount = (static_cast<quint8>(data.at(29)) << 8) | 
-                         static_cast<quint8>(data.at(30));
-    
-    // Parse parameters
-    int offset = 31;
-    for (quint16 i = 0; i < paramCount && offset < data.size(); ++i) {
-        // Each parameter: [KeyLen:1][Key:KeyLen][ValueType:1][Value:varies]
-        if (offset >= data.size()) break;
-        
-        quint8 keyLen = static_cast<quint8>(data.at(offset++));
-        if (offset + keyLen >= data.size()) break;
-        
-        QString key = QString::fromUtf8(data.mid(offset, keyLen));
-        offset += keyLen;
-        
-        if (offset >= data.size()) break;
-        quint8 valueType = static_cast<quint8>(data.at(offset++));
-        
-        // Parse value based on type
-        QVariant value;
-        switch (valueType) {
-            case 0: { // Double
-                if (offset + 8 > data.size()) break;
-                double val = 0;
-                memcpy(&val, data.constData() + offset, 8);
-                value = val;
-                offset += 8;
-                break;
-            }
-            case 1: { // Integer
-                if (offset + 4 > data.size()) break;
-                qint32 val = 0;
-                memcpy(&val, data.constData() + offset, 4);
-                value = val;
-                offset += 4;
-                break;
-            }
-            case 2: { // String
-                if (offset >= data.size()) break;
-                quint8 strLen = static_cast<quint8>(data.at(offset++));
-                if (offset + strLen > data.size()) break;
-                value = QString::fromUtf8(data.mid(offset, strLen));
-                offset += strLen;
-                break;
-            }
-        }
-        
-        packet.addParameter(key, value);
-    }
-    
-    return packet;
+    return view.toPacket();
 }
 
 TelemetryParser::Format TelemetryParser::detectFormat(const QByteArray& data)
@@ -140,8 +93,12 @@ TelemetryParser::Format TelemetryParser::detectFormat(const QByteArray& data)
         return Format::Binary;
     }
     
-    // Check for defense protocol header
+    // Check for defense protocol header; v2 puts a version byte where v1
+    // starts its printable subsystem ID
     if (data.size() >= 4 && data.left(4) == "RHMS") {
+        if (data.size() > 4 && static_cast<quint8>(data.at(4)) == TelemetryPacketView::Version2) {
+            return Format::DefenseProtocolV2;
+        }
         return Format::DefenseProtocol;
     }
     
@@ -159,8 +116,93 @@ QByteArray TelemetryParser::encode(const TelemetryPacket& packet, Format format)
     switch (format) {
         case Format::Json:
             return packet.toJson().toUtf8();
+        case Format::DefenseProtocolV2:
+            return encodeDefenseProtocolV2(packet);
         case Format::Binary:
         default:
             return packet.serialize();
     }
 }
+
+QByteArray TelemetryParser::encodeDefenseProtocolV2(const TelemetryPacket& packet,
+                                                    const QString& subsystemType)
+{
+    QUuid uuid(packet.subsystemId());
+    if (uuid.isNull()) {
+        qWarning() << "Defense protocol v2 requires a UUID subsystem ID:" << packet.subsystemId();
+        return QByteArray();
+    }
+    
+    const quint16 typeId = ParameterDictionary::subsystemTypeId(subsystemType);
+    const QMap<QString, QVariant> parameters = packet.allParameters();
+    
+    QByteArray frame(TelemetryPacketView::V2HeaderSize
+                     + parameters.size() * TelemetryPacketView::V2RecordSize, '\0');
+    char* out = frame.data();
+    
+    memcpy(out, "RHMS", 4);
+    out[4] = static_cast<char>(TelemetryPacketView::Version2);
+    out[5] = static_cast<char>(static_cast<quint8>(packet.healthCode()));
+    qToLittleEndian<quint16>(typeId, out + 6);
+    qToLittleEndian<qint64>(packet.timestamp(), out + 8);
+    memcpy(out + 16, uuid.toRfc4122().constData(), 16);
+    
+    quint16 count = 0;
+    for (auto it = parameters.constBegin(); it != parameters.constEnd(); ++it) {
+        quint16 id = ParameterDictionary::parameterId(typeId, it.key());
+        if (id == ParameterDictionary::InvalidParameterId) {
+            qDebug() << "No v2 parameter ID for" << it.key() << "- not encoded";
+            continue;
+        }
+        
+        const QVariant& value = it.value();
+        quint8 valueType;
+        quint64 bits;
+        
+        if (ParameterDictionary::isEnumParameter(typeId, id)) {
+            int index = ParameterDictionary::enumValue(typeId, id, value.toString());
+            if (index < 0) {
+                qDebug() << "Unknown value" << value.toString() << "for" << it.key() << "- not encoded";
+                continue;
+            }
+            valueType = 3;
+            bits = static_cast<quint64>(index);
+        } else {
+            switch (value.typeId()) {
+                case QMetaType::Bool:
+                    valueType = 2;
+                    bits = value.toBool() ? 1 : 0;
+                    break;
+                case QMetaType::Int:
+                case QMetaType::UInt:
+                case QMetaType::LongLong:
+                case QMetaType::ULongLong:
+                    valueType = 1;
+                    bits = static_cast<quint64>(value.toLongLong());
+                    break;
+                default: {
+                    bool ok = false;
+                    double number = value.toDouble(&ok);
+                    if (!ok) {
+                        qDebug() << "Non-numeric value for" << it.key() << "- not encoded";
+                        continue;
+                    }
+                    valueType = 0;
+                    memcpy(&bits, &number, sizeof(bits));
+                    break;
+                }
+            }
+        }
+        
+        char* record = out + TelemetryPacketView::V2HeaderSize
+                       + count * TelemetryPacketView::V2RecordSize;
+        qToLittleEndian<quint16>(id, record);
+        record[2] = static_cast<char>(valueType);
+        qToLittleEndian<quint64>(bits, record + 8);
+        count++;
+    }
+    
+    qToLittleEndian<quint16>(count, out + 32);
+    frame.resize(TelemetryPacketView::V2HeaderSize + count * TelemetryPacketView::V2RecordSize);
+    return frame;
+}
@@ -7,6 +7,7 @@
 #define TELEMETRYPARSER_H
 
 #include <QByteArray>
+#include <QVector>
 #include "../core/TelemetryPacket.h"
 
 /**
@@ -16,7 +17,7 @@
  * Supports multiple packet formats:
  * - Binary (QDataStream format)
  * - JSON (text-based)
- * - Custom defense protocol
+ * - Custom defense protocol (v1 string keys, v2 numeric IDs)
  */
 class TelemetryParser
 {
@@ -25,7 +26,8 @@ public:
         Auto,           ///< Auto-detect format
         Binary,         ///< QDataStream binary format
         Json,           ///< JSON text format
-        DefenseProtocol ///< Custom defense binary protocol
+        DefenseProtocol,    ///< Custom defense binary protocol (v1)
+        DefenseProtocolV2   ///< Versioned defense protocol with dictionary IDs
     };
     
     // Parse methods
@@ -34,12 +36,18 @@ public:
     static TelemetryPacket parseJson(const QByteArray& data);
     static TelemetryPacket parseDefenseProtocol(const QByteArray& data);
     
+    // Batch parsing (one result per datagram, invalid packets included)
+    static QVector<TelemetryPacket> parseBatch(const QVector<QByteArray>& datagrams,
+                                               Format format = Format::Auto);
+    
     // Format detection
     static Format detectFormat(const QByteArray& data);
     
     // Encoding methods
     static QByteArray encode(const TelemetryPacket& packet, Format format = Format::Binary);
-    
+    static QByteArray encodeDefenseProtocolV2(const TelemetryPacket& packet,
+                                              const QString& subsystemType = QString());
+                                              
 private:
     TelemetryParser() = default;
 };
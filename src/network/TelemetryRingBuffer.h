@@ -0,0 +1,161 @@
+/**
+ * @file TelemetryRingBuffer.h
+ * @brief Bounded lock-free ring buffer for handing packets between threads
+ */
+
+#ifndef TELEMETRYRINGBUFFER_H
+#define TELEMETRYRINGBUFFER_H
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <thread>
+#include <utility>
+
+/**
+ * @class TelemetryRingBuffer
+ * @brief Bounded single-producer ring with a configurable overflow policy
+ * 
+ * Each slot carries a sequence number (Vyukov bounded queue), so a slot is
+ * only published to the consumer once its payload is fully written. There
+ * is exactly one producer thread. Dequeue claims slots with a CAS on the
+ * read position, which lets the producer discard the oldest entry itself
+ * under the DropOldest policy without racing the consumer. A push evicts
+ * at most one entry.
+ * 
+ * Capacity is rounded up to a power of two.
+ */
+template<typename T>
+class TelemetryRingBuffer
+{
+public:
+    enum class OverflowPolicy {
+        DropOldest,     ///< Discard the oldest queued item to make room
+        DropNewest      ///< Discard the item being pushed
+    };
+    
+    explicit TelemetryRingBuffer(size_t capacity, OverflowPolicy policy = OverflowPolicy::DropOldest)
+        : m_capacity(roundUpToPowerOfTwo(capacity))
+        , m_mask(m_capacity - 1)
+        , m_policy(policy)
+        , m_cells(new Cell[m_capacity])
+        , m_enqueuePos(0)
+        , m_dequeuePos(0)
+    {
+        for (size_t i = 0; i < m_capacity; ++i) {
+            m_cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+    
+    TelemetryRingBuffer(const TelemetryRingBuffer&) = delete;
+    TelemetryRingBuffer& operator=(const TelemetryRingBuffer&) = delete;
+    
+    size_t capacity() const { return m_capacity; }
+    OverflowPolicy overflowPolicy() const { return m_policy; }
+    
+    /**
+     * @brief Enqueue an item (producer thread only)
+     * @return false if an item had to be dropped to honour the policy
+     */
+    bool push(T item)
+    {
+        bool dropped = false;
+        bool evicted = false;
+        size_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+        
+        for (;;) {
+            Cell& cell = m_cells[pos & m_mask];
+            size_t seq = cell.sequence.load(std::memory_order_acquire);
+            
+            if (seq == pos) {
+                cell.data = std::move(item);
+                cell.sequence.store(pos + 1, std::memory_order_release);
+                m_enqueuePos.store(pos + 1, std::memory_order_relaxed);
+                return !dropped;
+            }
+            
+            // Slot still holds an unconsumed item: the ring is full
+            if (m_policy == OverflowPolicy::DropNewest) {
+                return false;
+            }
+            
+            // Evict the oldest entry, once. If the consumer has claimed
+            // this slot but not released it yet, popping again would take
+            // a further entry each time round, so wait for the release.
+            if (!evicted) {
+                T discarded;
+                dropped = pop(discarded);
+                evicted = true;
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    }
+    
+    /**
+     * @brief Dequeue the oldest item (consumer thread, or producer on overflow)
+     * @return false if the ring is empty
+     */
+    bool pop(T& out)
+    {
+        size_t pos = m_dequeuePos.load(std::memory_order_relaxed);
+        Cell* cell;
+        
+        for (;;) {
+            cell = &m_cells[pos & m_mask];
+            size_t seq = cell->sequence.load(std::memory_order_acquire);
+            std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos + 1);
+            
+            if (diff == 0) {
+                if (m_dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = m_dequeuePos.load(std::memory_order_relaxed);
+            }
+        }
+        
+        out = std::move(cell->data);
+        cell->data = T();
+        cell->sequence.store(pos + m_mask + 1, std::memory_order_release);
+        return true;
+    }
+    
+    // Approximate number of queued items (exact when both sides are idle)
+    size_t size() const
+    {
+        size_t enqueued = m_enqueuePos.load(std::memory_order_relaxed);
+        size_t dequeued = m_dequeuePos.load(std::memory_order_relaxed);
+        return enqueued > dequeued ? enqueued - dequeued : 0;
+    }
+    
+    bool isEmpty() const { return size() == 0; }
+    
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T data;
+    };
+    
+    static size_t roundUpToPowerOfTwo(size_t value)
+    {
+        size_t result = 2;
+        while (result < value) {
+            result <<= 1;
+        }
+        return result;
+    }
+    
+    const size_t m_capacity;
+    const size_t m_mask;
+    const OverflowPolicy m_policy;
+    std::unique_ptr<Cell[]> m_cells;
+    
+    // Producer and consumer positions on separate cache lines
+    alignas(64) std::atomic<size_t> m_enqueuePos;
+    alignas(64) std::atomic<size_t> m_dequeuePos;
+};
+
+#endif // TELEMETRYRINGBUFFER_H
@@ -0,0 +1,58 @@
+/**
+ * @file TelemetryStatistics.h
+ * @brief Snapshot of every counter along the telemetry ingest path
+ */
+
+#ifndef TELEMETRYSTATISTICS_H
+#define TELEMETRYSTATISTICS_H
+
+#include <QtGlobal>
+#include "TelemetryParser.h"
+
+/**
+ * @struct TelemetryStatistics
+ * @brief Where every datagram went, from the socket to the subsystem node
+ * 
+ * Filled from relaxed atomic loads, so it can be polled from any thread
+ * without locking; fields are individually exact but not a single
+ * consistent cut. Losses are split by where they happen:
+ * 
+ * - kernelDrops: datagrams the socket buffer had no room for (SO_RXQ_OVFL,
+ *   batched receive path only)
+ * - queueOverflows: packets discarded because a hand-off ring was full
+ * - truncatedDatagrams: datagrams larger than the receive buffer
+ * - parseErrors: datagrams that did not parse, also split by detected format
+ * - packetsUnrouted: valid packets for a subsystem with no registered node
+ */
+struct TelemetryStatistics {
+    static constexpr int FormatCount = static_cast<int>(TelemetryParser::Format::DefenseProtocolV2) + 1;
+    
+    // Receive
+    quint64 datagramsReceived = 0;
+    quint64 receiveSyscalls = 0;
+    quint64 packetsParsed = 0;
+    int receiveBufferSize = 0;      ///< Effective SO_RCVBUF in bytes (as reported by the kernel)
+    
+    // Losses and rejects
+    quint64 kernelDrops = 0;
+    quint64 queueOverflows = 0;
+    quint64 truncatedDatagrams = 0;
+    quint64 parseErrors = 0;
+    quint64 parseErrorsByFormat[FormatCount] = {};  ///< Indexed by TelemetryParser::Format
+    
+    // Dispatch (filled in by HealthStatusDispatcher)
+    quint64 packetsDispatched = 0;
+    quint64 packetsUnrouted = 0;
+    
+    quint64 parseErrorsFor(TelemetryParser::Format format) const
+    {
+        return parseErrorsByFormat[static_cast<int>(format)];
+    }
+    
+    quint64 totalLost() const
+    {
+        return kernelDrops + queueOverflows + truncatedDatagrams + parseErrors + packetsUnrouted;
+    }
+};
+
+#endif // TELEMETRYSTATISTICS_H
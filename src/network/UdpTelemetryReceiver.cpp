@@ -5,6 +5,8 @@
 
 #include "UdpTelemetryReceiver.h"
 #include "TelemetryParser.h"
+#include "DatagramBatchReader.h"
+#include "ClockSkewTracker.h"
 #include <QDebug>
 #include <QHostAddress>
 #include <QMutexLocker>
@@ -13,17 +15,50 @@
 // UdpReceiverWorker Implementation
 // ============================================================================
 
-UdpReceiverWorker::UdpReceiverWorker(quint16 port, QObject* parent)
+UdpReceiverWorker::UdpReceiverWorker(quint16 port, ReceiverCounters* counters,
+                                     bool reusePort, QObject* parent)
     : QObject(parent)
     , m_socket(nullptr)
     , m_port(port)
     , m_running(false)
+    , m_receiveBufferSize(0)
+    , m_batchSize(DatagramBatchReader::DefaultBatchSize)
+    , m_reusePort(reusePort)
+    , m_batchNotifier(nullptr)
+    , m_bufferPool(nullptr)
+    , m_reportedExhaustions(0)
+    , m_bufferPoolExhausted(false)
+    , m_counters(counters)
+    , m_ring(nullptr)
+    , m_drainPending(nullptr)
+    , m_packetsQueued(0)
 {
 }
 
 UdpReceiverWorker::~UdpReceiverWorker()
 {
     stop();
+    
+    // Every buffer must be back before a private pool is destroyed
+    m_batchBuffers.clear();
+    m_batchReader.reset();
+}
+
+void UdpReceiverWorker::setOutputRing(TelemetryPacketRing* ring, QAtomicInt* drainPending)
+{
+    m_ring = ring;
+    m_drainPending = drainPending;
+}
+
+void UdpReceiverWorker::setBufferPool(DatagramBufferPool* pool)
+{
+    m_bufferPool = pool;
+}
+
+void UdpReceiverWorker::setReceiveBufferSize(int bytes)
+{
+    QMutexLocker locker(&m_mutex);
+    m_receiveBufferSize = qMax(0, bytes);
 }
 
 void UdpReceiverWorker::start()
@@ -79,8 +114,44 @@ void UdpReceiverWorker::setPort(quint16 port)
     }
 }
 
+void UdpReceiverWorker::setBatchSize(int batchSize)
+{
+    QMutexLocker locker(&m_mutex);
+    
+    batchSize = qBound(1, batchSize, DatagramBatchReader::MaxBatchSize);
+    if (m_batchSize == batchSize) {
+        return;
+    }
+    
+    bool wasRunning = m_running;
+    if (wasRunning) {
+        locker.unlock();
+        stop();
+        locker.relock();
+    }
+    
+    m_batchSize = batchSize;
+    
+    if (wasRunning) {
+        locker.unlock();
+        start();
+    }
+}
+
 bool UdpReceiverWorker::bindSocket()
 {
+    if (!m_bufferPool) {
+        m_ownedBufferPool = std::make_unique<DatagramBufferPool>(
+            qMax(DatagramBufferPool::DefaultBufferCount, 2 * m_batchSize),
+            DatagramBatchReader::MaxDatagramSize);
+        m_bufferPool = m_ownedBufferPool.get();
+    }
+    
+    // SO_REUSEPORT needs the raw socket, so shards always take this path
+    if ((m_batchSize > 1 || m_reusePort) && DatagramBatchReader::isSupported()) {
+        return bindBatchSocket();
+    }
+    
     if (m_socket) {
         delete m_socket;
         m_socket = nullptr;
@@ -101,10 +172,43 @@ bool UdpReceiverWorker::bindSocket()
         return false;
     }
     
+    if (m_receiveBufferSize > 0) {
+        m_socket->setSocketOption(QAbstractSocket::ReceiveBufferSizeSocketOption,
+                                  m_receiveBufferSize);
+    }
+    m_counters->receiveBufferSize.storeRelaxed(
+        m_socket->socketOption(QAbstractSocket::ReceiveBufferSizeSocketOption).toInt());
+    
     qInfo() << "UDP socket bound to port" << m_port;
     return true;
 }
 
+bool UdpReceiverWorker::bindBatchSocket()
+{
+    m_batchReader = std::make_unique<DatagramBatchReader>(m_batchSize, m_bufferPool);
+    
+    if (!m_batchReader->open(m_port, m_reusePort, m_receiveBufferSize)) {
+        qCritical() << "Failed to bind UDP socket to port" << m_port
+                    << ":" << m_batchReader->errorString();
+        m_batchReader.reset();
+        return false;
+    }
+    
+    // Watch the descriptor directly; QUdpSocket is not involved in this mode
+    m_batchNotifier = new QSocketNotifier(m_batchReader->socketDescriptor(),
+                                          QSocketNotifier::Read, this);
+    connect(m_batchNotifier, &QSocketNotifier::activated,
+            this, &UdpReceiverWorker::processPendingBatches);
+    
+    m_batchDatagrams.reserve(m_batchReader->batchSize());
+    m_batchBuffers.reserve(m_batchReader->batchSize());
+    m_counters->receiveBufferSize.storeRelaxed(m_batchReader->receiveBufferSize());
+    
+    qInfo() << "UDP socket bound to port" << m_port
+            << "with batched receive, batch size" << m_batchReader->batchSize();
+    return true;
+}
+
 void UdpReceiverWorker::unbindSocket()
 {
     if (m_socket) {
@@ -112,170 +216,593 @@ void UdpReceiverWorker::unbindSocket()
         delete m_socket;
         m_socket = nullptr;
     }
+    
+    if (m_batchNotifier) {
+        m_batchNotifier->setEnabled(false);
+        delete m_batchNotifier;
+        m_batchNotifier = nullptr;
+    }
+    
+    m_batchReader.reset();
 }
 
 void UdpReceiverWorker::processPendingDatagrams()
 {
+    // hasPendingDatagrams, pendingDatagramSize and readDatagram each cost
+    // one system call; count the final empty hasPendingDatagrams too
+    quint64 syscalls = 1;
+    quint64 datagrams = 0;
+    
     while (m_socket && m_socket->hasPendingDatagrams()) {
-        QByteArray datagram;
-        datagram.resize(m_socket->pendingDatagramSize());
+        syscalls += 3;
+        
+        // Pooled buffer; only oversized datagrams fall back to the heap
+        DatagramBuffer buffer = m_bufferPool->acquire(qMax<qint64>(m_socket->pendingDatagramSize(), 0));
         
         QHostAddress sender;
         quint16 senderPort;
         
-        qint64 bytesRead = m_socket->readDatagram(datagram.data(), datagram.size(),
+        qint64 bytesRead = m_socket->readDatagram(buffer.data(), buffer.capacity(),
                                                    &sender, &senderPort);
         
         if (bytesRead > 0) {
-            // Parse the telemetry packet
-            TelemetryPacket packet = TelemetryParser::parse(datagram);
+            datagrams++;
+            buffer.setSize(bytesRead);
+            
+            // QUdpSocket exposes no kernel timestamp; read time is the best
+            // available receive time on this path
+            const qint64 receivedNs = ClockSkewTracker::currentTimeNs();
+            
+            // Parse the telemetry packet in place
+            TelemetryPacket packet = TelemetryParser::parse(buffer.toByteArray());
+            packet.setReceiveTimestampNs(receivedNs);
             
             if (packet.isValid()) {
-                emit packetReceived(packet);
+                m_counters->packetsParsed.fetchAndAddRelaxed(1);
+                deliverPacket(packet);
             } else {
+                countParseError(buffer.toByteArray());
                 qWarning() << "Received invalid telemetry packet from" 
                           << sender.toString() << ":" << senderPort;
             }
         }
     }
+    
+    m_counters->receiveSyscalls.fetchAndAddRelaxed(syscalls);
+    m_counters->datagramsReceived.fetchAndAddRelaxed(datagrams);
+    
+    notifyPacketsQueued();
+    checkBufferPool();
+}
+
+void UdpReceiverWorker::processPendingBatches()
+{
+    while (m_batchReader) {
+        int count = m_batchReader->receiveBatch();
+        m_counters->receiveSyscalls.fetchAndAddRelaxed(1);
+        
+        if (count < 0) {
+            qWarning() << "Batched UDP receive failed:" << m_batchReader->errorString();
+            break;
+        }
+        if (count == 0) {
+            break;
+        }
+        
+        m_counters->datagramsReceived.fetchAndAddRelaxed(count);
+        m_counters->kernelDrops.fetchAndAddRelaxed(m_batchReader->takeKernelDrops());
+        
+        // The batch holds the pooled buffers by reference until parsed;
+        // the reader refills its slots before the next receive
+        m_batchDatagrams.resize(0);
+        for (int i = 0; i < count; ++i) {
+            if (m_batchReader->isTruncated(i)) {
+                m_counters->truncatedDatagrams.fetchAndAddRelaxed(1);
+                qWarning() << "Dropping truncated telemetry datagram from"
+                          << m_batchReader->senderAddress(i).toString();
+                m_batchDatagrams.append(QByteArray());
+            } else {
+                DatagramBuffer buffer = m_batchReader->takeDatagram(i);
+                m_batchDatagrams.append(buffer.toByteArray());
+                m_batchBuffers.append(std::move(buffer));
+            }
+        }
+        
+        QVector<TelemetryPacket> packets = TelemetryParser::parseBatch(m_batchDatagrams);
+        
+        // Read time stands in if the kernel did not stamp a datagram
+        const qint64 batchReadNs = ClockSkewTracker::currentTimeNs();
+        
+        for (int i = 0; i < packets.size(); ++i) {
+            if (packets[i].isValid()) {
+                qint64 receivedNs = m_batchReader->receiveTimestampNs(i);
+                packets[i].setReceiveTimestampNs(receivedNs > 0 ? receivedNs : batchReadNs);
+                
+                m_counters->packetsParsed.fetchAndAddRelaxed(1);
+                deliverPacket(packets[i]);
+                continue;
+            }
+            
+            // Truncated datagrams were already counted
+            if (m_batchReader->isTruncated(i)) {
+                continue;
+            }
+            
+            countParseError(m_batchDatagrams[i]);
+            qWarning() << "Received invalid telemetry packet from"
+                      << m_batchReader->senderAddress(i).toString()
+                      << ":" << m_batchReader->senderPort(i);
+        }
+        
+        // Packets own their data; hand the buffers back to the pool
+        m_batchBuffers.resize(0);
+        
+        // Let the consumer start on this batch while the next one is read
+        notifyPacketsQueued();
+        
+        // A short batch means the socket queue is drained; the level-triggered
+        // notifier fires again when more data arrives
+        if (count < m_batchReader->batchSize()) {
+            break;
+        }
+    }
+    
+    checkBufferPool();
+}
+
+void UdpReceiverWorker::deliverPacket(const TelemetryPacket& packet)
+{
+    if (!m_ring) {
+        emit packetReceived(packet);
+        return;
+    }
+    
+    if (!m_ring->push(packet)) {
+        m_counters->queueOverflows.fetchAndAddRelaxed(1);
+    }
+    m_packetsQueued++;
+}
+
+void UdpReceiverWorker::notifyPacketsQueued()
+{
+    if (!m_ring || m_packetsQueued == 0) {
+        return;
+    }
+    m_packetsQueued = 0;
+    
+    // One queued event per drain, however many packets arrive meanwhile
+    if (m_drainPending->testAndSetOrdered(0, 1)) {
+        emit packetsQueued();
+    }
+}
+
+void UdpReceiverWorker::countParseError(const QByteArray& datagram)
+{
+    // Format detection is cheap and only runs for rejects
+    const int format = static_cast<int>(TelemetryParser::detectFormat(datagram));
+    m_counters->parseErrors.fetchAndAddRelaxed(1);
+    m_counters->parseErrorsByFormat[format].fetchAndAddRelaxed(1);
+}
+
+void UdpReceiverWorker::checkBufferPool()
+{
+    if (!m_bufferPool) {
+        return;
+    }
+    
+    // Report once per exhaustion episode rather than once per datagram
+    quint64 exhaustions = m_bufferPool->exhaustions();
+    bool exhausted = exhaustions > m_reportedExhaustions;
+    m_reportedExhaustions = exhaustions;
+    
+    if (exhausted && !m_bufferPoolExhausted) {
+        qWarning() << "Receive buffer pool exhausted on port" << m_port << "-"
+                   << m_bufferPool->capacity() << "buffers in use, falling back to heap";
+        emit statusChanged(QString("Receive buffer pool exhausted on port %1").arg(m_port));
+    }
+    m_bufferPoolExhausted = exhausted;
 }
 
 // ============================================================================
 // UdpTelemetryReceiver Implementation
 // ============================================================================
 
+
 UdpTelemetryReceiver::UdpTelemetryReceiver(quint16 port, QObject* parent)
     : QObject(parent)
     , m_port(port)
+    , m_batchSize(DatagramBatchReader::DefaultBatchSize)
+    , m_shardCount(1)
+    , m_queueCapacity(DefaultQueueCapacity)
+    , m_overflowPolicy(TelemetryPacketRing::OverflowPolicy::DropOldest)
+    , m_bufferPoolSize(DatagramBufferPool::DefaultBufferCount)
+    , m_receiveBufferSize(0)
     , m_running(false)
+    , m_shardsStarted(0)
     , m_packetsReceived(0)
-    , m_packetsDropped(0)
-    , m_workerThread(nullptr)
-    , m_worker(nullptr)
+    , m_drainPending(0)
+{
+    // Never resized, so statistics() can walk it from any thread unlocked;
+    // totals also survive restarts with a different shard count
+    const int slotCount = maxShardCount();
+    for (int i = 0; i < slotCount; ++i) {
+        m_shardCounters.push_back(std::make_unique<ReceiverCounters>());
+    }
+}
+
+UdpTelemetryReceiver::~UdpTelemetryReceiver()
 {
-    // Create worker thread
-    m_workerThread = new QThread(this);
-    m_worker = new UdpReceiverWorker(m_port);
-    m_worker->moveToThread(m_workerThread);
+    stop();
+}
+
+void UdpTelemetryReceiver::start()
+{
+    QMutexLocker locker(&m_mutex);
     
-    // Connect signals
-    connect(m_workerThread, &QThread::started,
-            m_worker, &UdpReceiverWorker::start);
+    if (m_running) {
+        qWarning() << "Telemetry receiver already running";
+        return;
+    }
     
-    connect(m_worker, &UdpReceiverWorker::packetReceived,
-            this, &UdpTelemetryReceiver::handlePacketReceived);
+    // Shards left over from a failed bind are discarded and recreated
+    if (!m_shards.isEmpty()) {
+        destroyShards();
+    }
     
-    connect(m_worker, &UdpReceiverWorker::errorOccurred,
-            this, &UdpTelemetryReceiver::errorOccurred);
+    qInfo() << "Starting UDP telemetry receiver on port" << m_port
+            << "with" << m_shardCount << "shard(s)";
+    createShards();
+}
+
+void UdpTelemetryReceiver::stop()
+{
+    bool wasRunning;
+    {
+        QMutexLocker locker(&m_mutex);
+        
+        if (m_shards.isEmpty()) {
+            return;
+        }
+        
+        qInfo() << "Stopping UDP telemetry receiver";
+        destroyShards();
+        
+        wasRunning = m_running;
+        m_running = false;
+        m_shardsStarted = 0;
+    }
     
-    connect(m_worker, &UdpReceiverWorker::statusChanged,
-            this, &UdpTelemetryReceiver::statusChanged);
+    if (wasRunning) {
+        emit statusChanged("UDP receiver stopped");
+        emit receiverStopped();
+    }
+}
+
+bool UdpTelemetryReceiver::isRunning() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_running;
+}
+
+void UdpTelemetryReceiver::createShards()
+{
+    bool reusePort = m_shardCount > 1;
     
-    connect(m_worker, &UdpReceiverWorker::started,
-            this, &UdpTelemetryReceiver::handleWorkerStarted);
+    for (int i = 0; i < m_shardCount; ++i) {
+        Shard shard;
+        shard.thread = new QThread(this);
+        shard.thread->setObjectName(QString("UdpReceiverShard%1").arg(i));
+        shard.ring = new TelemetryPacketRing(m_queueCapacity, m_overflowPolicy);
+        // Room for the reader's armed slots plus one batch being parsed
+        shard.bufferPool = new DatagramBufferPool(qMax(m_bufferPoolSize, 2 * m_batchSize),
+                                                  DatagramBatchReader::MaxDatagramSize);
+        shard.worker = new UdpReceiverWorker(m_port, m_shardCounters[i].get(), reusePort);
+        shard.worker->setBatchSize(m_batchSize);
+        shard.worker->setOutputRing(shard.ring, &m_drainPending);
+        shard.worker->setBufferPool(shard.bufferPool);
+        shard.worker->setReceiveBufferSize(m_receiveBufferSize);
+        shard.worker->moveToThread(shard.thread);
+        
+        connect(shard.thread, &QThread::started,
+                shard.worker, &UdpReceiverWorker::start);
+        
+        connect(shard.worker, &UdpReceiverWorker::packetsQueued,
+                this, &UdpTelemetryReceiver::drainPackets);
+        
+        connect(shard.worker, &UdpReceiverWorker::errorOccurred,
+                this, &UdpTelemetryReceiver::errorOccurred);
+        
+        connect(shard.worker, &UdpReceiverWorker::statusChanged,
+                this, &UdpTelemetryReceiver::statusChanged);
+        
+        connect(shard.worker, &UdpReceiverWorker::started,
+                this, &UdpTelemetryReceiver::handleWorkerStarted);
+        
+        m_shards.append(shard);
+        shard.thread->start();
+    }
+}
+
+void UdpTelemetryReceiver::destroyShards()
+{
+    for (const Shard& shard : m_shards) {
+        // Packets already queued to this object are still delivered;
+        // only the lifecycle notifications are dropped
+        disconnect(shard.worker, &UdpReceiverWorker::started,
+                   this, &UdpTelemetryReceiver::handleWorkerStarted);
+        disconnect(shard.worker, &UdpReceiverWorker::statusChanged,
+                   this, &UdpTelemetryReceiver::statusChanged);
+        
+        // Unbind on the worker's own thread; its socket notifier lives there
+        if (shard.thread->isRunning()) {
+            QMetaObject::invokeMethod(shard.worker, "stop", Qt::BlockingQueuedConnection);
+        }
+        shard.thread->quit();
+    }
     
-    connect(m_worker, &UdpReceiverWorker::stopped,
-            this, &UdpTelemetryReceiver::handleWorkerStopped);
+    for (const Shard& shard : m_shards) {
+        shard.thread->wait(3000);
+        if (shard.thread->isRunning()) {
+            shard.thread->terminate();
+            shard.thread->wait();
+        }
+        
+        // The thread has finished, so the worker can be destroyed from here;
+        // anything still queued in its ring is discarded with it
+        delete shard.worker;
+        delete shard.thread;
+        delete shard.ring;
+        delete shard.bufferPool;
+    }
     
-    // Cleanup on thread finish
-    connect(m_workerThread, &QThread::finished,
-            m_worker, &QObject::deleteLater);
+    m_shards.clear();
+    m_drainPending.storeRelease(0);
 }
 
-UdpTelemetryReceiver::~UdpTelemetryReceiver()
+void UdpTelemetryReceiver::setPort(quint16 port)
 {
-    stop();
+    bool restart;
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_port == port) {
+            return;
+        }
+        m_port = port;
+        restart = !m_shards.isEmpty();
+    }
     
-    if (m_workerThread) {
-        m_workerThread->quit();
-        m_workerThread->wait(3000);
-        if (m_workerThread->isRunning()) {
-            m_workerThread->terminate();
-            m_workerThread->wait();
+    // Every shard has to rebind, so restart the whole set
+    if (restart) {
+        stop();
+        start();
+    }
+}
+
+void UdpTelemetryReceiver::setBatchSize(int batchSize)
+{
+    QMutexLocker locker(&m_mutex);
+    
+    batchSize = qBound(1, batchSize, DatagramBatchReader::MaxBatchSize);
+    if (m_batchSize != batchSize) {
+        m_batchSize = batchSize;
+        for (const Shard& shard : m_shards) {
+            UdpReceiverWorker* worker = shard.worker;
+            QMetaObject::invokeMethod(worker, [worker, batchSize]() {
+                worker->setBatchSize(batchSize);
+            }, Qt::QueuedConnection);
         }
     }
 }
 
-void UdpTelemetryReceiver::start()
+void UdpTelemetryReceiver::setShardCount(int shardCount)
 {
     QMutexLocker locker(&m_mutex);
     
-    if (m_running) {
-        qWarning() << "Telemetry receiver already running";
-        return;
+    shardCount = qBound(1, shardCount, maxShardCount());
+    if (shardCount > 1 && !DatagramBatchReader::isSupported()) {
+        qWarning() << "SO_REUSEPORT sharding is only supported on Linux;"
+                   << "using a single receiver";
+        shardCount = 1;
     }
     
-    qInfo() << "Starting UDP telemetry receiver on port" << m_port;
-    m_workerThread->start();
+    m_shardCount = shardCount;
 }
 
-void UdpTelemetryReceiver::stop()
+int UdpTelemetryReceiver::maxShardCount()
+{
+    return qMax(1, QThread::idealThreadCount());
+}
+
+void UdpTelemetryReceiver::setQueueCapacity(int capacity)
+{
+    QMutexLocker locker(&m_mutex);
+    m_queueCapacity = qBound(MinQueueCapacity, capacity, MaxQueueCapacity);
+}
+
+void UdpTelemetryReceiver::setOverflowPolicy(TelemetryPacketRing::OverflowPolicy policy)
+{
+    QMutexLocker locker(&m_mutex);
+    m_overflowPolicy = policy;
+}
+
+void UdpTelemetryReceiver::setBufferPoolSize(int bufferCount)
+{
+    QMutexLocker locker(&m_mutex);
+    m_bufferPoolSize = qBound(MinBufferPoolSize, bufferCount, MaxBufferPoolSize);
+}
+
+void UdpTelemetryReceiver::setReceiveBufferSize(int bytes)
 {
     QMutexLocker locker(&m_mutex);
+    m_receiveBufferSize = qMax(0, bytes);
+}
+
+quint64 UdpTelemetryReceiver::sumCounters(QAtomicInteger<quint64> ReceiverCounters::*counter) const
+{
+    quint64 total = 0;
+    for (const auto& counters : m_shardCounters) {
+        total += ((*counters).*counter).loadRelaxed();
+    }
+    return total;
+}
+
+TelemetryStatistics UdpTelemetryReceiver::statistics() const
+{
+    TelemetryStatistics stats;
     
-    if (!m_running) {
-        return;
+    for (const auto& counters : m_shardCounters) {
+        stats.datagramsReceived += counters->datagramsReceived.loadRelaxed();
+        stats.receiveSyscalls += counters->receiveSyscalls.loadRelaxed();
+        stats.packetsParsed += counters->packetsParsed.loadRelaxed();
+        stats.kernelDrops += counters->kernelDrops.loadRelaxed();
+        stats.queueOverflows += counters->queueOverflows.loadRelaxed();
+        stats.truncatedDatagrams += counters->truncatedDatagrams.loadRelaxed();
+        stats.parseErrors += counters->parseErrors.loadRelaxed();
+        for (int format = 0; format < TelemetryStatistics::FormatCount; ++format) {
+            stats.parseErrorsByFormat[format] += counters->parseErrorsByFormat[format].loadRelaxed();
+        }
     }
     
-    qInfo() << "Stopping UDP telemetry receiver";
-    QMetaObject::invokeMethod(m_worker, "stop", Qt::QueuedConnection);
+    // Every shard is configured alike; the first one always exists
+    stats.receiveBufferSize = m_shardCounters.front()->receiveBufferSize.loadRelaxed();
     
-    m_workerThread->quit();
-    m_workerThread->wait(3000);
+    return stats;
 }
 
-bool UdpTelemetryReceiver::isRunning() const
+quint64 UdpTelemetryReceiver::packetsDropped() const
 {
-    QMutexLocker locker(&m_mutex);
-    return m_running;
+    return sumCounters(&ReceiverCounters::kernelDrops)
+           + sumCounters(&ReceiverCounters::queueOverflows);
 }
 
-void UdpTelemetryReceiver::setPort(quint16 port)
+quint64 UdpTelemetryReceiver::datagramsReceived() const
+{
+    return sumCounters(&ReceiverCounters::datagramsReceived);
+}
+
+quint64 UdpTelemetryReceiver::receiveSyscalls() const
+{
+    return sumCounters(&ReceiverCounters::receiveSyscalls);
+}
+
+double UdpTelemetryReceiver::syscallsPerPacket() const
+{
+    quint64 datagrams = datagramsReceived();
+    if (datagrams == 0) {
+        return 0.0;
+    }
+    return static_cast<double>(receiveSyscalls()) / static_cast<double>(datagrams);
+}
+
+QVector<ShardStatistics> UdpTelemetryReceiver::shardStatistics() const
 {
     QMutexLocker locker(&m_mutex);
     
-    if (m_port != port) {
-        m_port = port;
-        if (m_worker) {
-            QMetaObject::invokeMethod(m_worker, [this, port]() {
-                m_worker->setPort(port);
-            }, Qt::QueuedConnection);
+    QVector<ShardStatistics> result;
+    result.reserve(m_shardCount);
+    
+    for (int i = 0; i < m_shardCount; ++i) {
+        const ReceiverCounters* counters = m_shardCounters[i].get();
+        ShardStatistics stats;
+        stats.datagramsReceived = counters->datagramsReceived.loadRelaxed();
+        stats.receiveSyscalls = counters->receiveSyscalls.loadRelaxed();
+        stats.packetsParsed = counters->packetsParsed.loadRelaxed();
+        stats.parseErrors = counters->parseErrors.loadRelaxed();
+        stats.kernelDrops = counters->kernelDrops.loadRelaxed();
+        stats.queueOverflows = counters->queueOverflows.loadRelaxed();
+        
+        // Pools exist only while the shards do
+        if (i < m_shards.size()) {
+            const DatagramBufferPool::Statistics pool = m_shards[i].bufferPool->statistics();
+            stats.bufferPoolCapacity = pool.capacity;
+            stats.buffersInUse = pool.inUse;
+            stats.bufferHighWaterMark = pool.highWaterMark;
+            stats.bufferPoolExhaustions = pool.exhaustions;
         }
+        
+        result.append(stats);
     }
+    
+    return result;
 }
 
 void UdpTelemetryReceiver::resetStatistics()
 {
     QMutexLocker locker(&m_mutex);
     m_packetsReceived = 0;
-    m_packetsDropped = 0;
+    for (const auto& counters : m_shardCounters) {
+        counters->datagramsReceived.storeRelaxed(0);
+        counters->receiveSyscalls.storeRelaxed(0);
+        counters->packetsParsed.storeRelaxed(0);
+        counters->parseErrors.storeRelaxed(0);
+        for (auto& formatErrors : counters->parseErrorsByFormat) {
+            formatErrors.storeRelaxed(0);
+        }
+        counters->truncatedDatagrams.storeRelaxed(0);
+        counters->kernelDrops.storeRelaxed(0);
+        counters->queueOverflows.storeRelaxed(0);
+    }
+    for (const Shard& shard : m_shards) {
+        shard.bufferPool->resetStatistics();
+    }
 }
 
-void UdpTelemetryReceiver::handlePacketReceived(const TelemetryPacket& packet)
+void UdpTelemetryReceiver::drainPackets()
 {
+    // Clear first: a push after this point schedules a fresh drain
+    m_drainPending.storeRelease(0);
+    
+    QVector<TelemetryPacket> packets;
+    bool backlog = false;
+    
     {
         QMutexLocker locker(&m_mutex);
-        m_packetsReceived++;
+        
+        // Bound the work per event-loop iteration to one ring's worth per shard
+        for (const Shard& shard : m_shards) {
+            const size_t limit = shard.ring->capacity();
+            size_t drained = 0;
+            TelemetryPacket packet;
+            
+            while (drained < limit && shard.ring->pop(packet)) {
+                packets.append(std::move(packet));
+                drained++;
+            }
+            
+            if (drained == limit) {
+                backlog = true;
+            }
+        }
+        
+        m_packetsReceived += packets.size();
+    }
+    
+    // Forward to subscribers outside the lock; shards are drained in turn so
+    // each one's packets keep their arrival order
+    for (const TelemetryPacket& packet : packets) {
+        emit telemetryReceived(packet);
+    }
+    
+    if (!packets.isEmpty()) {
+        emit telemetryBatchReceived(packets);
     }
     
-    // Forward to subscribers (thread-safe signal)
-    emit telemetryReceived(packet);
+    if (backlog && m_drainPending.testAndSetOrdered(0, 1)) {
+        QMetaObject::invokeMethod(this, &UdpTelemetryReceiver::drainPackets,
+                                  Qt::QueuedConnection);
+    }
 }
 
 void UdpTelemetryReceiver::handleWorkerStarted()
 {
+    bool firstShard;
     {
         QMutexLocker locker(&m_mutex);
+        firstShard = (m_shardsStarted++ == 0);
         m_running = true;
     }
-    emit receiverStarted();
-}
-
-void UdpTelemetryReceiver::handleWorkerStopped()
-{
-    {
-        QMutexLocker locker(&m_mutex);
-        m_running = false;
+    
+    if (firstShard) {
+        emit receiverStarted();
     }
-    emit receiverStopped();
 }
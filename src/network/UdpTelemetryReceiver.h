@@ -11,8 +11,57 @@
 #include <QThread>
 #include <QMutex>
 #include <QWaitCondition>
+#include <QAtomicInteger>
+#include <QSocketNotifier>
+#include <QVector>
 #include <memory>
+#include <vector>
 #include "../core/TelemetryPacket.h"
+#include "TelemetryRingBuffer.h"
+#include "DatagramBufferPool.h"
+#include "TelemetryStatistics.h"
+
+class DatagramBatchReader;
+
+typedef TelemetryRingBuffer<TelemetryPacket> TelemetryPacketRing;
+
+/**
+ * @struct ReceiverCounters
+ * @brief Lock-free receive counters shared between receiver and worker
+ * 
+ * Owned by UdpTelemetryReceiver so the counters outlive the worker and
+ * can be read from any thread without locking. One set exists per shard.
+ */
+struct ReceiverCounters {
+    QAtomicInteger<quint64> datagramsReceived;
+    QAtomicInteger<quint64> receiveSyscalls;
+    QAtomicInteger<quint64> packetsParsed;
+    QAtomicInteger<quint64> parseErrors;
+    QAtomicInteger<quint64> parseErrorsByFormat[TelemetryStatistics::FormatCount];
+    QAtomicInteger<quint64> truncatedDatagrams;
+    QAtomicInteger<quint64> kernelDrops;
+    QAtomicInteger<quint64> queueOverflows;
+    QAtomicInt receiveBufferSize;
+};
+
+/**
+ * @struct ShardStatistics
+ * @brief Point-in-time copy of one shard's counters
+ */
+struct ShardStatistics {
+    quint64 datagramsReceived = 0;
+    quint64 receiveSyscalls = 0;
+    quint64 packetsParsed = 0;
+    quint64 parseErrors = 0;
+    quint64 kernelDrops = 0;
+    quint64 queueOverflows = 0;
+    
+    // Receive buffer pool
+    int bufferPoolCapacity = 0;
+    int buffersInUse = 0;
+    int bufferHighWaterMark = 0;
+    quint64 bufferPoolExhaustions = 0;
+};
 
 /**
  * @class UdpReceiverWorker
@@ -20,22 +69,50 @@
  * 
  * Runs in separate thread to avoid blocking the UI.
  * Receives and parses telemetry packets in real-time.
+ * 
+ * On Linux with a batch size greater than one, datagrams are drained
+ * with recvmmsg into preallocated buffers and parsed as a batch.
+ * Otherwise the portable QUdpSocket path reads one datagram at a time.
+ * 
+ * With reusePort set the worker binds its own SO_REUSEPORT socket so
+ * several workers can share the same port (Linux only).
+ * 
+ * Every datagram is accounted for in the shard's ReceiverCounters:
+ * parsed, rejected (by format), truncated, or lost in the kernel or the
+ * hand-off ring. Kernel drops are only observable on the batched path.
+ * 
+ * When an output ring is set, parsed packets are pushed into it and
+ * packetsQueued() is emitted only when the consumer has no drain pending.
+ * Without a ring every packet is emitted through packetReceived().
+ * 
+ * Datagrams are received into buffers from a DatagramBufferPool and held
+ * by reference until parsed, so steady-state reception allocates no
+ * receive buffers. When the pool runs dry the worker falls back to heap
+ * buffers and reports the exhaustion once per episode.
  */
 class UdpReceiverWorker : public QObject
 {
     Q_OBJECT
     
 public:
-    explicit UdpReceiverWorker(quint16 port, QObject* parent = nullptr);
+    explicit UdpReceiverWorker(quint16 port, ReceiverCounters* counters,
+                               bool reusePort = false, QObject* parent = nullptr);
     ~UdpReceiverWorker();
     
+    // Must be called before the worker is moved to its thread
+    void setOutputRing(TelemetryPacketRing* ring, QAtomicInt* drainPending);
+    void setBufferPool(DatagramBufferPool* pool);
+    void setReceiveBufferSize(int bytes);
+    
 public slots:
     void start();
     void stop();
     void setPort(quint16 port);
+    void setBatchSize(int batchSize);
     
 signals:
     void packetReceived(const TelemetryPacket& packet);
+    void packetsQueued();
     void errorOccurred(const QString& error);
     void statusChanged(const QString& status);
     void started();
@@ -43,29 +120,85 @@ signals:
     
 private slots:
     void processPendingDatagrams();
+    void processPendingBatches();
     
 private:
     bool bindSocket();
+    bool bindBatchSocket();
     void unbindSocket();
+    void deliverPacket(const TelemetryPacket& packet);
+    void notifyPacketsQueued();
+    void checkBufferPool();
+    void countParseError(const QByteArray& datagram);
     
     QUdpSocket* m_socket;
     quint16 m_port;
     bool m_running;
+    int m_receiveBufferSize;
     mutable QMutex m_mutex;
+    
+    // Batched receive path (Linux)
+    int m_batchSize;
+    bool m_reusePort;
+    std::unique_ptr<DatagramBatchReader> m_batchReader;
+    QSocketNotifier* m_batchNotifier;
+    QVector<QByteArray> m_batchDatagrams;
+    QVector<DatagramBuffer> m_batchBuffers;
+    
+    // Receive buffers; a private pool is created if none was set
+    DatagramBufferPool* m_bufferPool;
+    std::unique_ptr<DatagramBufferPool> m_ownedBufferPool;
+    quint64 m_reportedExhaustions;
+    bool m_bufferPoolExhausted;
+    
+    ReceiverCounters* m_counters;
+    
+    // Hand-off to the consumer thread
+    TelemetryPacketRing* m_ring;
+    QAtomicInt* m_drainPending;
+    int m_packetsQueued;
 };
 
 /**
  * @class UdpTelemetryReceiver
  * @brief Thread-safe UDP telemetry receiver for defense-grade monitoring
  * 
- * Manages a worker thread that continuously receives telemetry packets
- * and emits thread-safe signals for UI updates.
+ * Manages one or more worker threads that continuously receive telemetry
+ * packets and emit thread-safe signals for UI updates.
+ * 
+ * With a shard count greater than one (Linux only) each worker binds its
+ * own SO_REUSEPORT socket to the same port and the kernel spreads flows
+ * across them. A flow always hashes to the same shard and every shard
+ * delivers in FIFO order, so packets from one subsystem stay in order
+ * when the shard outputs are merged into telemetryReceived().
+ * 
+ * Each shard hands packets over through a bounded lock-free ring. The
+ * owning thread drains all rings at most once per event-loop iteration,
+ * so a burst costs one queued event rather than one per packet. When a
+ * ring is full the overflow policy decides which packet is dropped. Each
+ * drain emits telemetryReceived() per packet and then the whole drain
+ * once through telemetryBatchReceived().
+ * 
+ * statistics() sums every shard's counters with relaxed atomic loads and
+ * never takes the receiver's lock, so it is cheap to poll from any thread.
+ * 
+ * Each shard also owns a pool of receive buffers sized from
+ * bufferPoolSize() and the batch size; occupancy and exhaustion counts
+ * are part of shardStatistics().
+ * 
+ * Workers are created on start() and destroyed on stop().
  */
 class UdpTelemetryReceiver : public QObject
 {
     Q_OBJECT
     
 public:
+    static constexpr int DefaultQueueCapacity = 4096;
+    static constexpr int MinQueueCapacity = 16;
+    static constexpr int MaxQueueCapacity = 1 << 20;
+    static constexpr int MinBufferPoolSize = 16;
+    static constexpr int MaxBufferPoolSize = 1 << 16;
+    
     explicit UdpTelemetryReceiver(quint16 port = 5000, QObject* parent = nullptr);
     ~UdpTelemetryReceiver();
     
@@ -78,31 +211,79 @@ public:
     void setPort(quint16 port);
     quint16 port() const { return m_port; }
     
+    // Number of datagrams drained per recvmmsg call (1 = unbatched)
+    void setBatchSize(int batchSize);
+    int batchSize() const { return m_batchSize; }
+    
+    // Number of SO_REUSEPORT receive shards (applied on next start)
+    void setShardCount(int shardCount);
+    int shardCount() const { return m_shardCount; }
+    static int maxShardCount();
+    
+    // Per-shard hand-off ring (applied on next start)
+    void setQueueCapacity(int capacity);
+    int queueCapacity() const { return m_queueCapacity; }
+    void setOverflowPolicy(TelemetryPacketRing::OverflowPolicy policy);
+    TelemetryPacketRing::OverflowPolicy overflowPolicy() const { return m_overflowPolicy; }
+    
+    // Socket receive buffer in bytes, 0 = system default (applied on next start)
+    void setReceiveBufferSize(int bytes);
+    int receiveBufferSize() const { return m_receiveBufferSize; }
+    
+    // Per-shard receive buffer pool (applied on next start)
+    void setBufferPoolSize(int bufferCount);
+    int bufferPoolSize() const { return m_bufferPoolSize; }
+    
     // Statistics
+    TelemetryStatistics statistics() const;
     quint64 packetsReceived() const { return m_packetsReceived; }
-    quint64 packetsDropped() const { return m_packetsDropped; }
+    quint64 packetsDropped() const;     ///< Kernel drops plus queue overflows
+    quint64 datagramsReceived() const;
+    quint64 receiveSyscalls() const;
+    double syscallsPerPacket() const;
+    QVector<ShardStatistics> shardStatistics() const;
     void resetStatistics();
     
 signals:
     void telemetryReceived(const TelemetryPacket& packet);
+    void telemetryBatchReceived(const QVector<TelemetryPacket>& packets);
     void errorOccurred(const QString& error);
     void statusChanged(const QString& status);
     void receiverStarted();
     void receiverStopped();
     
 private slots:
-    void handlePacketReceived(const TelemetryPacket& packet);
+    void drainPackets();
     void handleWorkerStarted();
-    void handleWorkerStopped();
     
 private:
+    struct Shard {
+        QThread* thread;
+        UdpReceiverWorker* worker;
+        TelemetryPacketRing* ring;
+        DatagramBufferPool* bufferPool;
+    };
+    
+    void createShards();
+    void destroyShards();
+    quint64 sumCounters(QAtomicInteger<quint64> ReceiverCounters::*counter) const;
+    
     quint16 m_port;
+    int m_batchSize;
+    int m_shardCount;
+    int m_queueCapacity;
+    TelemetryPacketRing::OverflowPolicy m_overflowPolicy;
+    int m_bufferPoolSize;
+    int m_receiveBufferSize;
     bool m_running;
+    int m_shardsStarted;
     quint64 m_packetsReceived;
-    quint64 m_packetsDropped;
+    QAtomicInt m_drainPending;
+    
+    QVector<Shard> m_shards;
     
-    QThread* m_workerThread;
-    UdpReceiverWorker* m_worker;
+    // One slot per possible shard, allocated up front and never resized
+    std::vector<std::unique_ptr<ReceiverCounters>> m_shardCounters;
     mutable QMutex m_mutex;
 };
 
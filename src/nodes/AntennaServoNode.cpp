@@ -4,7 +4,16 @@
  */
 
 #include "AntennaServoNode.h"
-#include <QDebug>
+#include "../core/TelemetrySchema.h"
+
+namespace {
+
+const int AzimuthSlot = TelemetrySchema::slotOf(QStringLiteral("azimuth"));
+const int ElevationSlot = TelemetrySchema::slotOf(QStringLiteral("elevation"));
+const int MotorCurrentSlot = TelemetrySchema::slotOf(QStringLiteral("motor_current"));
+const int PositionErrorSlot = TelemetrySchema::slotOf(QStringLiteral("position_error"));
+
+} // namespace
 
 AntennaServoNode::AntennaServoNode(QObject* parent)
     : SubsystemNode(parent)
@@ -57,33 +66,23 @@ QColor AntennaServoNode::nodeColor() const
 
 void AntennaServoNode::onHealthUpdate(const TelemetryPacket& packet)
 {
-    if (packet.hasParameter("azimuth")) {
-        setProperty("azimuth", packet.parameter("azimuth"));
+    if (packet.hasParameter(AzimuthSlot)) {
+        setProperty("azimuth", packet.parameter(AzimuthSlot));
     }
     
-    if (packet.hasParameter("elevation")) {
-        setProperty("elevation", packet.parameter("elevation"));
+    if (packet.hasParameter(ElevationSlot)) {
+        setProperty("elevation", packet.parameter(ElevationSlot));
     }
     
-    if (packet.hasParameter("motor_current")) {
-        double current = packet.current();
-        setProperty("motor_current", current);
-        
-        if (current > 10.0) {  // Amps
-            qWarning() << "Antenna servo motor current high:" << current << "A";
-        }
+    if (packet.hasParameter(MotorCurrentSlot)) {
+        setProperty("motor_current", packet.parameter(MotorCurrentSlot));
     }
     
-    if (packet.hasParameter("position_error")) {
-        double error = packet.parameter("position_error").toDouble();
-        setProperty("position_error", error);
-        
-        if (error > 0.5) {  // degrees
-            qWarning() << "Antenna position error high:" << error << "deg";
-        }
+    if (packet.hasParameter(PositionErrorSlot)) {
+        setProperty("position_error", packet.parameter(PositionErrorSlot));
     }
     
-    if (packet.hasParameter("temperature")) {
+    if (packet.hasParameter(TelemetrySchema::Temperature)) {
         setProperty("temperature", packet.temperature());
     }
 }
@@ -4,7 +4,17 @@
  */
 
 #include "CoolingSystemNode.h"
-#include <QDebug>
+#include "../core/TelemetrySchema.h"
+
+namespace {
+
+const int FanSpeedSlot = TelemetrySchema::slotOf(QStringLiteral("fan_speed"));
+const int CoolantTempSlot = TelemetrySchema::slotOf(QStringLiteral("coolant_temp"));
+const int FlowRateSlot = TelemetrySchema::slotOf(QStringLiteral("flow_rate"));
+const int PumpStatusSlot = TelemetrySchema::slotOf(QStringLiteral("pump_status"));
+const int AmbientTempSlot = TelemetrySchema::slotOf(QStringLiteral("ambient_temp"));
+
+} // namespace
 
 CoolingSystemNode::CoolingSystemNode(QObject* parent)
     : SubsystemNode(parent)
@@ -54,43 +64,23 @@ QColor CoolingSystemNode::nodeColor() const
 
 void CoolingSystemNode::onHealthUpdate(const TelemetryPacket& packet)
 {
-    if (packet.hasParameter("fan_speed")) {
-        int fanSpeed = packet.parameter("fan_speed").toInt();
-        setProperty("fan_speed", fanSpeed);
-        
-        if (fanSpeed < 500) {
-            qWarning() << "Cooling fan speed low:" << fanSpeed << "RPM";
-        }
+    if (packet.hasParameter(FanSpeedSlot)) {
+        setProperty("fan_speed", packet.parameter(FanSpeedSlot).toInt());
     }
     
-    if (packet.hasParameter("coolant_temp")) {
-        double coolantTemp = packet.parameter("coolant_temp").toDouble();
-        setProperty("coolant_temp", coolantTemp);
-        
-        if (coolantTemp > 60.0) {
-            qWarning() << "Coolant temperature high:" << coolantTemp << "°C";
-        }
+    if (packet.hasParameter(CoolantTempSlot)) {
+        setProperty("coolant_temp", packet.parameter(CoolantTempSlot).toDouble());
     }
     
-    if (packet.hasParameter("flow_rate")) {
-        double flowRate = packet.parameter("flow_rate").toDouble();
-        setProperty("flow_rate", flowRate);
-        
-        if (flowRate < 1.0) {
-            qWarning() << "Coolant flow rate low:" << flowRate << "L/min";
-        }
+    if (packet.hasParameter(FlowRateSlot)) {
+        setProperty("flow_rate", packet.parameter(FlowRateSlot).toDouble());
     }
     
-    if (packet.hasParameter("pump_status")) {
-        QString pumpStatus = packet.parameter("pump_status").toString();
-        setProperty("pump_status", pumpStatus);
-        
-        if (pumpStatus != "Running") {
-            qWarning() << "Cooling pump not running:" << pumpStatus;
-        }
+    if (packet.hasParameter(PumpStatusSlot)) {
+        setProperty("pump_status", packet.parameter(PumpStatusSlot).toString());
     }
     
-    if (packet.hasParameter("ambient_temp")) {
-        setProperty("ambient_temp", packet.parameter("ambient_temp"));
+    if (packet.hasParameter(AmbientTempSlot)) {
+        setProperty("ambient_temp", packet.parameter(AmbientTempSlot));
     }
 }
@@ -4,7 +4,15 @@
  */
 
 #include "DataFusionNode.h"
-#include <QDebug>
+#include "../core/TelemetrySchema.h"
+
+namespace {
+
+const int ActiveSourcesSlot = TelemetrySchema::slotOf(QStringLiteral("active_sources"));
+const int FusionQualitySlot = TelemetrySchema::slotOf(QStringLiteral("fusion_quality"));
+const int CpuLoadSlot = TelemetrySchema::slotOf(QStringLiteral("cpu_load"));
+
+} // namespace
 
 DataFusionNode::DataFusionNode(QObject* parent)
     : SubsystemNode(parent)
@@ -57,24 +65,19 @@ QColor DataFusionNode::nodeColor() const
 
 void DataFusionNode::onHealthUpdate(const TelemetryPacket& packet)
 {
-    if (packet.hasParameter("active_sources")) {
-        setProperty("active_sources", packet.parameter("active_sources"));
+    if (packet.hasParameter(ActiveSourcesSlot)) {
+        setProperty("active_sources", packet.parameter(ActiveSourcesSlot));
     }
     
-    if (packet.hasParameter("fusion_quality")) {
-        double quality = packet.parameter("fusion_quality").toDouble();
-        setProperty("fusion_quality", quality);
-        
-        if (quality < 75.0) {
-            qWarning() << "Data fusion quality degraded:" << quality << "%";
-        }
+    if (packet.hasParameter(FusionQualitySlot)) {
+        setProperty("fusion_quality", packet.parameter(FusionQualitySlot).toDouble());
     }
     
-    if (packet.hasParameter("latency")) {
+    if (packet.hasParameter(TelemetrySchema::Latency)) {
         setProperty("latency", packet.latency());
     }
     
-    if (packet.hasParameter("cpu_load")) {
-        setProperty("cpu_load", packet.parameter("cpu_load"));
+    if (packet.hasParameter(CpuLoadSlot)) {
+        setProperty("cpu_load", packet.parameter(CpuLoadSlot));
     }
 }
@@ -4,7 +4,16 @@
  */
 
 #include "EmbeddedControllerNode.h"
-#include <QDebug>
+#include "../core/TelemetrySchema.h"
+
+namespace {
+
+const int CpuLoadSlot = TelemetrySchema::slotOf(QStringLiteral("cpu_load"));
+const int MemoryUsageSlot = TelemetrySchema::slotOf(QStringLiteral("memory_usage"));
+const int UptimeSlot = TelemetrySchema::slotOf(QStringLiteral("uptime"));
+const int WatchdogStatusSlot = TelemetrySchema::slotOf(QStringLiteral("watchdog_status"));
+
+} // namespace
 
 EmbeddedControllerNode::EmbeddedControllerNode(QObject* parent)
     : SubsystemNode(parent)
@@ -56,38 +65,23 @@ QColor EmbeddedControllerNode::nodeColor() const
 
 void EmbeddedControllerNode::onHealthUpdate(const TelemetryPacket& packet)
 {
-    if (packet.hasParameter("cpu_load")) {
-        double cpuLoad = packet.parameter("cpu_load").toDouble();
-        setProperty("cpu_load", cpuLoad);
-        
-        if (cpuLoad > 95.0) {
-            qWarning() << "Embedded controller CPU load critical:" << cpuLoad << "%";
-        }
+    if (packet.hasParameter(CpuLoadSlot)) {
+        setProperty("cpu_load", packet.parameter(CpuLoadSlot).toDouble());
     }
     
-    if (packet.hasParameter("memory_usage")) {
-        double memUsage = packet.parameter("memory_usage").toDouble();
-        setProperty("memory_usage", memUsage);
-        
-        if (memUsage > 90.0) {
-            qWarning() << "Embedded controller memory usage high:" << memUsage << "%";
-        }
+    if (packet.hasParameter(MemoryUsageSlot)) {
+        setProperty("memory_usage", packet.parameter(MemoryUsageSlot).toDouble());
     }
     
-    if (packet.hasParameter("uptime")) {
-        setProperty("uptime", packet.parameter("uptime"));
+    if (packet.hasParameter(UptimeSlot)) {
+        setProperty("uptime", packet.parameter(UptimeSlot));
     }
     
-    if (packet.hasParameter("watchdog_status")) {
-        QString watchdogStatus = packet.parameter("watchdog_status").toString();
-        setProperty("watchdog_status", watchdogStatus);
-        
-        if (watchdogStatus != "OK") {
-            qWarning() << "Watchdog status:" << watchdogStatus;
-        }
+    if (packet.hasParameter(WatchdogStatusSlot)) {
+        setProperty("watchdog_status", packet.parameter(WatchdogStatusSlot).toString());
     }
     
-    if (packet.hasParameter("temperature")) {
+    if (packet.hasParameter(TelemetrySchema::Temperature)) {
         setProperty("temperature", packet.temperature());
     }
 }
@@ -4,7 +4,15 @@
  */
 
 #include "NetworkInterfaceNode.h"
-#include <QDebug>
+#include "../core/TelemetrySchema.h"
+
+namespace {
+
+const int LinkStatusSlot = TelemetrySchema::slotOf(QStringLiteral("link_status"));
+const int BandwidthUtilizationSlot = TelemetrySchema::slotOf(QStringLiteral("bandwidth_utilization"));
+const int PacketLossSlot = TelemetrySchema::slotOf(QStringLiteral("packet_loss"));
+
+} // namespace
 
 NetworkInterfaceNode::NetworkInterfaceNode(QObject* parent)
     : SubsystemNode(parent)
@@ -57,38 +65,23 @@ QColor NetworkInterfaceNode::nodeColor() const
 
 void NetworkInterfaceNode::onHealthUpdate(const TelemetryPacket& packet)
 {
-    if (packet.hasParameter("link_status")) {
-        QString linkStatus = packet.parameter("link_status").toString();
-        setProperty("link_status", linkStatus);
-        
-        if (linkStatus != "Up") {
-            qWarning() << "Network link down";
-        }
+    if (packet.hasParameter(LinkStatusSlot)) {
+        setProperty("link_status", packet.parameter(LinkStatusSlot).toString());
     }
     
-    if (packet.hasParameter("bandwidth_utilization")) {
-        double bwUtil = packet.parameter("bandwidth_utilization").toDouble();
-        setProperty("bandwidth_utilization", bwUtil);
-        
-        if (bwUtil > 85.0) {
-            qWarning() << "Network bandwidth high:" << bwUtil << "%";
-        }
+    if (packet.hasParameter(BandwidthUtilizationSlot)) {
+        setProperty("bandwidth_utilization", packet.parameter(BandwidthUtilizationSlot).toDouble());
     }
     
-    if (packet.hasParameter("packet_loss")) {
-        double packetLoss = packet.parameter("packet_loss").toDouble();
-        setProperty("packet_loss", packetLoss);
-        
-        if (packetLoss > 1.0) {
-            qWarning() << "Network packet loss high:" << packetLoss << "%";
-        }
+    if (packet.hasParameter(PacketLossSlot)) {
+        setProperty("packet_loss", packet.parameter(PacketLossSlot).toDouble());
     }
     
-    if (packet.hasParameter("latency")) {
+    if (packet.hasParameter(TelemetrySchema::Latency)) {
         setProperty("latency", packet.latency());
     }
     
-    if (packet.hasParameter("error_count")) {
+    if (packet.hasParameter(TelemetrySchema::ErrorCount)) {
         setProperty("error_count", packet.errorCount());
     }
 }
@@ -4,7 +4,13 @@
  */
 
 #include "PowerSupplyNode.h"
-#include <QDebug>
+#include "../core/TelemetrySchema.h"
+
+namespace {
+
+const int EfficiencySlot = TelemetrySchema::slotOf(QStringLiteral("efficiency"));
+
+} // namespace
 
 PowerSupplyNode::PowerSupplyNode(QObject* parent)
     : SubsystemNode(parent)
@@ -58,17 +64,11 @@ QColor PowerSupplyNode::nodeColor() const
 
 void PowerSupplyNode::onHealthUpdate(const TelemetryPacket& packet)
 {
-    if (packet.hasParameter("voltage")) {
-        double voltage = packet.voltage();
-        setProperty("voltage_28v", voltage);
-        
-        // Check voltage regulation
-        if (voltage < 26.0 || voltage > 30.0) {
-            qWarning() << "Power supply voltage out of range:" << voltage << "V";
-        }
+    if (packet.hasParameter(TelemetrySchema::Voltage)) {
+        setProperty("voltage_28v", packet.voltage());
     }
     
-    if (packet.hasParameter("current")) {
+    if (packet.hasParameter(TelemetrySchema::Current)) {
         double current = packet.current();
         setProperty("current", current);
         
@@ -77,21 +77,11 @@ void PowerSupplyNode::onHealthUpdate(const TelemetryPacket& packet)
         setProperty("power", voltage * current);
     }
     
-    if (packet.hasParameter("efficiency")) {
-        double efficiency = packet.parameter("efficiency").toDouble();
-        setProperty("efficiency", efficiency);
-        
-        if (efficiency < 80.0) {
-            qWarning() << "Power supply efficiency low:" << efficiency << "%";
-        }
+    if (packet.hasParameter(EfficiencySlot)) {
+        setProperty("efficiency", packet.parameter(EfficiencySlot).toDouble());
     }
     
-    if (packet.hasParameter("temperature")) {
-        double temp = packet.temperature();
-        setProperty("temperature", temp);
-        
-        if (temp > 70.0) {
-            qWarning() << "Power supply temperature high:" << temp << "°C";
-        }
+    if (packet.hasParameter(TelemetrySchema::Temperature)) {
+        setProperty("temperature", packet.temperature());
     }
 }
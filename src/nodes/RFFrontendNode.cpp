@@ -4,7 +4,14 @@
  */
 
 #include "RFFrontendNode.h"
-#include <QDebug>
+#include "../core/TelemetrySchema.h"
+
+namespace {
+
+const int TxPowerSlot = TelemetrySchema::slotOf(QStringLiteral("tx_power"));
+const int VswrSlot = TelemetrySchema::slotOf(QStringLiteral("vswr"));
+
+} // namespace
 
 RFFrontendNode::RFFrontendNode(QObject* parent)
     : SubsystemNode(parent)
@@ -57,28 +64,16 @@ QColor RFFrontendNode::nodeColor() const
 void RFFrontendNode::onHealthUpdate(const TelemetryPacket& packet)
 {
     // Update RF-specific properties from telemetry
-    if (packet.hasParameter("frequency")) {
-        setProperty("frequency", packet.parameter("frequency"));
+    if (packet.hasParameter(TelemetrySchema::Frequency)) {
+        setProperty("frequency", packet.parameter(TelemetrySchema::Frequency));
     }
-    if (packet.hasParameter("tx_power")) {
-        setProperty("tx_power", packet.parameter("tx_power"));
+    if (packet.hasParameter(TxPowerSlot)) {
+        setProperty("tx_power", packet.parameter(TxPowerSlot));
     }
-    if (packet.hasParameter("temperature")) {
-        setProperty("temperature", packet.parameter("temperature"));
-        
-        // Check temperature limits
-        double temp = packet.temperature();
-        if (temp > 85.0) {
-            qWarning() << "RF Frontend temperature critical:" << temp;
-        }
+    if (packet.hasParameter(TelemetrySchema::Temperature)) {
+        setProperty("temperature", packet.parameter(TelemetrySchema::Temperature));
     }
-    if (packet.hasParameter("vswr")) {
-        setProperty("vswr", packet.parameter("vswr"));
-        
-        // Check VSWR
-        double vswr = packet.parameter("vswr").toDouble();
-        if (vswr > 2.0) {
-            qWarning() << "RF Frontend VSWR high:" << vswr;
-        }
+    if (packet.hasParameter(VswrSlot)) {
+        setProperty("vswr", packet.parameter(VswrSlot));
     }
 }
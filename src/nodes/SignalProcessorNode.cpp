@@ -4,7 +4,15 @@
  */
 
 #include "SignalProcessorNode.h"
-#include <QDebug>
+#include "../core/TelemetrySchema.h"
+
+namespace {
+
+const int CpuLoadSlot = TelemetrySchema::slotOf(QStringLiteral("cpu_load"));
+const int BufferUtilizationSlot = TelemetrySchema::slotOf(QStringLiteral("buffer_utilization"));
+const int ErrorRateSlot = TelemetrySchema::slotOf(QStringLiteral("error_rate"));
+
+} // namespace
 
 SignalProcessorNode::SignalProcessorNode(QObject* parent)
     : SubsystemNode(parent)
@@ -57,38 +65,23 @@ QColor SignalProcessorNode::nodeColor() const
 void SignalProcessorNode::onHealthUpdate(const TelemetryPacket& packet)
 {
     // Update processing-specific properties
-    if (packet.hasParameter("cpu_load")) {
-        double load = packet.parameter("cpu_load").toDouble();
-        setProperty("cpu_load", load);
-        
-        if (load > 90.0) {
-            qWarning() << "Signal processor CPU load critical:" << load << "%";
-        }
+    if (packet.hasParameter(CpuLoadSlot)) {
+        setProperty("cpu_load", packet.parameter(CpuLoadSlot).toDouble());
     }
     
-    if (packet.hasParameter("latency")) {
-        int latency = packet.latency();
-        setProperty("latency", latency);
-        
-        if (latency > 100) {  // ms
-            qWarning() << "Signal processor latency high:" << latency << "ms";
-        }
+    if (packet.hasParameter(TelemetrySchema::Latency)) {
+        setProperty("latency", packet.latency());
     }
     
-    if (packet.hasParameter("buffer_utilization")) {
-        double bufferUtil = packet.parameter("buffer_utilization").toDouble();
-        setProperty("buffer_utilization", bufferUtil);
-        
-        if (bufferUtil > 85.0) {
-            qWarning() << "Signal processor buffer utilization high:" << bufferUtil << "%";
-        }
+    if (packet.hasParameter(BufferUtilizationSlot)) {
+        setProperty("buffer_utilization", packet.parameter(BufferUtilizationSlot).toDouble());
     }
     
-    if (packet.hasParameter("temperature")) {
+    if (packet.hasParameter(TelemetrySchema::Temperature)) {
         setProperty("temperature", packet.temperature());
     }
     
-    if (packet.hasParameter("error_rate")) {
-        setProperty("error_rate", packet.parameter("error_rate"));
+    if (packet.hasParameter(ErrorRateSlot)) {
+        setProperty("error_rate", packet.parameter(ErrorRateSlot));
     }
 }
@@ -4,7 +4,17 @@
  */
 
 #include "TrackerNode.h"
-#include <QDebug>
+#include "../core/TelemetrySchema.h"
+
+namespace {
+
+const int TrackCountSlot = TelemetrySchema::slotOf(QStringLiteral("track_count"));
+const int UpdateRateSlot = TelemetrySchema::slotOf(QStringLiteral("update_rate"));
+const int TrackQualitySlot = TelemetrySchema::slotOf(QStringLiteral("track_quality"));
+const int CpuLoadSlot = TelemetrySchema::slotOf(QStringLiteral("cpu_load"));
+const int MemoryUsageSlot = TelemetrySchema::slotOf(QStringLiteral("memory_usage"));
+
+} // namespace
 
 TrackerNode::TrackerNode(QObject* parent)
     : SubsystemNode(parent)
@@ -56,35 +66,23 @@ QColor TrackerNode::nodeColor() const
 
 void TrackerNode::onHealthUpdate(const TelemetryPacket& packet)
 {
-    if (packet.hasParameter("track_count")) {
-        int trackCount = packet.parameter("track_count").toInt();
-        setProperty("track_count", trackCount);
-        
-        int maxTracks = property("max_tracks").toInt();
-        if (trackCount > maxTracks * 0.9) {
-            qWarning() << "Tracker approaching maximum capacity:" 
-                      << trackCount << "/" << maxTracks;
-        }
+    if (packet.hasParameter(TrackCountSlot)) {
+        setProperty("track_count", packet.parameter(TrackCountSlot).toInt());
     }
     
-    if (packet.hasParameter("update_rate")) {
-        setProperty("update_rate", packet.parameter("update_rate"));
+    if (packet.hasParameter(UpdateRateSlot)) {
+        setProperty("update_rate", packet.parameter(UpdateRateSlot));
     }
     
-    if (packet.hasParameter("track_quality")) {
-        double quality = packet.parameter("track_quality").toDouble();
-        setProperty("track_quality", quality);
-        
-        if (quality < 70.0) {
-            qWarning() << "Track quality degraded:" << quality << "%";
-        }
+    if (packet.hasParameter(TrackQualitySlot)) {
+        setProperty("track_quality", packet.parameter(TrackQualitySlot).toDouble());
     }
     
-    if (packet.hasParameter("cpu_load")) {
-        setProperty("cpu_load", packet.parameter("cpu_load"));
+    if (packet.hasParameter(CpuLoadSlot)) {
+        setProperty("cpu_load", packet.parameter(CpuLoadSlot));
     }
     
-    if (packet.hasParameter("memory_usage")) {
-        setProperty("memory_usage", packet.parameter("memory_usage"));
+    if (packet.hasParameter(MemoryUsageSlot)) {
+        setProperty("memory_usage", packet.parameter(MemoryUsageSlot));
     }
 }
@@ -0,0 +1,339 @@
+/**
+ * @file TelemetryCompactor.cpp
+ * @brief Implementation of telemetry store compaction
+ */
+
+#include "TelemetryCompactor.h"
+#include "TelemetrySegment.h"
+#include "TelemetryStore.h"
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QThread>
+#include <QDebug>
+#include <limits>
+#include <memory>
+#include <vector>
+
+namespace {
+
+constexpr qint64 NoTimestamp = std::numeric_limits<qint64>::min();
+
+qint64 floorTo(qint64 timestamp, qint64 width)
+{
+    qint64 offset = timestamp % width;
+    if (offset < 0) {
+        offset += width;
+    }
+    return timestamp - offset;
+}
+
+/**
+ * Accumulates raw samples into buckets of one tier and appends each
+ * finished bucket to the tier's segments. Only samples in
+ * [resumeAt, cutoff) are taken.
+ */
+class RollupSink
+{
+public:
+    RollupSink(const QString& directory, qint64 width, qint64 segmentDuration,
+               qint64 resumeAt, qint64 cutoff)
+        : m_directory(directory)
+        , m_width(width)
+        , m_segmentDuration(segmentDuration)
+        , m_resumeAt(resumeAt)
+        , m_cutoff(cutoff)
+        , m_windowEnd(0)
+        , m_open(false)
+        , m_bucket(0)
+        , m_rowsWritten(0)
+        , m_failed(false)
+    {
+        clearBucket();
+    }
+    
+    qint64 resumeAt() const { return m_resumeAt; }
+    qint64 cutoff() const { return m_cutoff; }
+    bool hasWork() const { return m_resumeAt < m_cutoff; }
+    quint64 rowsWritten() const { return m_rowsWritten; }
+    bool failed() const { return m_failed; }
+    QString errorString() const { return m_errorString; }
+    
+    void add(const qint64* timestamps, const double* values, int count)
+    {
+        for (int i = 0; i < count; ++i) {
+            const qint64 timestamp = timestamps[i];
+            if (timestamp < m_resumeAt || timestamp >= m_cutoff) {
+                continue;
+            }
+            
+            const qint64 bucket = floorTo(timestamp, m_width);
+            if (m_row[RollupCount] > 0 && bucket != m_bucket) {
+                writeRow();
+            }
+            m_bucket = bucket;
+            
+            const double value = values[i];
+            m_row[RollupMinimum] = qMin(m_row[RollupMinimum], value);
+            m_row[RollupMaximum] = qMax(m_row[RollupMaximum], value);
+            m_row[RollupSum] += value;
+            m_row[RollupCount] += 1.0;
+        }
+    }
+    
+    // Write the last bucket; it is complete because it ends at or before the cutoff
+    bool finish()
+    {
+        if (m_row[RollupCount] > 0) {
+            writeRow();
+        }
+        if (m_open && !m_segment.flush()) {
+            fail(m_segment.errorString());
+        }
+        return !m_failed;
+    }
+    
+private:
+    void clearBucket()
+    {
+        m_row[RollupMinimum] = std::numeric_limits<double>::infinity();
+        m_row[RollupMaximum] = -std::numeric_limits<double>::infinity();
+        m_row[RollupSum] = 0.0;
+        m_row[RollupCount] = 0.0;
+    }
+    
+    void fail(const QString& error)
+    {
+        m_failed = true;
+        m_errorString = error;
+    }
+    
+    void writeRow()
+    {
+        if (m_open && (m_bucket >= m_windowEnd || m_segment.isFull())) {
+            if (!m_segment.flush()) {
+                fail(m_segment.errorString());
+            }
+            m_open = false;
+        }
+        
+        if (!m_open && !openSegment(m_bucket)) {
+            clearBucket();
+            return;
+        }
+        
+        m_segment.append(m_bucket, m_row);
+        m_rowsWritten++;
+        clearBucket();
+        
+        if (m_segment.pendingCount() >= TelemetryStoreWriter::FlushThreshold && !m_segment.flush()) {
+            fail(m_segment.errorString());
+        }
+    }
+    
+    bool openSegment(qint64 timestamp)
+    {
+        QDir directory(m_directory);
+        if (!directory.exists() && !directory.mkpath(".")) {
+            fail(QString("Cannot create rollup directory %1").arg(m_directory));
+            return false;
+        }
+        
+        const qint64 window = floorTo(timestamp, m_segmentDuration);
+        m_windowEnd = window + m_segmentDuration;
+        
+        // Continue the newest segment of the tier if it is in this window
+        const QStringList files = directory.entryList(
+            QStringList() << QString("*") + TelemetryStoreReader::SegmentSuffix, QDir::Files);
+        qint64 newest = NoTimestamp;
+        for (const QString& file : files) {
+            bool ok = false;
+            const qint64 first = file.section('.', 0, 0).toLongLong(&ok);
+            if (ok) {
+                newest = qMax(newest, first);
+            }
+        }
+        
+        if (newest != NoTimestamp && floorTo(newest, m_segmentDuration) == window
+            && m_segment.resume(directory.filePath(QString::number(newest) + TelemetryStoreReader::SegmentSuffix),
+                                RollupColumnCount)
+            && timestamp > m_segment.lastTimestamp()) {
+            m_open = true;
+            return true;
+        }
+        
+        const QString path = directory.filePath(QString::number(timestamp) + TelemetryStoreReader::SegmentSuffix);
+        if (!m_segment.create(path, RollupColumnCount)) {
+            fail(m_segment.errorString());
+            return false;
+        }
+        m_open = true;
+        return true;
+    }
+    
+    QString m_directory;
+    qint64 m_width;
+    qint64 m_segmentDuration;
+    qint64 m_resumeAt;
+    qint64 m_cutoff;
+    
+    TelemetrySegmentWriter m_segment;
+    qint64 m_windowEnd;
+    bool m_open;
+    
+    qint64 m_bucket;
+    double m_row[RollupColumnCount];
+    
+    quint64 m_rowsWritten;
+    bool m_failed;
+    QString m_errorString;
+};
+
+} // namespace
+
+qint64 TelemetryRetention::forTier(StoreTier tier) const
+{
+    switch (tier) {
+        case StoreTier::Seconds: return secondsMs;
+        case StoreTier::Minutes: return minutesMs;
+        default: return rawMs;
+    }
+}
+
+TelemetryCompactor::TelemetryCompactor(const QString& rootPath, const TelemetryRetention& retention,
+                                       TelemetryStoreCounters* counters, QObject* parent)
+    : QObject(parent)
+    , m_rootPath(rootPath)
+    , m_retention(retention)
+    , m_counters(counters)
+    , m_timer(nullptr)
+{
+}
+
+void TelemetryCompactor::start()
+{
+    // Created here so the timer belongs to the compactor thread
+    m_timer = new QTimer(this);
+    m_timer->setInterval(CompactionIntervalMs);
+    connect(m_timer, &QTimer::timeout, this, &TelemetryCompactor::compact);
+    m_timer->start();
+    
+    // Catch up on whatever an earlier run left behind
+    QTimer::singleShot(0, this, &TelemetryCompactor::compact);
+}
+
+void TelemetryCompactor::setRetention(const TelemetryRetention& retention)
+{
+    m_retention = retention;
+}
+
+void TelemetryCompactor::compact()
+{
+    const TelemetryStoreReader reader(m_rootPath);
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    
+    for (const QString& subsystemId : reader.subsystems()) {
+        for (const QString& parameter : reader.parameters(subsystemId)) {
+            if (QThread::currentThread()->isInterruptionRequested()) {
+                return;
+            }
+            
+            const qint64 compactedUntil = compactSeries(reader, subsystemId, parameter);
+            expireSeries(reader, subsystemId, parameter, compactedUntil, now);
+        }
+    }
+}
+
+qint64 TelemetryCompactor::compactSeries(const TelemetryStoreReader& reader, const QString& subsystemId,
+                                         const QString& parameter)
+{
+    const qint64 rawLast = reader.lastTimestamp(subsystemId, parameter, StoreTier::Raw);
+    if (rawLast == NoTimestamp) {
+        return NoTimestamp;
+    }
+    
+    struct TierPlan {
+        StoreTier tier;
+        qint64 segmentDuration;
+    };
+    const TierPlan plans[] = {
+        { StoreTier::Seconds, SecondsSegmentDurationMs },
+        { StoreTier::Minutes, MinutesSegmentDurationMs }
+    };
+    
+    std::vector<std::unique_ptr<RollupSink>> sinks;
+    qint64 scanFrom = std::numeric_limits<qint64>::max();
+    qint64 scanTo = NoTimestamp;
+    for (const TierPlan& plan : plans) {
+        const qint64 width = TelemetryStoreReader::tierWidth(plan.tier);
+        const qint64 tierLast = reader.lastTimestamp(subsystemId, parameter, plan.tier);
+        const qint64 resumeAt = tierLast == NoTimestamp ? NoTimestamp : tierLast + width;
+        
+        // Later samples are >= rawLast, so every bucket before rawLast's is final
+        const qint64 cutoff = floorTo(rawLast, width);
+        
+        sinks.emplace_back(new RollupSink(
+            TelemetryStoreReader::seriesPath(m_rootPath, subsystemId, parameter, plan.tier),
+            width, plan.segmentDuration, resumeAt, cutoff));
+        if (sinks.back()->hasWork()) {
+            scanFrom = qMin(scanFrom, resumeAt);
+            scanTo = qMax(scanTo, cutoff - 1);
+        }
+    }
+    
+    if (scanFrom <= scanTo) {
+        const qint64 scanned = reader.scan(subsystemId, parameter, scanFrom, scanTo,
+            [&sinks](const qint64* timestamps, const double* values, int count) {
+                for (const auto& sink : sinks) {
+                    sink->add(timestamps, values, count);
+                }
+            });
+        if (scanned < 0) {
+            qWarning() << "Telemetry compaction skipped" << subsystemId << parameter << ":" << reader.errorString();
+            return NoTimestamp;
+        }
+    }
+    
+    qint64 compactedUntil = std::numeric_limits<qint64>::max();
+    for (const auto& sink : sinks) {
+        const bool ok = sink->finish();
+        m_counters->rollupRowsWritten.fetchAndAddRelaxed(sink->rowsWritten());
+        if (!ok) {
+            m_counters->writeErrors.fetchAndAddRelaxed(1);
+            emit errorOccurred(sink->errorString());
+            return NoTimestamp;
+        }
+        compactedUntil = qMin(compactedUntil, qMax(sink->resumeAt(), sink->cutoff()));
+    }
+    return compactedUntil;
+}
+
+void TelemetryCompactor::expireSeries(const TelemetryStoreReader& reader, const QString& subsystemId,
+                                      const QString& parameter, qint64 compactedUntil, qint64 now)
+{
+    for (int t = 0; t < TelemetryStoreReader::TierCount; ++t) {
+        const StoreTier tier = static_cast<StoreTier>(t);
+        const qint64 retention = m_retention.forTier(tier);
+        if (retention <= 0) {
+            continue;
+        }
+        
+        qint64 limit = now - retention;
+        if (tier == StoreTier::Raw) {
+            limit = qMin(limit, compactedUntil);
+        }
+        
+        // A segment's data ends at the latest where the next one starts, so
+        // the newest segment is never a candidate
+        const QVector<SegmentFileInfo> all = reader.allSegments(subsystemId, parameter, tier);
+        for (int i = 0; i + 1 < all.size() && all[i + 1].firstTimestamp < limit; ++i) {
+            if (QFile::remove(all[i].path)) {
+                m_counters->segmentsExpired.fetchAndAddRelaxed(1);
+            } else {
+                // Retried on the next pass
+                qWarning() << "Cannot remove expired telemetry segment" << all[i].path;
+                break;
+            }
+        }
+    }
+}
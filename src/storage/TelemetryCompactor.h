@@ -0,0 +1,80 @@
+/**
+ * @file TelemetryCompactor.h
+ * @brief Background rollup and retention of the telemetry store
+ */
+
+#ifndef TELEMETRYCOMPACTOR_H
+#define TELEMETRYCOMPACTOR_H
+
+#include <QObject>
+#include <QString>
+#include <QTimer>
+#include "TelemetryStoreReader.h"
+
+struct TelemetryStoreCounters;
+
+/**
+ * @struct TelemetryRetention
+ * @brief How long each tier of the store is kept; 0 keeps it forever
+ */
+struct TelemetryRetention {
+    qint64 rawMs = qint64(24) * 3600 * 1000;
+    qint64 secondsMs = qint64(30) * 24 * 3600 * 1000;
+    qint64 minutesMs = qint64(365) * 24 * 3600 * 1000;
+    
+    qint64 forTier(StoreTier tier) const;
+};
+
+/**
+ * @class TelemetryCompactor
+ * @brief Builds the rollup tiers of a store and expires old segments
+ * 
+ * Every CompactionIntervalMs, each series is scanned from where its
+ * rollup tiers left off and the result is appended as 1 s and 1 min
+ * min/max/sum/count rows. Both tiers are built from raw samples. A bucket
+ * is only written once the raw series has moved past it. Timestamps in a
+ * series never decrease, so a bucket is complete once it is written.
+ * Empty buckets are not written.
+ * 
+ * Segments are then expired oldest first. A segment is removed once all
+ * of its data is older than its tier's retention. Raw segments must also
+ * already be rolled up. The newest segment of every tier is always kept,
+ * so the writer never loses the file it may still append to.
+ * 
+ * Lives on its own thread, so a long pass never delays recording; it
+ * stops between series when the thread is asked to.
+ */
+class TelemetryCompactor : public QObject
+{
+    Q_OBJECT
+    
+public:
+    static constexpr int CompactionIntervalMs = 60 * 1000;
+    static constexpr qint64 SecondsSegmentDurationMs = qint64(6) * 3600 * 1000;
+    static constexpr qint64 MinutesSegmentDurationMs = qint64(30) * 24 * 3600 * 1000;
+    
+    TelemetryCompactor(const QString& rootPath, const TelemetryRetention& retention,
+                       TelemetryStoreCounters* counters, QObject* parent = nullptr);
+    
+public slots:
+    void start();
+    void compact();
+    void setRetention(const TelemetryRetention& retention);
+    
+signals:
+    void errorOccurred(const QString& error);
+    
+private:
+    // Returns the time up to which every tier has rolled up the series
+    qint64 compactSeries(const TelemetryStoreReader& reader, const QString& subsystemId,
+                         const QString& parameter);
+    void expireSeries(const TelemetryStoreReader& reader, const QString& subsystemId,
+                      const QString& parameter, qint64 compactedUntil, qint64 now);
+    
+    QString m_rootPath;
+    TelemetryRetention m_retention;
+    TelemetryStoreCounters* m_counters;
+    QTimer* m_timer;
+};
+
+#endif // TELEMETRYCOMPACTOR_H
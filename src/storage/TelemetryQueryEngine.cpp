@@ -0,0 +1,392 @@
+/**
+ * @file TelemetryQueryEngine.cpp
+ * @brief Implementation of telemetry store queries
+ */
+
+#include "TelemetryQueryEngine.h"
+#include <QDebug>
+#include <algorithm>
+#include <cmath>
+
+void TelemetryAggregate::add(const double* values, int n)
+{
+    if (n <= 0) {
+        return;
+    }
+    
+    // Four independent lanes so the loop is not one long dependency chain
+    double lo[4] = { minimum, minimum, minimum, minimum };
+    double hi[4] = { maximum, maximum, maximum, maximum };
+    double total[4] = { 0.0, 0.0, 0.0, 0.0 };
+    
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        for (int lane = 0; lane < 4; ++lane) {
+            const double v = values[i + lane];
+            lo[lane] = v < lo[lane] ? v : lo[lane];
+            hi[lane] = v > hi[lane] ? v : hi[lane];
+            total[lane] += v;
+        }
+    }
+    for (; i < n; ++i) {
+        lo[0] = qMin(lo[0], values[i]);
+        hi[0] = qMax(hi[0], values[i]);
+        total[0] += values[i];
+    }
+    
+    minimum = qMin(qMin(lo[0], lo[1]), qMin(lo[2], lo[3]));
+    maximum = qMax(qMax(hi[0], hi[1]), qMax(hi[2], hi[3]));
+    sum += (total[0] + total[1]) + (total[2] + total[3]);
+    count += quint64(n);
+}
+
+void TelemetryAggregate::addRollups(const double* const* columns, int n)
+{
+    const double* lo = columns[RollupMinimum];
+    const double* hi = columns[RollupMaximum];
+    const double* total = columns[RollupSum];
+    const double* counts = columns[RollupCount];
+    
+    for (int i = 0; i < n; ++i) {
+        minimum = qMin(minimum, lo[i]);
+        maximum = qMax(maximum, hi[i]);
+        sum += total[i];
+        count += quint64(counts[i]);
+    }
+}
+
+void TelemetryAggregate::merge(const TelemetryAggregate& other)
+{
+    if (other.count == 0) {
+        return;
+    }
+    count += other.count;
+    minimum = qMin(minimum, other.minimum);
+    maximum = qMax(maximum, other.maximum);
+    sum += other.sum;
+}
+
+TelemetryQueryEngine::TelemetryQueryEngine(const QString& storePath, QObject* parent)
+    : QObject(parent)
+    , m_storePath(storePath)
+    , m_pool(new QThreadPool(this))
+    , m_nextQueryId(1)
+{
+}
+
+TelemetryQueryEngine::~TelemetryQueryEngine()
+{
+    cancelAll();
+    m_pool->waitForDone();
+}
+
+void TelemetryQueryEngine::setMaxThreadCount(int threads)
+{
+    m_pool->setMaxThreadCount(qMax(1, threads));
+}
+
+bool TelemetryQueryEngine::validate(const TelemetryQuery& query, QString* errorString)
+{
+    QString error;
+    if (query.parameter.isEmpty()) {
+        error = "No parameter given";
+    } else if (query.to < query.from) {
+        error = "Time range ends before it starts";
+    } else if (query.bucketMs < 0 || (query.bucketMs > 0 && (query.to - query.from) / query.bucketMs >= MaxBuckets)) {
+        error = QString("Rollup interval gives more than %1 buckets").arg(MaxBuckets);
+    } else {
+        for (double p : query.percentiles) {
+            if (!(p >= 0.0 && p <= 100.0)) {
+                error = QString("Percentile %1 out of range").arg(p);
+                break;
+            }
+        }
+    }
+    
+    if (errorString) {
+        *errorString = error;
+    }
+    return error.isEmpty();
+}
+
+StoreTier TelemetryQueryEngine::coarsestTier(const TelemetryQuery& query)
+{
+    if (!query.percentiles.isEmpty()) {
+        return StoreTier::Raw;
+    }
+    
+    // A rollup row must fall inside a single query bucket
+    for (StoreTier tier : { StoreTier::Minutes, StoreTier::Seconds }) {
+        const qint64 width = TelemetryStoreReader::tierWidth(tier);
+        if (query.from % width == 0 && query.bucketMs % width == 0) {
+            return tier;
+        }
+    }
+    return StoreTier::Raw;
+}
+
+int TelemetryQueryEngine::submit(const TelemetryQuery& query)
+{
+    QString error;
+    if (!validate(query, &error)) {
+        qWarning() << "Rejected telemetry query:" << error;
+        return 0;
+    }
+    
+    const int queryId = m_nextQueryId++;
+    QueryState& state = m_queries[queryId];
+    state.result.queryId = queryId;
+    state.result.query = query;
+    state.result.buckets.resize(query.bucketCount());
+    state.result.subsystemsTotal = query.subsystemIds.size();
+    state.cancelled = std::make_shared<QAtomicInt>(0);
+    
+    if (query.subsystemIds.isEmpty()) {
+        // Still asynchronous, so the caller can connect before it finishes
+        QMetaObject::invokeMethod(this, [this, queryId]() { finishQuery(queryId); }, Qt::QueuedConnection);
+        return queryId;
+    }
+    
+    const QString storePath = m_storePath;
+    const std::shared_ptr<QAtomicInt> cancelled = state.cancelled;
+    for (const QString& subsystemId : query.subsystemIds) {
+        m_pool->start([this, storePath, query, subsystemId, cancelled, queryId]() {
+            scanSubsystem(storePath, query, subsystemId, cancelled.get(), [this, queryId](const Partial& partial) {
+                QMetaObject::invokeMethod(this, [this, queryId, partial]() {
+                    mergePartial(queryId, partial);
+                }, Qt::QueuedConnection);
+            });
+        });
+    }
+    return queryId;
+}
+
+void TelemetryQueryEngine::cancel(int queryId)
+{
+    auto it = m_queries.find(queryId);
+    if (it == m_queries.end()) {
+        return;
+    }
+    
+    // Tasks notice between segments; anything they still post is ignored
+    it->cancelled->storeRelaxed(1);
+    TelemetryQueryResult result = it->result;
+    result.finished = true;
+    result.cancelled = true;
+    m_queries.erase(it);
+    emit queryFinished(result);
+}
+
+void TelemetryQueryEngine::cancelAll()
+{
+    const QList<int> ids = m_queries.keys();
+    for (int queryId : ids) {
+        cancel(queryId);
+    }
+}
+
+void TelemetryQueryEngine::mergePartial(int queryId, const Partial& partial)
+{
+    auto it = m_queries.find(queryId);
+    if (it == m_queries.end()) {
+        return;
+    }
+    
+    mergeInto(it->result, it->values, partial);
+    if (it->result.subsystemsDone == it->result.subsystemsTotal) {
+        finishQuery(queryId);
+    } else {
+        emit queryProgress(it->result);
+    }
+}
+
+void TelemetryQueryEngine::finishQuery(int queryId)
+{
+    auto it = m_queries.find(queryId);
+    if (it == m_queries.end()) {
+        return;
+    }
+    
+    TelemetryQueryResult result = it->result;
+    result.percentileValues = computePercentiles(it->values, result.query.percentiles);
+    result.finished = true;
+    m_queries.erase(it);
+    emit queryFinished(result);
+}
+
+void TelemetryQueryEngine::mergeInto(TelemetryQueryResult& result, QVector<double>& values, const Partial& partial)
+{
+    result.total.merge(partial.total);
+    result.bySubsystem[partial.subsystemId].merge(partial.total);
+    for (int i = 0; i < partial.buckets.size(); ++i) {
+        result.buckets[partial.firstBucket + i].merge(partial.buckets[i]);
+    }
+    values += partial.values;
+    
+    if (!partial.errorString.isEmpty()) {
+        result.errorString = partial.errorString;
+    }
+    if (partial.subsystemDone) {
+        result.subsystemsDone++;
+    }
+}
+
+void TelemetryQueryEngine::addToBuckets(Partial& partial, const TelemetryQuery& query, const qint64* timestamps,
+                                        int count, const std::function<void(TelemetryAggregate&, int, int)>& add)
+{
+    add(partial.total, 0, count);
+    if (query.bucketMs <= 0) {
+        return;
+    }
+    
+    // Timestamps are sorted, so each bucket is one contiguous run
+    if (partial.buckets.isEmpty()) {
+        partial.firstBucket = int((timestamps[0] - query.from) / query.bucketMs);
+    }
+    int begin = 0;
+    while (begin < count) {
+        const int bucket = int((timestamps[begin] - query.from) / query.bucketMs);
+        const qint64 bucketEnd = query.from + (qint64(bucket) + 1) * query.bucketMs;
+        const int end = int(std::lower_bound(timestamps + begin, timestamps + count, bucketEnd) - timestamps);
+        
+        const int index = bucket - partial.firstBucket;
+        if (index >= partial.buckets.size()) {
+            partial.buckets.resize(index + 1);
+        }
+        add(partial.buckets[index], begin, end);
+        begin = end;
+    }
+}
+
+void TelemetryQueryEngine::scanSubsystem(const QString& storePath, const TelemetryQuery& query,
+                                         const QString& subsystemId, const QAtomicInt* cancelled,
+                                         const std::function<void(const Partial&)>& report)
+{
+    const TelemetryStoreReader reader(storePath);
+    const bool keepValues = !query.percentiles.isEmpty();
+    
+    // Coarsest tier first, up to the last bucket it has that ends inside
+    // the range; each finer tier continues where the previous one stopped
+    qint64 from = query.from;
+    for (int t = int(coarsestTier(query)); t >= 0 && from <= query.to; --t) {
+        const StoreTier tier = static_cast<StoreTier>(t);
+        const qint64 width = TelemetryStoreReader::tierWidth(tier);
+        
+        qint64 to = query.to;
+        if (tier != StoreTier::Raw) {
+            const qint64 last = reader.lastTimestamp(subsystemId, query.parameter, tier);
+            if (last == std::numeric_limits<qint64>::min()) {
+                continue;
+            }
+            const qint64 lastInRange = query.to - width + 1;
+            if (lastInRange < from) {
+                continue;
+            }
+            to = qMin(last, lastInRange - (lastInRange - from) % width);
+            if (to < from) {
+                continue;
+            }
+        }
+        
+        const QVector<SegmentFileInfo> segments = reader.segments(subsystemId, query.parameter, from, to, tier);
+        for (const SegmentFileInfo& segment : segments) {
+            if (cancelled && cancelled->loadRelaxed()) {
+                return;
+            }
+            
+            Partial partial;
+            partial.subsystemId = subsystemId;
+            
+            qint64 scanned = 0;
+            if (tier == StoreTier::Raw) {
+                scanned = reader.scanSegment(segment, from, to,
+                    [&](const qint64* timestamps, const double* values, int count) {
+                        if (keepValues) {
+                            partial.values.reserve(partial.values.size() + count);
+                            for (int i = 0; i < count; ++i) {
+                                partial.values.append(values[i]);
+                            }
+                        }
+                        addToBuckets(partial, query, timestamps, count,
+                                     [values](TelemetryAggregate& aggregate, int begin, int end) {
+                            aggregate.add(values + begin, end - begin);
+                        });
+                    });
+            } else {
+                scanned = reader.scanRollupSegment(segment, from, to,
+                    [&](const qint64* timestamps, const double* const* columns, int count) {
+                        addToBuckets(partial, query, timestamps, count,
+                                     [columns](TelemetryAggregate& aggregate, int begin, int end) {
+                            const double* run[RollupColumnCount];
+                            for (int column = 0; column < RollupColumnCount; ++column) {
+                                run[column] = columns[column] + begin;
+                            }
+                            aggregate.addRollups(run, end - begin);
+                        });
+                    });
+            }
+            
+            if (scanned < 0) {
+                partial.errorString = reader.errorString();
+            }
+            if (scanned != 0) {
+                report(partial);
+            }
+        }
+        
+        from = width > 0 ? to + width : to + 1;
+    }
+    
+    Partial done;
+    done.subsystemId = subsystemId;
+    done.subsystemDone = true;
+    report(done);
+}
+
+QVector<double> TelemetryQueryEngine::computePercentiles(QVector<double> values, const QVector<double>& percentiles)
+{
+    QVector<double> result;
+    if (values.isEmpty()) {
+        result.fill(std::numeric_limits<double>::quiet_NaN(), percentiles.size());
+        return result;
+    }
+    
+    // Linear interpolation between closest ranks; nth_element keeps it O(n) per percentile
+    for (double p : percentiles) {
+        const double rank = p / 100.0 * (values.size() - 1);
+        const int lower = int(std::floor(rank));
+        const int upper = qMin(lower + 1, int(values.size()) - 1);
+        
+        std::nth_element(values.begin(), values.begin() + lower, values.end());
+        const double lowerValue = values[lower];
+        const double upperValue = upper == lower ? lowerValue
+                                  : *std::min_element(values.begin() + lower + 1, values.end());
+        result.append(lowerValue + (rank - lower) * (upperValue - lowerValue));
+    }
+    return result;
+}
+
+TelemetryQueryResult TelemetryQueryEngine::execute(const QString& storePath, const TelemetryQuery& query)
+{
+    TelemetryQueryResult result;
+    result.query = query;
+    
+    if (!validate(query, &result.errorString)) {
+        result.finished = true;
+        return result;
+    }
+    
+    result.buckets.resize(query.bucketCount());
+    result.subsystemsTotal = query.subsystemIds.size();
+    
+    QVector<double> values;
+    for (const QString& subsystemId : query.subsystemIds) {
+        scanSubsystem(storePath, query, subsystemId, nullptr, [&](const Partial& partial) {
+            mergeInto(result, values, partial);
+        });
+    }
+    
+    result.percentileValues = computePercentiles(values, query.percentiles);
+    result.finished = true;
+    return result;
+}
@@ -0,0 +1,160 @@
+/**
+ * @file TelemetryQueryEngine.h
+ * @brief Time-range aggregation over the telemetry store
+ */
+
+#ifndef TELEMETRYQUERYENGINE_H
+#define TELEMETRYQUERYENGINE_H
+
+#include <QObject>
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QThreadPool>
+#include <QVector>
+#include <QAtomicInt>
+#include "TelemetryStoreReader.h"
+#include <functional>
+#include <limits>
+#include <memory>
+
+/**
+ * @struct TelemetryQuery
+ * @brief One parameter over a set of subsystems and a time range
+ */
+struct TelemetryQuery {
+    QStringList subsystemIds;
+    QString parameter;
+    qint64 from = 0;                ///< ms since epoch, inclusive
+    qint64 to = 0;                  ///< ms since epoch, inclusive
+    qint64 bucketMs = 0;            ///< Rollup interval; 0 = whole range only
+    QVector<double> percentiles;    ///< Each in [0, 100]
+    
+    int bucketCount() const { return bucketMs > 0 ? int((to - from) / bucketMs) + 1 : 0; }
+};
+
+/**
+ * @struct TelemetryAggregate
+ * @brief Count, extremes and sum of a set of samples
+ */
+struct TelemetryAggregate {
+    quint64 count = 0;
+    double minimum = std::numeric_limits<double>::infinity();
+    double maximum = -std::numeric_limits<double>::infinity();
+    double sum = 0.0;
+    
+    double mean() const { return count ? sum / count : 0.0; }
+    bool isEmpty() const { return count == 0; }
+    
+    void add(const double* values, int n);
+    void addRollups(const double* const* columns, int n);     ///< Indexed by RollupColumn
+    void merge(const TelemetryAggregate& other);
+};
+
+/**
+ * @struct TelemetryQueryResult
+ * @brief Result of a query so far, or in full once finished is set
+ */
+struct TelemetryQueryResult {
+    int queryId = 0;
+    TelemetryQuery query;
+    TelemetryAggregate total;
+    QVector<TelemetryAggregate> buckets;            ///< buckets[i] starts at from + i * bucketMs
+    QHash<QString, TelemetryAggregate> bySubsystem;
+    QVector<double> percentileValues;               ///< Parallel to query.percentiles; final result only
+    int subsystemsDone = 0;
+    int subsystemsTotal = 0;
+    bool finished = false;
+    bool cancelled = false;
+    QString errorString;
+};
+
+/**
+ * @class TelemetryQueryEngine
+ * @brief Runs aggregation queries against a TelemetryStore directory
+ * 
+ * submit() splits a query into one task per subsystem on the engine's
+ * thread pool. Each task walks its subsystem's segments in time order,
+ * aggregates every memory-mapped run of samples in a tight loop over the
+ * value column and posts the partial result back after each segment. The
+ * engine merges partials on its own thread and emits queryProgress() for
+ * each, then queryFinished() once every subsystem is done, so a long
+ * range fills in gradually instead of blocking the caller.
+ * 
+ * Each subsystem is read from the coarsest tier that still gives the
+ * requested buckets exactly (see coarsestTier()), up to where that tier
+ * has been compacted, and the rest of the range from the next finer
+ * tiers. Ranges longer than the raw retention therefore still work.
+ * 
+ * Percentiles need every sample of the range in memory, so queries that
+ * ask for them read the raw tier only; they are computed for the final
+ * result. Only flushed samples are visible (see TelemetryStoreWriter),
+ * so the last second or so may be missing.
+ * 
+ * execute() runs the same scan synchronously on the calling thread.
+ */
+class TelemetryQueryEngine : public QObject
+{
+    Q_OBJECT
+    
+public:
+    static constexpr int MaxBuckets = 100000;
+    
+    explicit TelemetryQueryEngine(const QString& storePath, QObject* parent = nullptr);
+    ~TelemetryQueryEngine();
+    
+    QString storePath() const { return m_storePath; }
+    void setMaxThreadCount(int threads);
+    
+    // Returns the query ID, 0 if the query is invalid
+    int submit(const TelemetryQuery& query);
+    void cancel(int queryId);
+    void cancelAll();
+    bool isRunning(int queryId) const { return m_queries.contains(queryId); }
+    
+    static TelemetryQueryResult execute(const QString& storePath, const TelemetryQuery& query);
+    static bool validate(const TelemetryQuery& query, QString* errorString = nullptr);
+    
+    // Coarsest tier whose buckets line up with the query's range and rollup interval
+    static StoreTier coarsestTier(const TelemetryQuery& query);
+    
+signals:
+    void queryProgress(const TelemetryQueryResult& result);
+    void queryFinished(const TelemetryQueryResult& result);
+    
+private:
+    struct QueryState {
+        TelemetryQueryResult result;
+        QVector<double> values;                 ///< For percentiles
+        std::shared_ptr<QAtomicInt> cancelled;
+    };
+    
+    // Samples one subsystem task found since its last report
+    struct Partial {
+        QString subsystemId;
+        TelemetryAggregate total;
+        int firstBucket = 0;                    ///< Index of buckets[0] in the result
+        QVector<TelemetryAggregate> buckets;
+        QVector<double> values;
+        bool subsystemDone = false;
+        QString errorString;
+    };
+    
+    void mergePartial(int queryId, const Partial& partial);
+    void finishQuery(int queryId);
+    
+    static void mergeInto(TelemetryQueryResult& result, QVector<double>& values, const Partial& partial);
+    static void addToBuckets(Partial& partial, const TelemetryQuery& query, const qint64* timestamps,
+                             int count, const std::function<void(TelemetryAggregate&, int, int)>& add);
+    static void scanSubsystem(const QString& storePath, const TelemetryQuery& query,
+                              const QString& subsystemId, const QAtomicInt* cancelled,
+                              const std::function<void(const Partial&)>& report);
+    static QVector<double> computePercentiles(QVector<double> values, const QVector<double>& percentiles);
+    
+    QString m_storePath;
+    QThreadPool* m_pool;
+    QHash<int, QueryState> m_queries;
+    int m_nextQueryId;
+};
+
+#endif // TELEMETRYQUERYENGINE_H
@@ -0,0 +1,273 @@
+/**
+ * @file TelemetrySegment.cpp
+ * @brief Implementation of telemetry segment files
+ */
+
+#include "TelemetrySegment.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+bool isValidHeader(const SegmentHeader& header)
+{
+    return header.magic == SegmentHeader::Magic
+           && header.version >= 1 && header.version <= SegmentHeader::CurrentVersion
+           && header.headerSize == SegmentHeader::HeaderSize
+           && header.capacity == quint32(SegmentHeader::Capacity)
+           && header.count <= quint32(SegmentHeader::Capacity)
+           && header.columns <= quint32(SegmentHeader::MaxColumns);
+}
+
+} // namespace
+
+TelemetrySegmentWriter::TelemetrySegmentWriter()
+    : m_created(false)
+{
+    std::memset(&m_header, 0, sizeof(m_header));
+}
+
+bool TelemetrySegmentWriter::create(const QString& path, int columns)
+{
+    m_path = path;
+    m_created = false;
+    m_pendingTimestamps.clear();
+    for (QVector<double>& column : m_pendingValues) {
+        column.clear();
+    }
+    m_errorString.clear();
+    
+    std::memset(&m_header, 0, sizeof(m_header));
+    m_header.magic = SegmentHeader::Magic;
+    m_header.version = SegmentHeader::CurrentVersion;
+    m_header.headerSize = SegmentHeader::HeaderSize;
+    m_header.capacity = SegmentHeader::Capacity;
+    m_header.columns = quint32(qBound(1, columns, SegmentHeader::MaxColumns));
+    
+    // The file itself appears on the first flush
+    if (QFile::exists(path)) {
+        m_errorString = QString("Segment %1 already exists").arg(path);
+        return false;
+    }
+    return true;
+}
+
+bool TelemetrySegmentWriter::resume(const QString& path, int columns)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly) || file.size() != SegmentHeader::fileSize(columns)) {
+        return false;
+    }
+    
+    SegmentHeader header;
+    if (file.read(reinterpret_cast<char*>(&header), sizeof(header)) != qint64(sizeof(header))
+        || !isValidHeader(header) || header.columnCount() != columns || header.count == 0
+        || header.count >= quint32(SegmentHeader::Capacity)) {
+        return false;
+    }
+    
+    // Rewritten in the current version on the next flush
+    header.version = SegmentHeader::CurrentVersion;
+    header.columns = quint32(columns);
+    
+    m_path = path;
+    m_header = header;
+    m_created = true;
+    m_pendingTimestamps.clear();
+    for (QVector<double>& column : m_pendingValues) {
+        column.clear();
+    }
+    m_errorString.clear();
+    return true;
+}
+
+bool TelemetrySegmentWriter::append(qint64 timestamp, double value)
+{
+    return append(timestamp, &value);
+}
+
+bool TelemetrySegmentWriter::append(qint64 timestamp, const double* values)
+{
+    if (isFull()) {
+        return false;
+    }
+    
+    if (count() == 0) {
+        m_header.firstTimestamp = timestamp;
+    }
+    m_pendingTimestamps.append(timestamp);
+    for (int column = 0; column < columnCount(); ++column) {
+        m_pendingValues[column].append(values[column]);
+    }
+    return true;
+}
+
+qint64 TelemetrySegmentWriter::lastTimestamp() const
+{
+    return m_pendingTimestamps.isEmpty() ? m_header.lastTimestamp : m_pendingTimestamps.last();
+}
+
+bool TelemetrySegmentWriter::flush()
+{
+    if (m_pendingTimestamps.isEmpty()) {
+        return true;
+    }
+    
+    const int first = int(m_header.count);
+    const int pending = m_pendingTimestamps.size();
+    const int columns = columnCount();
+    
+    QFile file(m_path);
+    bool ok = file.open(QIODevice::ReadWrite);
+    
+    // A valid empty header first, so a crash before the first full flush
+    // leaves a segment readers skip rather than reject. Then full size up
+    // front: the columns stay at fixed offsets and the untouched tail
+    // stays sparse on disk.
+    if (ok && !m_created) {
+        ok = file.write(reinterpret_cast<const char*>(&m_header), sizeof(m_header)) == qint64(sizeof(m_header))
+             && file.resize(SegmentHeader::fileSize(columns));
+        m_created = ok;
+    }
+    
+    ok = ok && file.seek(SegmentHeader::timestampOffset(first))
+         && file.write(reinterpret_cast<const char*>(m_pendingTimestamps.constData()),
+                       pending * qint64(sizeof(qint64))) == pending * qint64(sizeof(qint64));
+    for (int column = 0; ok && column < columns; ++column) {
+        ok = file.seek(SegmentHeader::valueOffset(first, column))
+             && file.write(reinterpret_cast<const char*>(m_pendingValues[column].constData()),
+                           pending * qint64(sizeof(double))) == pending * qint64(sizeof(double));
+    }
+    
+    if (ok) {
+        for (int i = 0; i < pending; ++i) {
+            const int index = first + i;
+            if (index % SegmentHeader::IndexStride == 0) {
+                m_header.sparseIndex[index / SegmentHeader::IndexStride] = m_pendingTimestamps[i];
+            }
+        }
+        
+        SegmentHeader header = m_header;
+        header.count = quint32(first + pending);
+        header.lastTimestamp = m_pendingTimestamps.last();
+        
+        // Header last, so the new count never covers unwritten samples
+        ok = file.seek(0)
+             && file.write(reinterpret_cast<const char*>(&header), sizeof(header)) == qint64(sizeof(header));
+        if (ok) {
+            m_header = header;
+        }
+    }
+    
+    if (!ok) {
+        m_errorString = QString("Failed to write segment %1: %2").arg(m_path, file.errorString());
+    }
+    
+    // Failed samples are dropped rather than retried so memory stays bounded
+    m_pendingTimestamps.clear();
+    for (int column = 0; column < columns; ++column) {
+        m_pendingValues[column].clear();
+    }
+    return ok;
+}
+
+TelemetrySegment::TelemetrySegment()
+    : m_map(nullptr)
+    , m_header(nullptr)
+    , m_count(0)
+{
+}
+
+TelemetrySegment::~TelemetrySegment()
+{
+    close();
+}
+
+bool TelemetrySegment::open(const QString& path)
+{
+    close();
+    
+    m_file.reset(new QFile(path));
+    if (!m_file->open(QIODevice::ReadOnly)) {
+        m_errorString = QString("Cannot open segment %1: %2").arg(path, m_file->errorString());
+        m_file.reset();
+        return false;
+    }
+    
+    if (m_file->size() < SegmentHeader::fileSize()) {
+        m_errorString = QString("Segment %1 has unexpected size %2").arg(path).arg(m_file->size());
+        m_file.reset();
+        return false;
+    }
+    
+    m_map = m_file->map(0, m_file->size());
+    if (!m_map) {
+        m_errorString = QString("Cannot map segment %1: %2").arg(path, m_file->errorString());
+        m_file.reset();
+        return false;
+    }
+    
+    const SegmentHeader* header = reinterpret_cast<const SegmentHeader*>(m_map);
+    if (!isValidHeader(*header) || m_file->size() != SegmentHeader::fileSize(header->columnCount())) {
+        m_errorString = QString("Segment %1 has an invalid header").arg(path);
+        close();
+        return false;
+    }
+    
+    m_header = header;
+    m_count = int(header->count);
+    return true;
+}
+
+void TelemetrySegment::close()
+{
+    if (m_file) {
+        if (m_map) {
+            m_file->unmap(m_map);
+        }
+        m_file.reset();
+    }
+    m_map = nullptr;
+    m_header = nullptr;
+    m_count = 0;
+}
+
+qint64 TelemetrySegment::firstTimestamp() const
+{
+    return m_count > 0 ? timestamps()[0] : 0;
+}
+
+qint64 TelemetrySegment::lastTimestamp() const
+{
+    return m_count > 0 ? timestamps()[m_count - 1] : 0;
+}
+
+const qint64* TelemetrySegment::timestamps() const
+{
+    return reinterpret_cast<const qint64*>(m_map + SegmentHeader::timestampOffset(0));
+}
+
+const double* TelemetrySegment::values(int column) const
+{
+    return reinterpret_cast<const double*>(m_map + SegmentHeader::valueOffset(0, column));
+}
+
+int TelemetrySegment::lowerBound(qint64 t) const
+{
+    if (m_count == 0) {
+        return 0;
+    }
+    
+    // The sparse index picks the stride, the column is searched only inside
+    // it. The first index entry >= t bounds the answer from above; the one
+    // before it is < t, so the answer lies in the stride ending there, even
+    // when t repeats across the stride boundary.
+    const int entries = (m_count + SegmentHeader::IndexStride - 1) / SegmentHeader::IndexStride;
+    const qint64* index = m_header->sparseIndex;
+    const int stride = int(std::lower_bound(index, index + entries, t) - index);
+    
+    const int begin = stride == 0 ? 0 : (stride - 1) * SegmentHeader::IndexStride;
+    const int end = qMin(m_count, stride * SegmentHeader::IndexStride);
+    const qint64* column = timestamps();
+    return int(std::lower_bound(column + begin, column + end, t) - column);
+}
@@ -0,0 +1,148 @@
+/**
+ * @file TelemetrySegment.h
+ * @brief On-disk column segment of one telemetry parameter
+ */
+
+#ifndef TELEMETRYSEGMENT_H
+#define TELEMETRYSEGMENT_H
+
+#include <QString>
+#include <QVector>
+#include <QFile>
+#include <memory>
+
+/**
+ * @struct SegmentHeader
+ * @brief First page of every segment file
+ * 
+ * A segment file is laid out as
+ * 
+ *   [header, HeaderSize bytes][timestamps, capacity x qint64]
+ *   [value column 0, capacity x double]...[value column n-1, capacity x double]
+ * 
+ * so every column starts page-aligned and can be read straight out of a
+ * memory map. Raw series have one value column; rollup series have one
+ * per statistic. sparseIndex[i] is the timestamp of sample i * IndexStride,
+ * which narrows a time lookup to one stride before any column page is
+ * touched. Files use host byte order; magic rejects a foreign one.
+ * 
+ * Version 1 files predate the columns field, which reads as 0 there and
+ * means a single value column.
+ */
+struct SegmentHeader {
+    static constexpr quint32 Magic = 0x53544852;    ///< "RHTS" read in host order
+    static constexpr quint16 CurrentVersion = 2;
+    static constexpr int HeaderSize = 4096;
+    static constexpr int Capacity = 65536;
+    static constexpr int IndexStride = 1024;
+    static constexpr int IndexEntries = Capacity / IndexStride;
+    static constexpr int MaxColumns = 8;
+    
+    quint32 magic;
+    quint16 version;
+    quint16 headerSize;
+    quint32 capacity;
+    quint32 count;
+    qint64 firstTimestamp;
+    qint64 lastTimestamp;
+    qint64 sparseIndex[IndexEntries];
+    quint32 columns;
+    
+    int columnCount() const { return columns == 0 ? 1 : int(columns); }
+    
+    static qint64 fileSize(int columns = 1) { return HeaderSize + qint64(Capacity) * (sizeof(qint64) + columns * sizeof(double)); }
+    static qint64 timestampOffset(int index) { return HeaderSize + qint64(index) * sizeof(qint64); }
+    static qint64 valueOffset(int index, int column = 0)
+    {
+        return HeaderSize + qint64(Capacity) * (sizeof(qint64) + column * sizeof(double)) + qint64(index) * sizeof(double);
+    }
+};
+
+static_assert(sizeof(SegmentHeader) <= SegmentHeader::HeaderSize, "segment header must fit its page");
+
+/**
+ * @class TelemetrySegmentWriter
+ * @brief Appends samples to one segment file
+ * 
+ * Samples are buffered in memory and written by flush(), columns first
+ * and the header last, so a reader never sees a count that covers
+ * unwritten samples. A new file gets a header with count 0 before it is
+ * sized. The file is only open during flush(), which keeps
+ * the number of descriptors independent of the number of series.
+ * 
+ * Timestamps must not decrease; the caller filters late samples.
+ * append() takes one value per column of the segment.
+ */
+class TelemetrySegmentWriter
+{
+public:
+    TelemetrySegmentWriter();
+    
+    // Start a new segment file, or continue an existing one that is not full
+    bool create(const QString& path, int columns = 1);
+    bool resume(const QString& path, int columns = 1);
+    
+    bool append(qint64 timestamp, double value);    ///< false when full
+    bool append(qint64 timestamp, const double* values);
+    bool flush();
+    
+    QString path() const { return m_path; }
+    int columnCount() const { return m_header.columnCount(); }
+    int count() const { return int(m_header.count) + m_pendingTimestamps.size(); }
+    bool isFull() const { return count() >= SegmentHeader::Capacity; }
+    int pendingCount() const { return m_pendingTimestamps.size(); }
+    bool hasPending() const { return !m_pendingTimestamps.isEmpty(); }
+    qint64 firstTimestamp() const { return m_header.firstTimestamp; }
+    qint64 lastTimestamp() const;
+    QString errorString() const { return m_errorString; }
+    
+private:
+    QString m_path;
+    SegmentHeader m_header;
+    bool m_created;
+    QVector<qint64> m_pendingTimestamps;
+    QVector<double> m_pendingValues[SegmentHeader::MaxColumns];
+    QString m_errorString;
+};
+
+/**
+ * @class TelemetrySegment
+ * @brief Read-only memory map of a segment file
+ * 
+ * The sample count is taken when the segment is opened. A segment that is
+ * still being written can be reopened to see samples flushed since.
+ */
+class TelemetrySegment
+{
+public:
+    TelemetrySegment();
+    ~TelemetrySegment();
+    
+    bool open(const QString& path);
+    void close();
+    bool isOpen() const { return m_header != nullptr; }
+    
+    int count() const { return m_count; }
+    int columnCount() const { return m_header ? m_header->columnCount() : 0; }
+    qint64 firstTimestamp() const;
+    qint64 lastTimestamp() const;
+    const qint64* timestamps() const;
+    const double* values(int column = 0) const;
+    
+    // First sample with timestamp >= t (count() if none)
+    int lowerBound(qint64 t) const;
+    
+    QString errorString() const { return m_errorString; }
+    
+    TelemetrySegment(const TelemetrySegment&) = delete;
+    TelemetrySegment& operator=(const TelemetrySegment&) = delete;
+    
+private:
+    std::unique_ptr<QFile> m_file;
+    uchar* m_map;
+    const SegmentHeader* m_header;
+    int m_count;
+    QString m_errorString;
+};
+
+#endif // TELEMETRYSEGMENT_H
@@ -0,0 +1,436 @@
+/**
+ * @file TelemetryStore.cpp
+ * @brief Implementation of the persistent telemetry store
+ */
+
+#include "TelemetryStore.h"
+#include "TelemetryStoreReader.h"
+#include "../core/TelemetrySchema.h"
+#include "../core/IdInterner.h"
+#include <QDateTime>
+#include <QDir>
+#include <QStandardPaths>
+#include <QtAlgorithms>
+#include <QDebug>
+#include <limits>
+
+namespace {
+
+// Column of the health code series, after every schema slot
+constexpr int HealthColumn = TelemetrySchema::MaxSlots;
+
+quint64 seriesKey(quint32 subsystemHandle, int column)
+{
+    return (quint64(subsystemHandle) << 8) | quint64(column);
+}
+
+} // namespace
+
+TelemetryStoreWriter::TelemetryStoreWriter(const QString& rootPath, qint64 segmentDurationMs,
+                                           TelemetryStoreQueue* queue, QAtomicInt* drainPending,
+                                           TelemetryStoreCounters* counters, QObject* parent)
+    : QObject(parent)
+    , m_rootPath(rootPath)
+    , m_segmentDurationMs(segmentDurationMs)
+    , m_queue(queue)
+    , m_drainPending(drainPending)
+    , m_counters(counters)
+    , m_flushTimer(nullptr)
+    , m_seriesCount(0)
+{
+}
+
+TelemetryStoreWriter::~TelemetryStoreWriter()
+{
+    qDeleteAll(m_series);
+}
+
+void TelemetryStoreWriter::start()
+{
+    // Created here so the timer belongs to the writer thread
+    m_flushTimer = new QTimer(this);
+    m_flushTimer->setInterval(FlushIntervalMs);
+    connect(m_flushTimer, &QTimer::timeout, this, &TelemetryStoreWriter::flushAll);
+    m_flushTimer->start();
+}
+
+void TelemetryStoreWriter::stop()
+{
+    if (m_flushTimer) {
+        m_flushTimer->stop();
+    }
+    drain();
+    flushAll();
+}
+
+void TelemetryStoreWriter::drain()
+{
+    // Clear first: a push after this point schedules a fresh drain
+    m_drainPending->storeRelease(0);
+    
+    TelemetryPacket packet;
+    while (m_queue->pop(packet)) {
+        writePacket(packet);
+    }
+    
+    // Large backlogs go out now; the rest waits for the flush timer
+    int kept = 0;
+    for (Series* series : m_dirtySeries) {
+        if (series->segment.pendingCount() >= FlushThreshold) {
+            flushSeries(*series);
+        } else {
+            m_dirtySeries[kept++] = series;
+        }
+    }
+    m_dirtySeries.resize(kept);
+}
+
+void TelemetryStoreWriter::flushAll()
+{
+    for (Series* series : m_dirtySeries) {
+        flushSeries(*series);
+    }
+    m_dirtySeries.clear();
+}
+
+void TelemetryStoreWriter::writePacket(const TelemetryPacket& packet)
+{
+    const quint32 handle = packet.subsystemHandle();
+    if (handle == IdInterner::InvalidHandle) {
+        return;
+    }
+    
+    qint64 timestamp = packet.timestamp();
+    if (timestamp <= 0) {
+        timestamp = QDateTime::currentMSecsSinceEpoch();
+    }
+    
+    const QString subsystemId = packet.subsystemId();
+    for (quint64 present = packet.presentSlots(); present; present &= present - 1) {
+        const int slot = qCountTrailingZeroBits(present);
+        appendSample(handle, subsystemId, slot, timestamp, packet.parameterValue(slot));
+    }
+    appendSample(handle, subsystemId, HealthColumn, timestamp, static_cast<int>(packet.healthCode()));
+    
+    m_counters->packetsWritten.fetchAndAddRelaxed(1);
+}
+
+void TelemetryStoreWriter::appendSample(quint32 subsystemHandle, const QString& subsystemId, int column,
+                                        qint64 timestamp, double value)
+{
+    Series* target = series(subsystemHandle, subsystemId, column);
+    
+    if (target->open && timestamp < target->segment.lastTimestamp()) {
+        m_counters->samplesOutOfOrder.fetchAndAddRelaxed(1);
+        return;
+    }
+    
+    // Roll over at the end of the time window or when the segment is full
+    if (target->open && (timestamp >= target->windowEnd || target->segment.isFull())) {
+        flushSeries(*target);
+        target->open = false;
+    }
+    
+    if (!target->open && !openSegment(*target, timestamp)) {
+        m_counters->writeErrors.fetchAndAddRelaxed(1);
+        return;
+    }
+    
+    target->segment.append(timestamp, value);
+    if (!target->dirty) {
+        target->dirty = true;
+        m_dirtySeries.append(target);
+    }
+}
+
+TelemetryStoreWriter::Series* TelemetryStoreWriter::series(quint32 subsystemHandle,
+                                                           const QString& subsystemId, int column)
+{
+    const quint64 key = seriesKey(subsystemHandle, column);
+    Series* result = m_series.value(key);
+    if (!result) {
+        const QString parameter = column == HealthColumn
+                                  ? QString::fromLatin1(TelemetryStoreReader::HealthCodeParameter)
+                                  : TelemetrySchema::nameOf(column);
+        result = new Series;
+        result->directory = TelemetryStoreReader::seriesPath(m_rootPath, subsystemId, parameter);
+        m_series.insert(key, result);
+        m_seriesCount.storeRelaxed(m_series.size());
+    }
+    return result;
+}
+
+qint64 TelemetryStoreWriter::windowStart(qint64 timestamp) const
+{
+    qint64 offset = timestamp % m_segmentDurationMs;
+    if (offset < 0) {
+        offset += m_segmentDurationMs;
+    }
+    return timestamp - offset;
+}
+
+bool TelemetryStoreWriter::openSegment(Series& series, qint64 timestamp)
+{
+    QDir directory(series.directory);
+    if (!directory.exists() && !directory.mkpath(".")) {
+        emit errorOccurred(QString("Cannot create telemetry store directory %1").arg(series.directory));
+        return false;
+    }
+    
+    const qint64 window = windowStart(timestamp);
+    series.windowEnd = window + m_segmentDurationMs;
+    
+    // After a restart, continue the newest segment if it is in the same
+    // window; a full one or one from an earlier window fails to resume
+    const QStringList files = directory.entryList(
+        QStringList() << QString("*") + TelemetryStoreReader::SegmentSuffix, QDir::Files);
+    qint64 newest = std::numeric_limits<qint64>::min();
+    for (const QString& file : files) {
+        bool ok = false;
+        const qint64 first = file.section('.', 0, 0).toLongLong(&ok);
+        if (ok) {
+            newest = qMax(newest, first);
+        }
+    }
+    
+    if (newest != std::numeric_limits<qint64>::min() && windowStart(newest) == window
+        && series.segment.resume(directory.filePath(QString::number(newest) + TelemetryStoreReader::SegmentSuffix))
+        && timestamp >= series.segment.lastTimestamp()) {
+        series.open = true;
+        return true;
+    }
+    
+    const QString path = directory.filePath(QString::number(timestamp) + TelemetryStoreReader::SegmentSuffix);
+    if (!series.segment.create(path)) {
+        emit errorOccurred(series.segment.errorString());
+        return false;
+    }
+    
+    series.open = true;
+    m_counters->segmentsCreated.fetchAndAddRelaxed(1);
+    return true;
+}
+
+void TelemetryStoreWriter::flushSeries(Series& series)
+{
+    const int pending = series.segment.pendingCount();
+    if (pending == 0) {
+        return;
+    }
+    
+    if (series.segment.flush()) {
+        m_counters->samplesWritten.fetchAndAddRelaxed(quint64(pending));
+    } else {
+        m_counters->writeErrors.fetchAndAddRelaxed(1);
+        emit errorOccurred(series.segment.errorString());
+    }
+    series.dirty = false;
+}
+
+TelemetryStore::TelemetryStore(QObject* parent)
+    : QObject(parent)
+    , m_segmentDurationMs(DefaultSegmentDurationMs)
+    , m_queueCapacity(DefaultQueueCapacity)
+    , m_thread(nullptr)
+    , m_writer(nullptr)
+    , m_queue(nullptr)
+    , m_drainPending(0)
+    , m_compactorThread(nullptr)
+    , m_compactor(nullptr)
+{
+}
+
+TelemetryStore::~TelemetryStore()
+{
+    close();
+}
+
+QString TelemetryStore::defaultLocation()
+{
+    return QDir(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation)).filePath("telemetry");
+}
+
+bool TelemetryStore::open(const QString& rootPath)
+{
+    QMutexLocker locker(&m_mutex);
+    
+    if (m_thread) {
+        qWarning() << "Telemetry store already open at" << m_rootPath;
+        return false;
+    }
+    
+    if (!QDir().mkpath(rootPath)) {
+        qWarning() << "Cannot create telemetry store at" << rootPath;
+        return false;
+    }
+    
+    m_rootPath = rootPath;
+    m_queue = new TelemetryStoreQueue(m_queueCapacity, TelemetryStoreQueue::OverflowPolicy::DropNewest);
+    m_writer = new TelemetryStoreWriter(rootPath, m_segmentDurationMs, m_queue,
+                                        &m_drainPending, &m_counters);
+    m_thread = new QThread(this);
+    m_thread->setObjectName("TelemetryStoreWriter");
+    m_writer->moveToThread(m_thread);
+    
+    connect(m_thread, &QThread::started,
+            m_writer, &TelemetryStoreWriter::start);
+    connect(m_writer, &TelemetryStoreWriter::errorOccurred,
+            this, &TelemetryStore::errorOccurred);
+    
+    m_thread->start();
+    
+    m_compactor = new TelemetryCompactor(rootPath, m_retention, &m_counters);
+    m_compactorThread = new QThread(this);
+    m_compactorThread->setObjectName("TelemetryCompactor");
+    m_compactor->moveToThread(m_compactorThread);
+    
+    connect(m_compactorThread, &QThread::started,
+            m_compactor, &TelemetryCompactor::start);
+    connect(m_compactor, &TelemetryCompactor::errorOccurred,
+            this, &TelemetryStore::errorOccurred);
+    
+    m_compactorThread->start();
+    locker.unlock();
+    
+    qInfo() << "Recording telemetry to" << rootPath;
+    emit storeOpened(rootPath);
+    return true;
+}
+
+void TelemetryStore::close()
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        
+        if (!m_thread) {
+            return;
+        }
+        
+        // A compaction pass stops at the next series; the rest is picked
+        // up after the next open()
+        m_compactorThread->requestInterruption();
+        m_compactorThread->quit();
+        m_compactorThread->wait();
+        delete m_compactor;
+        delete m_compactorThread;
+        m_compactor = nullptr;
+        m_compactorThread = nullptr;
+        
+        // Drain and flush on the writer's own thread, then let it finish
+        if (m_thread->isRunning()) {
+            QMetaObject::invokeMethod(m_writer, "stop", Qt::BlockingQueuedConnection);
+        }
+        m_thread->quit();
+        m_thread->wait();
+        
+        delete m_writer;
+        delete m_thread;
+        delete m_queue;
+        m_writer = nullptr;
+        m_thread = nullptr;
+        m_queue = nullptr;
+        m_drainPending.storeRelease(0);
+    }
+    
+    emit storeClosed();
+}
+
+bool TelemetryStore::isOpen() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_thread != nullptr;
+}
+
+QString TelemetryStore::rootPath() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_rootPath;
+}
+
+void TelemetryStore::setSegmentDuration(qint64 msec)
+{
+    QMutexLocker locker(&m_mutex);
+    m_segmentDurationMs = qMax(MinSegmentDurationMs, msec);
+}
+
+void TelemetryStore::setQueueCapacity(int capacity)
+{
+    QMutexLocker locker(&m_mutex);
+    m_queueCapacity = qBound(MinQueueCapacity, capacity, MaxQueueCapacity);
+}
+
+void TelemetryStore::setRetention(const TelemetryRetention& retention)
+{
+    QMutexLocker locker(&m_mutex);
+    m_retention = retention;
+    
+    if (m_compactor) {
+        TelemetryCompactor* compactor = m_compactor;
+        QMetaObject::invokeMethod(compactor, [compactor, retention]() {
+            compactor->setRetention(retention);
+        }, Qt::QueuedConnection);
+    }
+}
+
+TelemetryRetention TelemetryStore::retention() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_retention;
+}
+
+void TelemetryStore::append(const TelemetryPacket& packet)
+{
+    if (!m_queue) {
+        return;
+    }
+    
+    if (m_queue->push(packet)) {
+        m_counters.packetsQueued.fetchAndAddRelaxed(1);
+    } else {
+        m_counters.packetsDropped.fetchAndAddRelaxed(1);
+    }
+    wakeWriter();
+}
+
+void TelemetryStore::appendBatch(const QVector<TelemetryPacket>& packets)
+{
+    if (!m_queue || packets.isEmpty()) {
+        return;
+    }
+    
+    quint64 queued = 0;
+    for (const TelemetryPacket& packet : packets) {
+        if (m_queue->push(packet)) {
+            queued++;
+        }
+    }
+    m_counters.packetsQueued.fetchAndAddRelaxed(queued);
+    m_counters.packetsDropped.fetchAndAddRelaxed(quint64(packets.size()) - queued);
+    wakeWriter();
+}
+
+void TelemetryStore::wakeWriter()
+{
+    // One queued event per drain, however many batches arrive meanwhile
+    if (m_drainPending.testAndSetOrdered(0, 1)) {
+        QMetaObject::invokeMethod(m_writer, "drain", Qt::QueuedConnection);
+    }
+}
+
+TelemetryStoreStatistics TelemetryStore::statistics() const
+{
+    TelemetryStoreStatistics stats;
+    stats.packetsQueued = m_counters.packetsQueued.loadRelaxed();
+    stats.packetsDropped = m_counters.packetsDropped.loadRelaxed();
+    stats.packetsWritten = m_counters.packetsWritten.loadRelaxed();
+    stats.samplesWritten = m_counters.samplesWritten.loadRelaxed();
+    stats.samplesOutOfOrder = m_counters.samplesOutOfOrder.loadRelaxed();
+    stats.segmentsCreated = m_counters.segmentsCreated.loadRelaxed();
+    stats.rollupRowsWritten = m_counters.rollupRowsWritten.loadRelaxed();
+    stats.segmentsExpired = m_counters.segmentsExpired.loadRelaxed();
+    stats.writeErrors = m_counters.writeErrors.loadRelaxed();
+    
+    QMutexLocker locker(&m_mutex);
+    stats.seriesOpen = m_writer ? m_writer->seriesCount() : 0;
+    return stats;
+}
@@ -0,0 +1,203 @@
+/**
+ * @file TelemetryStore.h
+ * @brief Persistent columnar recording of decoded telemetry
+ */
+
+#ifndef TELEMETRYSTORE_H
+#define TELEMETRYSTORE_H
+
+#include <QObject>
+#include <QHash>
+#include <QMutex>
+#include <QThread>
+#include <QTimer>
+#include <QAtomicInteger>
+#include <QVector>
+#include "../core/TelemetryPacket.h"
+#include "../network/TelemetryRingBuffer.h"
+#include "TelemetrySegment.h"
+#include "TelemetryCompactor.h"
+
+typedef TelemetryRingBuffer<TelemetryPacket> TelemetryStoreQueue;
+
+/**
+ * @struct TelemetryStoreCounters
+ * @brief Lock-free counters shared between the store and its writer
+ */
+struct TelemetryStoreCounters {
+    QAtomicInteger<quint64> packetsQueued;
+    QAtomicInteger<quint64> packetsDropped;
+    QAtomicInteger<quint64> packetsWritten;
+    QAtomicInteger<quint64> samplesWritten;
+    QAtomicInteger<quint64> samplesOutOfOrder;
+    QAtomicInteger<quint64> segmentsCreated;
+    QAtomicInteger<quint64> rollupRowsWritten;
+    QAtomicInteger<quint64> segmentsExpired;
+    QAtomicInteger<quint64> writeErrors;
+};
+
+/**
+ * @struct TelemetryStoreStatistics
+ * @brief Point-in-time copy of the store counters
+ */
+struct TelemetryStoreStatistics {
+    quint64 packetsQueued = 0;
+    quint64 packetsDropped = 0;      ///< Hand-off queue was full
+    quint64 packetsWritten = 0;
+    quint64 samplesWritten = 0;
+    quint64 samplesOutOfOrder = 0;   ///< Older than the series' last sample; not stored
+    quint64 segmentsCreated = 0;
+    quint64 rollupRowsWritten = 0;
+    quint64 segmentsExpired = 0;     ///< Removed by retention
+    quint64 writeErrors = 0;
+    int seriesOpen = 0;
+};
+
+/**
+ * @class TelemetryStoreWriter
+ * @brief Writer thread side of TelemetryStore
+ * 
+ * Drains the hand-off queue, splits every packet into one sample per
+ * numeric schema parameter plus its health code, and appends each sample
+ * to the open segment of its series. Segments roll over when their time
+ * window ends or they are full. Pending samples are written when a series
+ * has FlushThreshold of them and otherwise every FlushIntervalMs, so at
+ * most that much is lost if the process dies.
+ */
+class TelemetryStoreWriter : public QObject
+{
+    Q_OBJECT
+    
+public:
+    static constexpr int FlushThreshold = 4096;
+    static constexpr int FlushIntervalMs = 1000;
+    
+    TelemetryStoreWriter(const QString& rootPath, qint64 segmentDurationMs,
+                         TelemetryStoreQueue* queue, QAtomicInt* drainPending,
+                         TelemetryStoreCounters* counters, QObject* parent = nullptr);
+    ~TelemetryStoreWriter();
+    
+    int seriesCount() const { return m_seriesCount.loadRelaxed(); }
+    
+public slots:
+    void start();
+    void stop();
+    void drain();
+    void flushAll();
+    
+signals:
+    void errorOccurred(const QString& error);
+    
+private:
+    struct Series {
+        QString directory;
+        TelemetrySegmentWriter segment;
+        qint64 windowEnd = 0;       ///< Segment rolls at or after this time
+        bool open = false;
+        bool dirty = false;
+    };
+    
+    void writePacket(const TelemetryPacket& packet);
+    void appendSample(quint32 subsystemHandle, const QString& subsystemId, int column,
+                      qint64 timestamp, double value);
+    Series* series(quint32 subsystemHandle, const QString& subsystemId, int column);
+    bool openSegment(Series& series, qint64 timestamp);
+    void flushSeries(Series& series);
+    qint64 windowStart(qint64 timestamp) const;
+    
+    QString m_rootPath;
+    qint64 m_segmentDurationMs;
+    TelemetryStoreQueue* m_queue;
+    QAtomicInt* m_drainPending;
+    TelemetryStoreCounters* m_counters;
+    QTimer* m_flushTimer;
+    
+    // Keyed by subsystem handle and column (schema slot, or HealthColumn)
+    QHash<quint64, Series*> m_series;
+    QVector<Series*> m_dirtySeries;
+    QAtomicInt m_seriesCount;
+};
+
+/**
+ * @class TelemetryStore
+ * @brief Append-only on-disk record of every decoded packet
+ * 
+ * Each numeric schema parameter of each subsystem becomes a series of
+ * column segment files (see TelemetrySegment) under rootPath(); the
+ * layout and read access are described with TelemetryStoreReader.
+ * 
+ * append() and appendBatch() only push the packets onto a bounded
+ * lock-free queue and post one wake-up per batch, so recording never
+ * blocks the calling thread; disk I/O happens on the store's own writer
+ * thread. When the writer falls behind far enough to fill the queue,
+ * new packets are dropped and counted. They must be called from the
+ * thread that owns the store.
+ * 
+ * While open, a TelemetryCompactor on a second thread rolls the raw
+ * samples up into 1 s and 1 min tiers and removes segments past the
+ * retention().
+ */
+class TelemetryStore : public QObject
+{
+    Q_OBJECT
+    
+public:
+    static constexpr int DefaultQueueCapacity = 1 << 16;
+    static constexpr int MinQueueCapacity = 1024;
+    static constexpr int MaxQueueCapacity = 1 << 22;
+    static constexpr qint64 DefaultSegmentDurationMs = 3600 * 1000;
+    static constexpr qint64 MinSegmentDurationMs = 1000;
+    
+    explicit TelemetryStore(QObject* parent = nullptr);
+    ~TelemetryStore();
+    
+    // Start recording under rootPath (created if needed); false on failure
+    bool open(const QString& rootPath);
+    // Write everything queued so far and stop the writer
+    void close();
+    bool isOpen() const;
+    QString rootPath() const;
+    
+    // Applied on next open()
+    void setSegmentDuration(qint64 msec);
+    qint64 segmentDuration() const { return m_segmentDurationMs; }
+    void setQueueCapacity(int capacity);
+    int queueCapacity() const { return m_queueCapacity; }
+    
+    // Takes effect immediately
+    void setRetention(const TelemetryRetention& retention);
+    TelemetryRetention retention() const;
+    
+    TelemetryStoreStatistics statistics() const;
+    
+    // <AppDataLocation>/telemetry
+    static QString defaultLocation();
+    
+public slots:
+    void append(const TelemetryPacket& packet);
+    void appendBatch(const QVector<TelemetryPacket>& packets);
+    
+signals:
+    void errorOccurred(const QString& error);
+    void storeOpened(const QString& rootPath);
+    void storeClosed();
+    
+private:
+    void wakeWriter();
+    
+    QString m_rootPath;
+    qint64 m_segmentDurationMs;
+    int m_queueCapacity;
+    TelemetryRetention m_retention;
+    
+    QThread* m_thread;
+    TelemetryStoreWriter* m_writer;
+    TelemetryStoreQueue* m_queue;
+    QAtomicInt m_drainPending;
+    TelemetryStoreCounters m_counters;
+    QThread* m_compactorThread;
+    TelemetryCompactor* m_compactor;
+    mutable QMutex m_mutex;
+};
+
+#endif // TELEMETRYSTORE_H
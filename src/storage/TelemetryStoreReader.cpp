@@ -0,0 +1,225 @@
+/**
+ * @file TelemetryStoreReader.cpp
+ * @brief Implementation of telemetry store read access
+ */
+
+#include "TelemetryStoreReader.h"
+#include "TelemetrySegment.h"
+#include <QDir>
+#include <QUrl>
+#include <algorithm>
+#include <limits>
+
+TelemetryStoreReader::TelemetryStoreReader(const QString& rootPath)
+    : m_rootPath(rootPath)
+{
+}
+
+QString TelemetryStoreReader::encodeName(const QString& name)
+{
+    // '.' is encoded too so no ID can name "." or ".."
+    return QString::fromLatin1(QUrl::toPercentEncoding(name, QByteArray(), "."));
+}
+
+QString TelemetryStoreReader::decodeName(const QString& encoded)
+{
+    return QUrl::fromPercentEncoding(encoded.toLatin1());
+}
+
+QString TelemetryStoreReader::seriesPath(const QString& rootPath, const QString& subsystemId,
+                                         const QString& parameter, StoreTier tier)
+{
+    QString path = encodeName(subsystemId) + "/" + encodeName(parameter);
+    if (tier != StoreTier::Raw) {
+        path += "/" + tierName(tier);
+    }
+    return QDir(rootPath).filePath(path);
+}
+
+qint64 TelemetryStoreReader::tierWidth(StoreTier tier)
+{
+    switch (tier) {
+        case StoreTier::Seconds: return 1000;
+        case StoreTier::Minutes: return 60 * 1000;
+        default: return 0;
+    }
+}
+
+QString TelemetryStoreReader::tierName(StoreTier tier)
+{
+    switch (tier) {
+        case StoreTier::Seconds: return "1s";
+        case StoreTier::Minutes: return "1m";
+        default: return "raw";
+    }
+}
+
+QStringList TelemetryStoreReader::subsystems() const
+{
+    QStringList result;
+    const QStringList entries = QDir(m_rootPath).entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+    for (const QString& entry : entries) {
+        result.append(decodeName(entry));
+    }
+    return result;
+}
+
+QStringList TelemetryStoreReader::parameters(const QString& subsystemId) const
+{
+    QStringList result;
+    const QDir directory(QDir(m_rootPath).filePath(encodeName(subsystemId)));
+    const QStringList entries = directory.entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+    for (const QString& entry : entries) {
+        result.append(decodeName(entry));
+    }
+    return result;
+}
+
+QVector<SegmentFileInfo> TelemetryStoreReader::segmentFiles(const QString& directory) const
+{
+    QVector<SegmentFileInfo> result;
+    const QDir dir(directory);
+    const QStringList files = dir.entryList(QStringList() << QString("*") + SegmentSuffix, QDir::Files);
+    
+    for (const QString& file : files) {
+        bool ok = false;
+        const qint64 first = file.left(file.size() - int(qstrlen(SegmentSuffix))).toLongLong(&ok);
+        if (ok) {
+            SegmentFileInfo info;
+            info.path = dir.filePath(file);
+            info.firstTimestamp = first;
+            result.append(info);
+        }
+    }
+    
+    // Numeric order; the names are not zero-padded
+    std::sort(result.begin(), result.end(), [](const SegmentFileInfo& a, const SegmentFileInfo& b) {
+        return a.firstTimestamp < b.firstTimestamp;
+    });
+    return result;
+}
+
+QVector<SegmentFileInfo> TelemetryStoreReader::allSegments(const QString& subsystemId, const QString& parameter,
+                                                           StoreTier tier) const
+{
+    return segmentFiles(seriesPath(m_rootPath, subsystemId, parameter, tier));
+}
+
+QVector<SegmentFileInfo> TelemetryStoreReader::segments(const QString& subsystemId, const QString& parameter,
+                                                        qint64 from, qint64 to, StoreTier tier) const
+{
+    const QVector<SegmentFileInfo> all = allSegments(subsystemId, parameter, tier);
+    QVector<SegmentFileInfo> result;
+    
+    for (int i = 0; i < all.size(); ++i) {
+        const bool startsInRange = all[i].firstTimestamp <= to;
+        const bool endsInRange = i + 1 == all.size() || all[i + 1].firstTimestamp > from;
+        if (startsInRange && endsInRange) {
+            result.append(all[i]);
+        }
+    }
+    return result;
+}
+
+qint64 TelemetryStoreReader::lastTimestamp(const QString& subsystemId, const QString& parameter,
+                                           StoreTier tier) const
+{
+    // The newest segment can be empty if it was created but never flushed
+    const QVector<SegmentFileInfo> all = allSegments(subsystemId, parameter, tier);
+    for (int i = all.size() - 1; i >= 0; --i) {
+        TelemetrySegment segment;
+        if (segment.open(all[i].path) && segment.count() > 0) {
+            return segment.lastTimestamp();
+        }
+    }
+    return std::numeric_limits<qint64>::min();
+}
+
+qint64 TelemetryStoreReader::scan(const QString& subsystemId, const QString& parameter,
+                                  qint64 from, qint64 to, const SampleVisitor& visitor) const
+{
+    qint64 visited = 0;
+    m_errorString.clear();
+    
+    const QVector<SegmentFileInfo> files = segments(subsystemId, parameter, from, to);
+    for (const SegmentFileInfo& info : files) {
+        const qint64 count = scanSegment(info, from, to, visitor);
+        if (count < 0) {
+            return -1;
+        }
+        visited += count;
+    }
+    return visited;
+}
+
+qint64 TelemetryStoreReader::scanSegment(const SegmentFileInfo& info, qint64 from, qint64 to,
+                                         const SampleVisitor& visitor) const
+{
+    // A segment just being created, or left behind by a crash before its
+    // first flush, holds no samples yet: skip it, keeping the reason
+    TelemetrySegment segment;
+    if (!segment.open(info.path)) {
+        m_errorString = segment.errorString();
+        return 0;
+    }
+    
+    if (segment.count() == 0) {
+        return 0;
+    }
+    
+    const int begin = segment.lowerBound(from);
+    const int end = segment.lowerBound(to == std::numeric_limits<qint64>::max() ? to : to + 1);
+    if (end <= begin) {
+        return 0;
+    }
+    
+    visitor(segment.timestamps() + begin, segment.values() + begin, end - begin);
+    return end - begin;
+}
+
+qint64 TelemetryStoreReader::scanRollups(const QString& subsystemId, const QString& parameter, StoreTier tier,
+                                         qint64 from, qint64 to, const RollupVisitor& visitor) const
+{
+    qint64 visited = 0;
+    m_errorString.clear();
+    
+    const QVector<SegmentFileInfo> files = segments(subsystemId, parameter, from, to, tier);
+    for (const SegmentFileInfo& info : files) {
+        const qint64 count = scanRollupSegment(info, from, to, visitor);
+        if (count < 0) {
+            return -1;
+        }
+        visited += count;
+    }
+    return visited;
+}
+
+qint64 TelemetryStoreReader::scanRollupSegment(const SegmentFileInfo& info, qint64 from, qint64 to,
+                                               const RollupVisitor& visitor) const
+{
+    TelemetrySegment segment;
+    if (!segment.open(info.path)) {
+        m_errorString = segment.errorString();
+        return 0;
+    }
+    if (segment.count() == 0) {
+        return 0;
+    }
+    if (segment.columnCount() != RollupColumnCount) {
+        m_errorString = QString("Segment %1 is not a rollup segment").arg(info.path);
+        return -1;
+    }
+    
+    const int begin = segment.lowerBound(from);
+    const int end = segment.lowerBound(to == std::numeric_limits<qint64>::max() ? to : to + 1);
+    if (end <= begin) {
+        return 0;
+    }
+    
+    const double* columns[RollupColumnCount];
+    for (int column = 0; column < RollupColumnCount; ++column) {
+        columns[column] = segment.values(column) + begin;
+    }
+    visitor(segment.timestamps() + begin, columns, end - begin);
+    return end - begin;
+}
@@ -0,0 +1,128 @@
+/**
+ * @file TelemetryStoreReader.h
+ * @brief Read access to a telemetry store directory
+ */
+
+#ifndef TELEMETRYSTOREREADER_H
+#define TELEMETRYSTOREREADER_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <functional>
+
+/**
+ * @struct SegmentFileInfo
+ * @brief One segment file of a series, as listed on disk
+ */
+struct SegmentFileInfo {
+    QString path;
+    qint64 firstTimestamp = 0;  ///< From the file name
+};
+
+/**
+ * @brief Resolution tiers of a series, finest first
+ */
+enum class StoreTier {
+    Raw,        ///< Every sample as recorded
+    Seconds,    ///< 1 s rollups
+    Minutes     ///< 1 min rollups
+};
+
+/**
+ * @brief Value columns of a rollup segment
+ * 
+ * Each rollup row is stamped with the start of its bucket. The sum is
+ * kept rather than the mean so rows merge exactly.
+ */
+enum RollupColumn {
+    RollupMinimum = 0,
+    RollupMaximum,
+    RollupSum,
+    RollupCount,
+    RollupColumnCount
+};
+
+/**
+ * @class TelemetryStoreReader
+ * @brief Lists and scans the series written by TelemetryStore
+ * 
+ * The store is laid out as <root>/<subsystem>/<parameter>/<first>.seg,
+ * with directory names percent-encoded and <first> the timestamp of the
+ * segment's first sample. Sorted by that timestamp the file names form
+ * the top level of the time index: segment i covers samples from its own
+ * first timestamp up to the next segment's, so a range scan only opens
+ * the segments that overlap it and the per-segment sparse index does the
+ * rest.
+ * 
+ * Rollup tiers live next to the raw segments, in a subdirectory named
+ * after the tier (<parameter>/1s, <parameter>/1m), with the same file
+ * naming; their segments have one value column per RollupColumn.
+ * TelemetryCompactor writes them and expires data past its retention.
+ * 
+ * Readers are cheap and independent of the writer: use one per thread,
+ * as many as needed, also while the store is being written.
+ */
+class TelemetryStoreReader
+{
+public:
+    // Called with consecutive runs of samples in time order
+    using SampleVisitor = std::function<void(const qint64* timestamps, const double* values, int count)>;
+    // Called with consecutive runs of rollup rows; columns are indexed by RollupColumn
+    using RollupVisitor = std::function<void(const qint64* timestamps, const double* const* columns, int count)>;
+    
+    static constexpr int TierCount = 3;
+    
+    explicit TelemetryStoreReader(const QString& rootPath);
+    
+    QString rootPath() const { return m_rootPath; }
+    
+    QStringList subsystems() const;
+    QStringList parameters(const QString& subsystemId) const;
+    
+    // Segments that may hold samples in [from, to], oldest first
+    QVector<SegmentFileInfo> segments(const QString& subsystemId, const QString& parameter,
+                                      qint64 from, qint64 to, StoreTier tier = StoreTier::Raw) const;
+    QVector<SegmentFileInfo> allSegments(const QString& subsystemId, const QString& parameter,
+                                         StoreTier tier = StoreTier::Raw) const;
+    
+    // Timestamp of the last sample (raw) or bucket start (rollup) in a tier;
+    // min() if the tier is empty
+    qint64 lastTimestamp(const QString& subsystemId, const QString& parameter, StoreTier tier) const;
+    
+    // Visit every sample in [from, to]; returns the number visited, -1 on error.
+    // Segments that cannot be opened (not yet flushed, or torn by a crash)
+    // or hold no samples are skipped; errorString() names the last of them.
+    qint64 scan(const QString& subsystemId, const QString& parameter,
+                qint64 from, qint64 to, const SampleVisitor& visitor) const;
+    qint64 scanSegment(const SegmentFileInfo& segment, qint64 from, qint64 to,
+                       const SampleVisitor& visitor) const;
+    
+    // Visit every rollup row whose bucket starts in [from, to]; same returns as scan()
+    qint64 scanRollups(const QString& subsystemId, const QString& parameter, StoreTier tier,
+                       qint64 from, qint64 to, const RollupVisitor& visitor) const;
+    qint64 scanRollupSegment(const SegmentFileInfo& segment, qint64 from, qint64 to,
+                             const RollupVisitor& visitor) const;
+    
+    QString errorString() const { return m_errorString; }
+    
+    // Directory names for subsystem IDs and parameter names
+    static QString encodeName(const QString& name);
+    static QString decodeName(const QString& encoded);
+    static QString seriesPath(const QString& rootPath, const QString& subsystemId,
+                              const QString& parameter, StoreTier tier = StoreTier::Raw);
+    
+    static qint64 tierWidth(StoreTier tier);        ///< Bucket width in ms; 0 for Raw
+    static QString tierName(StoreTier tier);
+    
+    static constexpr const char* SegmentSuffix = ".seg";
+    static constexpr const char* HealthCodeParameter = "health_code";  ///< Series of HealthCode values
+    
+private:
+    QVector<SegmentFileInfo> segmentFiles(const QString& directory) const;
+    
+    QString m_rootPath;
+    mutable QString m_errorString;
+};
+
+#endif // TELEMETRYSTOREREADER_H
@@ -100,8 +100,14 @@ void HealthDashboard::populateHealthTable()
     
     QList<SubsystemNode*> nodes = m_scene->allNodes();
     
-    // Sort by health status (errors first, then warnings, then OK)
+    // Sort by health status (errors first, then warnings, then OK), with
+    // alarms that are symptoms of an upstream failure after all the others
     std::sort(nodes.begin(), nodes.end(), [](SubsystemNode* a, SubsystemNode* b) {
+        const bool suppressedA = a->impactState() == ImpactState::Suppressed;
+        const bool suppressedB = b->impactState() == ImpactState::Suppressed;
+        if (suppressedA != suppressedB) {
+            return suppressedB;
+        }
         int priorityA = static_cast<int>(a->healthStatus().code());
         int priorityB = static_cast<int>(b->healthStatus().code());
         return priorityA > priorityB;  // Higher priority (ERROR=2) comes first
@@ -135,8 +141,14 @@ void HealthDashboard::addHealthRow(SubsystemNode* node)
     QTableWidgetItem* typeItem = new QTableWidgetItem(node->subsystemType());
     m_tableWidget->setItem(row, 2, typeItem);
     
-    // Health message
-    QTableWidgetItem* msgItem = new QTableWidgetItem(status.message());
+    // Health message, prefixed with the upstream failure behind it
+    QString message = status.message();
+    if (node->impactState() == ImpactState::Suppressed) {
+        message = QString("Symptom of %1: %2").arg(node->impactRootCause(), message);
+    } else if (node->impactState() == ImpactState::Impacted) {
+        message = QString("Impacted by %1").arg(node->impactRootCause());
+    }
+    QTableWidgetItem* msgItem = new QTableWidgetItem(message);
     m_tableWidget->setItem(row, 3, msgItem);
     
     // Last update time
@@ -150,6 +162,14 @@ void HealthDashboard::addHealthRow(SubsystemNode* node)
     }
     QTableWidgetItem* timeItem = new QTableWidgetItem(timeStr);
     m_tableWidget->setItem(row, 4, timeItem);
+    
+    // Symptoms stay listed but muted
+    if (node->impactState() == ImpactState::Suppressed) {
+        statusItem->setBackground(getStatusColor(status.code()).darker(200));
+        for (int column = 1; column <= 4; ++column) {
+            m_tableWidget->item(row, column)->setForeground(QColor(140, 140, 140));
+        }
+    }
 }
 
 QColor HealthDashboard::getStatusColor(HealthCode code) const
@@ -9,12 +9,18 @@
 #include "PropertiesPanel.h"
 #include "HealthDashboard.h"
 #include "TelemetryLogWindow.h"
+#include "TelemetryQueryPanel.h"
 #include "../graph/NodeGraphScene.h"
 #include "../graph/NodeGraphView.h"
 #include "../graph/HierarchicalGraphEngine.h"
+#include "../graph/ImpactEngine.h"
 #include "../network/UdpTelemetryReceiver.h"
 #include "../network/HealthStatusDispatcher.h"
+#include "../network/StalenessMonitor.h"
+#include "../storage/TelemetryStore.h"
+#include "../storage/TelemetryQueryEngine.h"
 #include "../core/RadarSubsystem.h"
+#include "../core/HealthRuleEngine.h"
 #include "../core/SubsystemNode.h"
 #include "../nodes/RFFrontendNode.h"
 #include "../nodes/SignalProcessorNode.h"
@@ -27,6 +33,7 @@
 #include "../nodes/EmbeddedControllerNode.h"
 
 #include <QMenuBar>
+#include <QAction>
 #include <QToolBar>
 #include <QStatusBar>
 #include <QDockWidget>
@@ -44,9 +51,15 @@ MainWindow::MainWindow(QWidget* parent)
     , m_propertiesPanel(nullptr)
     , m_healthDashboard(nullptr)
     , m_telemetryLog(nullptr)
+    , m_queryPanel(nullptr)
     , m_telemetryReceiver(nullptr)
     , m_healthDispatcher(nullptr)
+    , m_stalenessMonitor(nullptr)
+    , m_ruleEngine(nullptr)
+    , m_telemetryStore(nullptr)
+    , m_queryEngine(nullptr)
     , m_hierarchyEngine(nullptr)
+    , m_impactEngine(nullptr)
     , m_statusLabel(nullptr)
     , m_telemetryStatusLabel(nullptr)
     , m_zoomLabel(nullptr)
@@ -88,6 +101,10 @@ void MainWindow::setupUI()
     m_hierarchyEngine = new HierarchicalGraphEngine(this);
     m_hierarchyEngine->setRootScene(m_graphScene);
     
+    // Mark nodes fed by failed nodes of the top-level graph
+    m_impactEngine = new ImpactEngine(this);
+    m_impactEngine->setModel(m_graphScene->dataModel());
+    
     // Apply dark theme
     setStyleSheet(R"(
         QMainWindow {
@@ -148,6 +165,20 @@ void MainWindow::createMenus()
     telemetryMenu->addAction("&Start Receiver", this, &MainWindow::startTelemetry);
     telemetryMenu->addAction("S&top Receiver", this, &MainWindow::stopTelemetry);
     telemetryMenu->addSeparator();
+    QAction* conflateAction = telemetryMenu->addAction("C&onflate Updates");
+    conflateAction->setCheckable(true);
+    connect(conflateAction, &QAction::toggled, this, [this](bool enabled) {
+        if (m_healthDispatcher) {
+            m_healthDispatcher->setConflationEnabled(enabled);
+        }
+    });
+    QAction* recordAction = telemetryMenu->addAction("&Record to Disk");
+    recordAction->setCheckable(true);
+    recordAction->setChecked(true);
+    connect(recordAction, &QAction::toggled, this, &MainWindow::setRecordingEnabled);
+    telemetryMenu->addAction("Re&tention...", this, &MainWindow::configureRetention);
+    telemetryMenu->addAction("Offline &Timeouts...", this, &MainWindow::configureStaleness);
+    telemetryMenu->addAction("Reload Health &Rules", this, &MainWindow::reloadHealthRules);
     telemetryMenu->addAction("&Configure...", this, &MainWindow::configureTelemetry);
     
     // Help menu
@@ -193,6 +224,12 @@ void MainWindow::createDockPanels()
     m_telemetryLog = new TelemetryLogWindow(this);
     addDockWidget(Qt::BottomDockWidgetArea, m_telemetryLog);
     tabifyDockWidget(m_healthDashboard, m_telemetryLog);
+    
+    // Telemetry query (bottom, tabified with telemetry log)
+    m_queryPanel = new TelemetryQueryPanel(this);
+    m_queryPanel->setNodeScene(m_graphScene);
+    addDockWidget(Qt::BottomDockWidgetArea, m_queryPanel);
+    tabifyDockWidget(m_telemetryLog, m_queryPanel);
 }
 
 void MainWindow::createStatusBar()
@@ -232,6 +269,36 @@ void MainWindow::initializeTelemetrySystem()
     m_healthDispatcher = new HealthStatusDispatcher(this);
     m_healthDispatcher->setTelemetryReceiver(m_telemetryReceiver);
     
+    // Nodes that stop reporting go OFFLINE after their type's timeout
+    m_stalenessMonitor = new StalenessMonitor(this);
+    m_healthDispatcher->setStalenessMonitor(m_stalenessMonitor);
+    for (SubsystemNode* node : m_graphScene->allNodes()) {
+        m_stalenessMonitor->watch(node);
+    }
+    connect(m_graphScene, &NodeGraphScene::nodeAdded,
+            m_stalenessMonitor, &StalenessMonitor::watch);
+    connect(m_graphScene, &NodeGraphScene::nodeRemoved,
+            m_stalenessMonitor, &StalenessMonitor::unwatch);
+    connect(m_stalenessMonitor, &StalenessMonitor::nodeStale,
+            this, [this](SubsystemNode* node, qint64 silentMs) {
+                if (m_telemetryLog) {
+                    m_telemetryLog->logMessage(QString("%1 OFFLINE: no telemetry for %2 s")
+                                               .arg(node->nodeName()).arg(silentMs / 1000));
+                }
+            });
+    
+    // Threshold rules raise node health from each node's latest telemetry
+    m_ruleEngine = new HealthRuleEngine(this);
+    m_ruleEngine->loadRules(HealthRuleEngine::defaultRulesPath());
+    m_healthDispatcher->setHealthRuleEngine(m_ruleEngine);
+    for (SubsystemNode* node : m_graphScene->allNodes()) {
+        m_ruleEngine->watch(node);
+    }
+    connect(m_graphScene, &NodeGraphScene::nodeAdded,
+            m_ruleEngine, &HealthRuleEngine::watch);
+    connect(m_graphScene, &NodeGraphScene::nodeRemoved,
+            m_ruleEngine, &HealthRuleEngine::unwatch);
+    
     // Connect telemetry signals
     connect(m_telemetryReceiver, &UdpTelemetryReceiver::telemetryReceived,
             this, &MainWindow::onTelemetryReceived);
@@ -240,6 +307,18 @@ void MainWindow::initializeTelemetrySystem()
     connect(m_telemetryReceiver, &UdpTelemetryReceiver::statusChanged,
             this, &MainWindow::onTelemetryStatusChanged);
     
+    // Record every decoded packet; the store writes on its own thread
+    m_telemetryStore = new TelemetryStore(this);
+    connect(m_telemetryReceiver, &UdpTelemetryReceiver::telemetryBatchReceived,
+            m_telemetryStore, &TelemetryStore::appendBatch);
+    connect(m_telemetryStore, &TelemetryStore::errorOccurred,
+            this, &MainWindow::onTelemetryError);
+    setRecordingEnabled(true);
+    
+    // Queries read the same directory the store records to
+    m_queryEngine = new TelemetryQueryEngine(TelemetryStore::defaultLocation(), this);
+    m_queryPanel->setQueryEngine(m_queryEngine);
+    
     qInfo() << "Telemetry system initialized on port" << m_telemetryPort;
 }
 
@@ -374,6 +453,12 @@ void MainWindow::clearCanvas()
 {
     if (m_graphScene) {
         m_graphScene->clearScene();
+        if (m_stalenessMonitor) {
+            m_stalenessMonitor->clear();
+        }
+        if (m_ruleEngine) {
+            m_ruleEngine->clear();
+        }
         m_statusLabel->setText("Canvas cleared");
     }
 }
@@ -430,7 +515,21 @@ void MainWindow::configureTelemetry()
         m_telemetryPort, 1024, 65535, 1, &ok
     );
     
-    if (ok && port != m_telemetryPort) {
+    if (!ok) {
+        return;
+    }
+    
+    int shards = QInputDialog::getInt(
+        this, "Configure Telemetry", "Receiver shards (SO_REUSEPORT):",
+        m_telemetryReceiver->shardCount(), 1,
+        UdpTelemetryReceiver::maxShardCount(), 1, &ok
+    );
+    
+    if (!ok) {
+        return;
+    }
+    
+    if (port != m_telemetryPort || shards != m_telemetryReceiver->shardCount()) {
         bool wasRunning = m_telemetryReceiver->isRunning();
         if (wasRunning) {
             stopTelemetry();
@@ -438,15 +537,124 @@ void MainWindow::configureTelemetry()
         
         m_telemetryPort = port;
         m_telemetryReceiver->setPort(port);
+        m_telemetryReceiver->setShardCount(shards);
         
         if (wasRunning) {
             startTelemetry();
         }
         
-        m_statusLabel->setText(QString("Telemetry port changed to %1").arg(port));
+        m_statusLabel->setText(QString("Telemetry port %1, %2 receiver shard(s)")
+                              .arg(port).arg(m_telemetryReceiver->shardCount()));
+    }
+}
+
+void MainWindow::setRecordingEnabled(bool enabled)
+{
+    if (!m_telemetryStore || enabled == m_telemetryStore->isOpen()) {
+        return;
+    }
+    
+    if (!enabled) {
+        m_telemetryStore->close();
+        m_statusLabel->setText("Telemetry recording stopped");
+    } else if (m_telemetryStore->open(TelemetryStore::defaultLocation())) {
+        m_statusLabel->setText("Recording telemetry to " + m_telemetryStore->rootPath());
+    } else {
+        m_statusLabel->setText("Telemetry recording unavailable");
     }
 }
 
+void MainWindow::configureRetention()
+{
+    if (!m_telemetryStore) {
+        return;
+    }
+    
+    const qint64 hour = qint64(3600) * 1000;
+    const qint64 day = 24 * hour;
+    TelemetryRetention retention = m_telemetryStore->retention();
+    
+    bool ok;
+    const int rawHours = QInputDialog::getInt(
+        this, "Telemetry Retention", "Keep raw samples for (hours, 0 = forever):",
+        int(retention.rawMs / hour), 0, 24 * 365, 1, &ok
+    );
+    if (!ok) {
+        return;
+    }
+    
+    const int secondDays = QInputDialog::getInt(
+        this, "Telemetry Retention", "Keep 1-second rollups for (days, 0 = forever):",
+        int(retention.secondsMs / day), 0, 3650, 1, &ok
+    );
+    if (!ok) {
+        return;
+    }
+    
+    const int minuteDays = QInputDialog::getInt(
+        this, "Telemetry Retention", "Keep 1-minute rollups for (days, 0 = forever):",
+        int(retention.minutesMs / day), 0, 36500, 1, &ok
+    );
+    if (!ok) {
+        return;
+    }
+    
+    retention.rawMs = rawHours * hour;
+    retention.secondsMs = secondDays * day;
+    retention.minutesMs = minuteDays * day;
+    m_telemetryStore->setRetention(retention);
+    
+    m_statusLabel->setText(QString("Retention: raw %1 h, 1 s rollups %2 d, 1 min rollups %3 d")
+                           .arg(rawHours).arg(secondDays).arg(minuteDays));
+}
+
+void MainWindow::configureStaleness()
+{
+    if (!m_stalenessMonitor) {
+        return;
+    }
+    
+    bool ok;
+    const QStringList types = RadarSubsystem::instance().availableTypes();
+    const QString type = QInputDialog::getItem(
+        this, "Offline Timeouts", "Subsystem type:", types, 0, false, &ok
+    );
+    if (!ok || type.isEmpty()) {
+        return;
+    }
+    
+    const double seconds = QInputDialog::getDouble(
+        this, "Offline Timeouts", QString("Mark %1 OFFLINE after (seconds without telemetry):").arg(type),
+        m_stalenessMonitor->timeout(type) / 1000.0,
+        StalenessMonitor::MinTimeoutMs / 1000.0, StalenessMonitor::MaxTimeoutMs / 1000.0, 1, &ok
+    );
+    if (!ok) {
+        return;
+    }
+    
+    m_stalenessMonitor->setTimeout(type, qRound64(seconds * 1000.0));
+    m_statusLabel->setText(QString("%1 offline timeout: %2 s").arg(type).arg(seconds));
+}
+
+void MainWindow::reloadHealthRules()
+{
+    if (!m_ruleEngine) {
+        return;
+    }
+    
+    // Picks up a user rules file created since startup
+    const QString path = HealthRuleEngine::defaultRulesPath();
+    if (!m_ruleEngine->loadRules(path)) {
+        QMessageBox::warning(this, "Health Rules",
+                             QString("Rules not reloaded; the previous rules stay in force.\n\n%1")
+                             .arg(m_ruleEngine->errorString()));
+        return;
+    }
+    
+    m_statusLabel->setText(QString("Loaded %1 health rules from %2")
+                           .arg(m_ruleEngine->ruleCount()).arg(path));
+}
+
 void MainWindow::showAbout()
 {
     QMessageBox::about(this, "About Radar Health Monitoring System",
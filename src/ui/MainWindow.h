@@ -16,9 +16,15 @@ class ToolboxPanel;
 class PropertiesPanel;
 class HealthDashboard;
 class TelemetryLogWindow;
+class TelemetryQueryPanel;
 class UdpTelemetryReceiver;
 class HealthStatusDispatcher;
+class StalenessMonitor;
+class HealthRuleEngine;
+class TelemetryStore;
+class TelemetryQueryEngine;
 class HierarchicalGraphEngine;
+class ImpactEngine;
 class SubsystemNode;
 
 /**
@@ -32,6 +38,7 @@ class SubsystemNode;
  * - Health dashboard
  * - Telemetry log
  * - UDP telemetry receiver
+ * - Telemetry recording to disk
  * - Menu bar and toolbar
  */
 class MainWindow : public QMainWindow
@@ -67,6 +74,10 @@ private slots:
     void startTelemetry();
     void stopTelemetry();
     void configureTelemetry();
+    void setRecordingEnabled(bool enabled);
+    void configureRetention();
+    void configureStaleness();
+    void reloadHealthRules();
     
     // Help menu actions
     void showAbout();
@@ -99,14 +110,22 @@ private:
     PropertiesPanel* m_propertiesPanel;
     HealthDashboard* m_healthDashboard;
     TelemetryLogWindow* m_telemetryLog;
+    TelemetryQueryPanel* m_queryPanel;
     
     // Telemetry system
     UdpTelemetryReceiver* m_telemetryReceiver;
     HealthStatusDispatcher* m_healthDispatcher;
+    StalenessMonitor* m_stalenessMonitor;
+    HealthRuleEngine* m_ruleEngine;
+    TelemetryStore* m_telemetryStore;
+    TelemetryQueryEngine* m_queryEngine;
     
     // Hierarchical navigation
     HierarchicalGraphEngine* m_hierarchyEngine;
     
+    // Failure impact along connections
+    ImpactEngine* m_impactEngine;
+    
     // Status bar widgets
     QLabel* m_statusLabel;
     QLabel* m_telemetryStatusLabel;
@@ -32,8 +32,16 @@ NodeWidget::NodeWidget(SubsystemNode* node, QGraphicsItem* parent)
     if (m_node) {
         QObject::connect(m_node, &SubsystemNode::healthStatusChanged,
                          m_node, [this]() { update(); });
+        QObject::connect(m_node, &SubsystemNode::healthSummaryChanged,
+                         m_node, [this]() {
+                             if (m_node->hasChildGraph()) {
+                                 update();
+                             }
+                         });
         QObject::connect(m_node, &SubsystemNode::nodeNameChanged,
                          m_node, [this]() { update(); });
+        QObject::connect(m_node, &SubsystemNode::impactChanged,
+                         m_node, [this]() { update(); });
     }
 }
 
@@ -249,6 +257,42 @@ void NodeWidget::drawBody(QPainter* painter, const QRectF& rect)
         painter->setFont(m_textFont);
         QRectF typeRect(5, HEADER_HEIGHT + 5, m_size.width() - 10, 15);
         painter->drawText(typeRect, Qt::AlignCenter, m_node->subsystemType());
+        
+        // Rolled-up health of the child graph, problems only
+        if (m_node->hasChildGraph()) {
+            const HealthSummary& summary = m_node->healthSummary();
+            QStringList parts;
+            if (summary.count(HealthCode::ERROR)) {
+                parts << QString("%1 ERR").arg(summary.count(HealthCode::ERROR));
+            }
+            if (summary.count(HealthCode::OFFLINE)) {
+                parts << QString("%1 OFF").arg(summary.count(HealthCode::OFFLINE));
+            }
+            if (summary.count(HealthCode::WARNING)) {
+                parts << QString("%1 WARN").arg(summary.count(HealthCode::WARNING));
+            }
+            if (parts.isEmpty()) {
+                parts << QString("%1 nodes").arg(summary.total());
+            }
+            
+            painter->setPen(HealthStatus(summary.worst()).statusColor());
+            QRectF summaryRect(5, HEADER_HEIGHT + 20, m_size.width() - 10, 15);
+            painter->drawText(summaryRect, Qt::AlignCenter, parts.join("  "));
+        }
+        
+        // Failure upstream; the root cause itself shows nothing extra
+        if (m_node->impactState() != ImpactState::None) {
+            const bool suppressed = m_node->impactState() == ImpactState::Suppressed;
+            painter->setPen(suppressed ? QColor(150, 150, 150)
+                                       : HealthStatus(HealthCode::ERROR).statusColor());
+            QRectF impactRect(5, HEADER_HEIGHT + (m_node->hasChildGraph() ? 35 : 20),
+                              m_size.width() - 10, 15);
+            const QString text = suppressed ? QString("Symptom of %1") : QString("Impacted by %1");
+            painter->drawText(impactRect, Qt::AlignCenter,
+                              painter->fontMetrics().elidedText(text.arg(m_node->impactRootCause()),
+                                                                Qt::ElideRight,
+                                                                int(impactRect.width())));
+        }
     }
 }
 
@@ -299,7 +343,16 @@ void NodeWidget::drawHealthIndicator(QPainter* painter, const QRectF& rect)
         return;
     }
     
-    QColor ledColor = m_node->healthStatus().statusColor();
+    // A parent shows the worst health anywhere below it
+    QColor ledColor = m_node->hasChildGraph()
+                      ? HealthStatus(m_node->healthSummary().worst()).statusColor()
+                      : m_node->healthStatus().statusColor();
+    
+    // A suppressed alarm is a symptom, so it should not draw the eye
+    if (m_node->impactState() == ImpactState::Suppressed) {
+        const int gray = qGray(ledColor.rgb());
+        ledColor = QColor(gray, gray, gray);
+    }
     
     // Draw LED with glow effect
     painter->setPen(Qt::NoPen);
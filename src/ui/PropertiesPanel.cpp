@@ -13,6 +13,7 @@ PropertiesPanel::PropertiesPanel(QWidget* parent)
     : QDockWidget("Properties", parent)
     , m_tableWidget(nullptr)
     , m_currentNode(nullptr)
+    , m_healthRow(-1)
 {
     setupUI();
 }
@@ -58,23 +59,40 @@ void PropertiesPanel::setupUI()
 
 void PropertiesPanel::displayNodeProperties(SubsystemNode* node)
 {
+    // Stop following the previous node
+    if (m_currentNode && m_currentNode != node) {
+        disconnect(m_currentNode, nullptr, this, nullptr);
+    }
+    
     m_currentNode = node;
     populateProperties(node);
     
     // Connect to property changes for live updates
     if (node) {
-        connect(node, &SubsystemNode::propertyChanged,
-                this, &PropertiesPanel::updateProperties,
+        connect(node, &SubsystemNode::propertiesChanged,
+                this, &PropertiesPanel::updateChangedProperties,
                 Qt::UniqueConnection);
         connect(node, &SubsystemNode::healthStatusChanged,
-                this, &PropertiesPanel::updateProperties,
+                this, &PropertiesPanel::updateHealthRows,
+                Qt::UniqueConnection);
+        
+        // Health only notifies on a transition; the update time and the
+        // suppressed flaps move with every packet
+        connect(node, &SubsystemNode::telemetryUpdated,
+                this, &PropertiesPanel::updateActivityRows,
                 Qt::UniqueConnection);
     }
 }
 
 void PropertiesPanel::clearProperties()
 {
+    if (m_currentNode) {
+        disconnect(m_currentNode, nullptr, this, nullptr);
+    }
+    
     m_tableWidget->setRowCount(0);
+    m_propertyRows.clear();
+    m_healthRow = -1;
     m_currentNode = nullptr;
 }
 
@@ -85,6 +103,45 @@ void PropertiesPanel::updateProperties()
     }
 }
 
+void PropertiesPanel::updateChangedProperties(const QStringList& keys)
+{
+    if (!m_currentNode) {
+        return;
+    }
+    
+    for (const QString& key : keys) {
+        auto it = m_propertyRows.constFind(key);
+        if (it == m_propertyRows.constEnd()) {
+            // New property: rows below it move, so lay the table out again
+            populateProperties(m_currentNode);
+            return;
+        }
+        setRowValue(it.value(), m_currentNode->property(key));
+    }
+}
+
+void PropertiesPanel::updateHealthRows()
+{
+    if (!m_currentNode || m_healthRow < 0) {
+        return;
+    }
+    
+    const HealthStatus status = m_currentNode->healthStatus();
+    setRowValue(m_healthRow, status.statusText());
+    setRowValue(m_healthRow + 1, status.message());
+    updateActivityRows();
+}
+
+void PropertiesPanel::updateActivityRows()
+{
+    if (!m_currentNode || m_healthRow < 0) {
+        return;
+    }
+    
+    setRowValue(m_healthRow + 2, QString::number(m_currentNode->healthStatus().lastUpdateTime()));
+    setRowValue(m_healthRow + 3, QString::number(m_currentNode->suppressedFlaps()));
+}
+
 void PropertiesPanel::populateProperties(SubsystemNode* node)
 {
     if (!node) {
@@ -93,6 +150,7 @@ void PropertiesPanel::populateProperties(SubsystemNode* node)
     }
     
     m_tableWidget->setRowCount(0);
+    m_propertyRows.clear();
     
     // Basic information
     addPropertyRow("Node ID", node->nodeId());
@@ -101,14 +159,15 @@ void PropertiesPanel::populateProperties(SubsystemNode* node)
     addPropertyRow("Category", node->subsystemCategory());
     
     // Health status
-    addPropertyRow("Health Status", node->healthStatus().statusText());
+    m_healthRow = addPropertyRow("Health Status", node->healthStatus().statusText());
     addPropertyRow("Health Message", node->healthStatus().message());
     addPropertyRow("Last Update", QString::number(node->healthStatus().lastUpdateTime()));
+    addPropertyRow("Suppressed Flaps", QString::number(node->suppressedFlaps()));
     
     // Custom properties
     QMap<QString, QVariant> properties = node->allProperties();
     for (auto it = properties.begin(); it != properties.end(); ++it) {
-        addPropertyRow(it.key(), it.value());
+        m_propertyRows.insert(it.key(), addPropertyRow(it.key(), it.value()));
     }
     
     // Port information
@@ -118,9 +177,16 @@ void PropertiesPanel::populateProperties(SubsystemNode* node)
     // Hierarchical info
     addPropertyRow("Has Child Graph", node->hasChildGraph() ? "Yes" : "No");
     addPropertyRow("Is Expanded", node->isExpanded() ? "Yes" : "No");
+    
+    // Telemetry history
+    const TelemetryHistory& history = node->telemetryHistory();
+    addPropertyRow("History Parameters", QString::number(qPopulationCount(history.recordedSlots())));
+    addPropertyRow("History Memory", QString("%1 / %2 KiB")
+                   .arg(history.memoryUsage() / 1024)
+                   .arg(history.memoryLimit() / 1024));
 }
 
-void PropertiesPanel::addPropertyRow(const QString& name, const QVariant& value)
+int PropertiesPanel::addPropertyRow(const QString& name, const QVariant& value)
 {
     int row = m_tableWidget->rowCount();
     m_tableWidget->insertRow(row);
@@ -133,4 +199,13 @@ void PropertiesPanel::addPropertyRow(const QString& name, const QVariant& value)
     
     m_tableWidget->setItem(row, 0, nameItem);
     m_tableWidget->setItem(row, 1, valueItem);
+    return row;
+}
+
+void PropertiesPanel::setRowValue(int row, const QVariant& value)
+{
+    QTableWidgetItem* valueItem = m_tableWidget->item(row, 1);
+    if (valueItem) {
+        valueItem->setText(value.toString());
+    }
 }
@@ -8,6 +8,8 @@
 
 #include <QDockWidget>
 #include <QTableWidget>
+#include <QHash>
+#include <QStringList>
 
 class SubsystemNode;
 
@@ -16,7 +18,8 @@ class SubsystemNode;
  * @brief Displays and edits properties of selected nodes
  * 
  * Shows node properties, telemetry data, and configuration
- * in a table format with live updates.
+ * in a table format with live updates. Live updates rewrite only the
+ * rows that changed; the table is rebuilt only when a property appears.
  */
 class PropertiesPanel : public QDockWidget
 {
@@ -30,14 +33,22 @@ public slots:
     void displayNodeProperties(SubsystemNode* node);
     void clearProperties();
     void updateProperties();
+    void updateChangedProperties(const QStringList& keys);
+    void updateHealthRows();
+    void updateActivityRows();
     
 private:
     void setupUI();
     void populateProperties(SubsystemNode* node);
-    void addPropertyRow(const QString& name, const QVariant& value);
+    int addPropertyRow(const QString& name, const QVariant& value);
+    void setRowValue(int row, const QVariant& value);
     
     QTableWidget* m_tableWidget;
     SubsystemNode* m_currentNode;
+    
+    // Row of each custom property and of the first health row
+    QHash<QString, int> m_propertyRows;
+    int m_healthRow;
 };
 
 #endif // PROPERTIESPANEL_H
@@ -0,0 +1,294 @@
+/**
+ * @file TelemetryQueryPanel.cpp
+ * @brief Implementation of TelemetryQueryPanel
+ */
+
+#include "TelemetryQueryPanel.h"
+#include "../core/RadarSubsystem.h"
+#include "../core/SubsystemNode.h"
+#include "../core/TelemetrySchema.h"
+#include "../graph/NodeGraphScene.h"
+#include "../storage/TelemetryStoreReader.h"
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QDateTime>
+#include <cmath>
+
+namespace {
+
+// Enough for a day of per-minute rollups; the table is rebuilt on every update
+constexpr int MaxTableRows = 1440;
+
+} // namespace
+
+TelemetryQueryPanel::TelemetryQueryPanel(QWidget* parent)
+    : QDockWidget("Telemetry Query", parent)
+    , m_typeCombo(nullptr)
+    , m_parameterCombo(nullptr)
+    , m_rangeCombo(nullptr)
+    , m_rollupCombo(nullptr)
+    , m_runButton(nullptr)
+    , m_cancelButton(nullptr)
+    , m_progressBar(nullptr)
+    , m_summaryLabel(nullptr)
+    , m_tableWidget(nullptr)
+    , m_scene(nullptr)
+    , m_engine(nullptr)
+    , m_queryId(0)
+{
+    setupUI();
+}
+
+TelemetryQueryPanel::~TelemetryQueryPanel()
+{
+}
+
+void TelemetryQueryPanel::setupUI()
+{
+    QWidget* mainWidget = new QWidget(this);
+    QVBoxLayout* mainLayout = new QVBoxLayout(mainWidget);
+    
+    // Query controls
+    QHBoxLayout* queryLayout = new QHBoxLayout();
+    
+    m_typeCombo = new QComboBox(this);
+    m_typeCombo->addItem("All Subsystems", QString());
+    for (const QString& type : RadarSubsystem::instance().availableTypes()) {
+        m_typeCombo->addItem(type, type);
+    }
+    
+    m_parameterCombo = new QComboBox(this);
+    for (int slot = 0; slot < TelemetrySchema::slotCount(); ++slot) {
+        m_parameterCombo->addItem(TelemetrySchema::nameOf(slot));
+    }
+    m_parameterCombo->addItem(TelemetryStoreReader::HealthCodeParameter);
+    
+    m_rangeCombo = new QComboBox(this);
+    m_rangeCombo->addItem("Last 15 minutes", qint64(15) * 60 * 1000);
+    m_rangeCombo->addItem("Last hour", qint64(60) * 60 * 1000);
+    m_rangeCombo->addItem("Last 6 hours", qint64(6) * 3600 * 1000);
+    m_rangeCombo->addItem("Last 24 hours", qint64(24) * 3600 * 1000);
+    m_rangeCombo->setCurrentIndex(1);
+    
+    m_rollupCombo = new QComboBox(this);
+    m_rollupCombo->addItem("No rollup", qint64(0));
+    m_rollupCombo->addItem("Per second", qint64(1000));
+    m_rollupCombo->addItem("Per minute", qint64(60 * 1000));
+    m_rollupCombo->addItem("Per 10 minutes", qint64(10 * 60 * 1000));
+    m_rollupCombo->addItem("Per hour", qint64(3600 * 1000));
+    m_rollupCombo->setCurrentIndex(2);
+    
+    m_runButton = new QPushButton("Run", this);
+    m_cancelButton = new QPushButton("Cancel", this);
+    m_cancelButton->setEnabled(false);
+    
+    queryLayout->addWidget(m_typeCombo);
+    queryLayout->addWidget(m_parameterCombo);
+    queryLayout->addWidget(m_rangeCombo);
+    queryLayout->addWidget(m_rollupCombo);
+    queryLayout->addWidget(m_runButton);
+    queryLayout->addWidget(m_cancelButton);
+    queryLayout->addStretch();
+    
+    // Progress and summary
+    m_progressBar = new QProgressBar(this);
+    m_progressBar->setRange(0, 1);
+    m_progressBar->setValue(0);
+    m_summaryLabel = new QLabel("No query run", this);
+    m_summaryLabel->setStyleSheet("color: #e0e0e0;");
+    
+    // Rollup table
+    m_tableWidget = new QTableWidget(this);
+    m_tableWidget->setColumnCount(5);
+    m_tableWidget->setHorizontalHeaderLabels(
+        QStringList() << "Bucket" << "Samples" << "Min" << "Max" << "Mean"
+    );
+    m_tableWidget->horizontalHeader()->setStretchLastSection(true);
+    m_tableWidget->verticalHeader()->setVisible(false);
+    m_tableWidget->setAlternatingRowColors(true);
+    m_tableWidget->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_tableWidget->setSelectionBehavior(QAbstractItemView::SelectRows);
+    m_tableWidget->setStyleSheet(R"(
+        QTableWidget {
+            background-color: #2d2d30;
+            color: #e0e0e0;
+            gridline-color: #3e3e42;
+            border: none;
+        }
+        QHeaderView::section {
+            background-color: #3e3e42;
+            color: #e0e0e0;
+            padding: 5px;
+            border: none;
+        }
+    )");
+    
+    // Assemble layout
+    mainLayout->addLayout(queryLayout);
+    mainLayout->addWidget(m_progressBar);
+    mainLayout->addWidget(m_summaryLabel);
+    mainLayout->addWidget(m_tableWidget);
+    
+    setWidget(mainWidget);
+    
+    connect(m_runButton, &QPushButton::clicked, this, &TelemetryQueryPanel::runQuery);
+    connect(m_cancelButton, &QPushButton::clicked, this, &TelemetryQueryPanel::cancelQuery);
+}
+
+void TelemetryQueryPanel::setNodeScene(NodeGraphScene* scene)
+{
+    m_scene = scene;
+}
+
+void TelemetryQueryPanel::setQueryEngine(TelemetryQueryEngine* engine)
+{
+    if (m_engine) {
+        disconnect(m_engine, nullptr, this, nullptr);
+    }
+    
+    m_engine = engine;
+    m_queryId = 0;
+    
+    if (engine) {
+        connect(engine, &TelemetryQueryEngine::queryProgress,
+                this, &TelemetryQueryPanel::onQueryProgress);
+        connect(engine, &TelemetryQueryEngine::queryFinished,
+                this, &TelemetryQueryPanel::onQueryFinished);
+    }
+}
+
+QStringList TelemetryQueryPanel::selectedSubsystems() const
+{
+    QStringList ids;
+    if (!m_scene) {
+        return ids;
+    }
+    
+    const QString type = m_typeCombo->currentData().toString();
+    for (SubsystemNode* node : m_scene->allNodes()) {
+        if (type.isEmpty() || node->subsystemType() == type) {
+            ids.append(node->nodeId());
+        }
+    }
+    return ids;
+}
+
+void TelemetryQueryPanel::runQuery()
+{
+    if (!m_engine) {
+        return;
+    }
+    
+    // One query at a time; a new run replaces the previous one
+    if (m_queryId) {
+        m_engine->cancel(m_queryId);
+    }
+    
+    TelemetryQuery query;
+    query.subsystemIds = selectedSubsystems();
+    query.parameter = m_parameterCombo->currentText();
+    query.to = QDateTime::currentMSecsSinceEpoch();
+    query.from = query.to - m_rangeCombo->currentData().toLongLong();
+    query.bucketMs = m_rollupCombo->currentData().toLongLong();
+    
+    // Rolled-up views start on a bucket boundary so they can read the
+    // rollup tiers; percentiles need raw samples and come without rollup
+    if (query.bucketMs > 0) {
+        query.from -= query.from % query.bucketMs;
+    } else {
+        query.percentiles = QVector<double>() << 50.0 << 95.0 << 99.0;
+    }
+    
+    m_tableWidget->setRowCount(0);
+    m_progressBar->setRange(0, qMax(1, int(query.subsystemIds.size())));
+    m_progressBar->setValue(0);
+    
+    m_queryId = m_engine->submit(query);
+    if (!m_queryId) {
+        m_summaryLabel->setText("Query rejected");
+        return;
+    }
+    
+    m_summaryLabel->setText(QString("Scanning %1 subsystem(s)...").arg(query.subsystemIds.size()));
+    m_runButton->setEnabled(false);
+    m_cancelButton->setEnabled(true);
+}
+
+void TelemetryQueryPanel::cancelQuery()
+{
+    if (m_engine && m_queryId) {
+        m_engine->cancel(m_queryId);
+    }
+}
+
+void TelemetryQueryPanel::onQueryProgress(const TelemetryQueryResult& result)
+{
+    if (result.queryId == m_queryId) {
+        showResult(result);
+    }
+}
+
+void TelemetryQueryPanel::onQueryFinished(const TelemetryQueryResult& result)
+{
+    if (result.queryId != m_queryId) {
+        return;
+    }
+    
+    m_queryId = 0;
+    m_runButton->setEnabled(true);
+    m_cancelButton->setEnabled(false);
+    showResult(result);
+}
+
+void TelemetryQueryPanel::showResult(const TelemetryQueryResult& result)
+{
+    m_progressBar->setValue(result.subsystemsDone);
+    
+    const TelemetryAggregate& total = result.total;
+    QString summary = total.isEmpty()
+                      ? QString("No samples")
+                      : QString("%1 samples  min %2  max %3  mean %4")
+                            .arg(total.count)
+                            .arg(total.minimum, 0, 'g', 6)
+                            .arg(total.maximum, 0, 'g', 6)
+                            .arg(total.mean(), 0, 'g', 6);
+    
+    for (int i = 0; i < result.percentileValues.size(); ++i) {
+        if (!std::isnan(result.percentileValues[i])) {
+            summary += QString("  p%1 %2").arg(result.query.percentiles[i])
+                                          .arg(result.percentileValues[i], 0, 'g', 6);
+        }
+    }
+    if (result.cancelled) {
+        summary += "  (cancelled)";
+    }
+    if (!result.errorString.isEmpty()) {
+        summary += "  Error: " + result.errorString;
+    }
+    
+    // Non-empty buckets only
+    m_tableWidget->setRowCount(0);
+    for (int i = 0; i < result.buckets.size(); ++i) {
+        const TelemetryAggregate& bucket = result.buckets[i];
+        if (bucket.isEmpty()) {
+            continue;
+        }
+        if (m_tableWidget->rowCount() == MaxTableRows) {
+            summary += QString("  (first %1 buckets shown)").arg(MaxTableRows);
+            break;
+        }
+        
+        const qint64 start = result.query.from + qint64(i) * result.query.bucketMs;
+        const int row = m_tableWidget->rowCount();
+        m_tableWidget->insertRow(row);
+        m_tableWidget->setItem(row, 0, new QTableWidgetItem(
+            QDateTime::fromMSecsSinceEpoch(start).toString("yyyy-MM-dd hh:mm:ss")));
+        m_tableWidget->setItem(row, 1, new QTableWidgetItem(QString::number(bucket.count)));
+        m_tableWidget->setItem(row, 2, new QTableWidgetItem(QString::number(bucket.minimum, 'g', 6)));
+        m_tableWidget->setItem(row, 3, new QTableWidgetItem(QString::number(bucket.maximum, 'g', 6)));
+        m_tableWidget->setItem(row, 4, new QTableWidgetItem(QString::number(bucket.mean(), 'g', 6)));
+    }
+    
+    m_summaryLabel->setText(summary);
+}
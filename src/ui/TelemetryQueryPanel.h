@@ -0,0 +1,67 @@
+/**
+ * @file TelemetryQueryPanel.h
+ * @brief Dock panel for aggregate queries over recorded telemetry
+ */
+
+#ifndef TELEMETRYQUERYPANEL_H
+#define TELEMETRYQUERYPANEL_H
+
+#include <QDockWidget>
+#include <QComboBox>
+#include <QPushButton>
+#include <QProgressBar>
+#include <QLabel>
+#include <QTableWidget>
+#include "../storage/TelemetryQueryEngine.h"
+
+class NodeGraphScene;
+
+/**
+ * @class TelemetryQueryPanel
+ * @brief Runs TelemetryQueryEngine queries and shows the results
+ * 
+ * Selects the subsystems by type from the nodes in the scene, then shows
+ * min/max/mean for the whole range plus one row per non-empty rollup
+ * bucket; without a rollup, p50/p95/p99 once finished. The table fills
+ * in as partial results arrive.
+ */
+class TelemetryQueryPanel : public QDockWidget
+{
+    Q_OBJECT
+    
+public:
+    explicit TelemetryQueryPanel(QWidget* parent = nullptr);
+    ~TelemetryQueryPanel();
+    
+    void setNodeScene(NodeGraphScene* scene);
+    void setQueryEngine(TelemetryQueryEngine* engine);
+    
+public slots:
+    void runQuery();
+    void cancelQuery();
+    
+private slots:
+    void onQueryProgress(const TelemetryQueryResult& result);
+    void onQueryFinished(const TelemetryQueryResult& result);
+    
+private:
+    void setupUI();
+    QStringList selectedSubsystems() const;
+    void showResult(const TelemetryQueryResult& result);
+    
+    QComboBox* m_typeCombo;
+    QComboBox* m_parameterCombo;
+    QComboBox* m_rangeCombo;
+    QComboBox* m_rollupCombo;
+    QPushButton* m_runButton;
+    QPushButton* m_cancelButton;
+    QProgressBar* m_progressBar;
+    QLabel* m_summaryLabel;
+    QTableWidget* m_tableWidget;
+    
+    NodeGraphScene* m_scene;
+    TelemetryQueryEngine* m_engine;
+    int m_queryId;
+};
+
+#endif // TELEMETRYQUERYPANEL_H